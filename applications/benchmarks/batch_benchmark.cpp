@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+
+#include "light_ik/light_ik.h"
+#include "light_ik/light_ik_batch.h"
+
+#include <memory>
+#include <vector>
+
+namespace LightIK
+{
+
+// Humanoid-like rig: spine with two arms attached to the chest and two legs attached to the pelvis
+class HumanoidRig
+{
+public:
+    static constexpr size_t BonesCount  = 16;
+    static constexpr size_t Iterations  = 4;
+
+    HumanoidRig()
+    {
+        Quaternion straight = glm::identity<Quaternion>();
+        Quaternion bend     = glm::angleAxis(real(0.2), Vector{1, 0, 0});
+        Quaternion left     = glm::angleAxis(glm::pi<real>() / 2, Vector{0, 0, 1});
+        Quaternion right    = glm::angleAxis(-glm::pi<real>() / 2, Vector{0, 0, 1});
+        Quaternion leftLeg  = glm::angleAxis(glm::pi<real>() * real(0.95), Vector{0, 0, 1});
+        Quaternion rightLeg = glm::angleAxis(-glm::pi<real>() * real(0.95), Vector{0, 0, 1});
+
+        BoneDesc pelvis     {straight, real(0.2), 0};
+        std::vector<BoneDesc> spine {pelvis, {bend, 0.3, 1}, {bend, 0.3, 2}, {bend, 0.2, 3}};
+        
+        m_chains = {
+            {spine, 1},
+            {{pelvis, spine[1], spine[2], {left, 0.2, 4},  {bend, 0.3, 5},  {bend, 0.3, 6}},  4},
+            {{pelvis, spine[1], spine[2], {right, 0.2, 7}, {bend, 0.3, 8},  {bend, 0.3, 9}},  7},
+            {{pelvis, {leftLeg, 0.1, 10},  {bend, 0.45, 11}, {bend, 0.45, 12}},                10},
+            {{pelvis, {rightLeg, 0.1, 13}, {bend, 0.45, 14}, {bend, 0.45, 15}},                13},
+        };
+    }
+
+    template <class Builder>
+    void Build(Builder&& builder) const
+    {
+        for (const auto& [descriptors, start] : m_chains)
+        {
+            builder(descriptors, start);
+        }
+    }
+
+    size_t GetChainsCount() const               { return m_chains.size(); }
+
+    // Target of the chain for the specific instance, shifted from the rest tip position on each frame
+    static Vector GetTarget(const Vector& rest, size_t instance, size_t frame)
+    {
+        real phase = static_cast<real>(instance % 17 + frame % 23) * real(0.01);
+        return rest + Vector{phase, -phase, phase * real(0.5)};
+    }
+
+private:
+    std::vector<std::pair<std::vector<BoneDesc>, int>> m_chains;
+};
+
+static void BM_LightIKUpdateLoop(benchmark::State& state)
+{
+    size_t instancesCount = static_cast<size_t>(state.range(0));
+    HumanoidRig rig;
+
+    std::vector<std::unique_ptr<LightIK>> instances;
+    std::vector<std::vector<TargetPosition*>> targets(instancesCount);
+    std::vector<Vector> rest;
+    for (size_t i = 0; i < instancesCount; ++i)
+    {
+        LightIK& library = *instances.emplace_back(std::make_unique<LightIK>(HumanoidRig::BonesCount));
+        rig.Build([&](const std::vector<BoneDesc>& descriptors, int start)
+        {
+            TargetPosition& target = library.CreateTarget();
+            size_t chain = library.CreateIKChain(descriptors, start, target);
+            if (i == 0)
+            {
+                rest.emplace_back(library.GetTipPosition(chain));
+            }
+            targets[i].emplace_back(&target);
+        });
+    }
+
+    size_t frame = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < instancesCount; ++i)
+        {
+            for (size_t c = 0; c < rest.size(); ++c)
+            {
+                targets[i][c]->SetPosition(HumanoidRig::GetTarget(rest[c], i, frame));
+            }
+            benchmark::DoNotOptimize(instances[i]->Update(HumanoidRig::Iterations));
+        }
+        ++frame;
+    }
+    state.SetItemsProcessed(state.iterations() * instancesCount);
+}
+BENCHMARK(BM_LightIKUpdateLoop)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_LightIKBatchUpdate(benchmark::State& state)
+{
+    size_t instancesCount = static_cast<size_t>(state.range(0));
+    HumanoidRig rig;
+
+    LightIKBatch batch(HumanoidRig::BonesCount, instancesCount);
+    rig.Build([&](const std::vector<BoneDesc>& descriptors, int start)
+    {
+        batch.CreateIKChain(descriptors, start);
+    });
+    batch.Update(0);
+
+    std::vector<Vector> rest;
+    for (size_t c = 0; c < batch.GetSolversCount(); ++c)
+    {
+        rest.emplace_back(batch.GetTipPosition(c, 0));
+    }
+
+    size_t frame = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < instancesCount; ++i)
+        {
+            for (size_t c = 0; c < rest.size(); ++c)
+            {
+                batch.SetTargetPosition(c, i, HumanoidRig::GetTarget(rest[c], i, frame));
+            }
+        }
+        benchmark::DoNotOptimize(batch.Update(HumanoidRig::Iterations));
+        ++frame;
+    }
+    state.SetItemsProcessed(state.iterations() * instancesCount);
+}
+BENCHMARK(BM_LightIKBatchUpdate)->RangeMultiplier(4)->Range(16, 4096);
+
+}
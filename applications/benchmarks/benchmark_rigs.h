@@ -0,0 +1,62 @@
+#pragma once
+
+#include "light_ik/light_ik.h"
+
+#include <vector>
+
+namespace LightIK
+{
+
+// Rig with several identical chains growing from the shared root bone, the parameters of the rig are
+// swept by the benchmarks. Total length of the chain does not depend on the number of bones.
+class FanRig
+{
+public:
+    FanRig(size_t chainsCount, size_t chainLength)
+        : m_chainLength(chainLength)
+    {
+        BoneDesc root       {glm::identity<Quaternion>(), real(0.1), 0};
+        real length         = real(1) / static_cast<real>(chainLength);
+        real bendAngle      = real(1.5) / static_cast<real>(chainLength);
+        Quaternion bend     = glm::angleAxis(bendAngle, Vector{1, 0, 0});
+
+        for (size_t c = 0; c < chainsCount; ++c)
+        {
+            std::vector<BoneDesc> chain {root};
+            real angle = glm::two_pi<real>() * static_cast<real>(c) / static_cast<real>(chainsCount);
+            for (size_t i = 0; i < chainLength; ++i)
+            {
+                Quaternion rotation = i ? bend : glm::angleAxis(angle, Vector{0, 1, 0}) * bend;
+                chain.emplace_back(BoneDesc{rotation, length, static_cast<int>(GetStartBone(c) + i)});
+            }
+            m_chains.emplace_back(std::move(chain));
+        }
+    }
+
+    size_t GetBonesCount() const                    { return 1 + m_chains.size() * m_chainLength; }
+    size_t GetChainsCount() const                   { return m_chains.size(); }
+    // index of the first IK bone of the chain
+    size_t GetStartBone(size_t chain) const         { return 1 + chain * m_chainLength; }
+    const std::vector<BoneDesc>& GetChain(size_t chain) const   { return m_chains[chain]; }
+
+    // Limits that are narrow enough to be active during the solving
+    static Constraints GetConstraints()
+    {
+        return Constraints{1, Vector{-0.4, -0.4, -0.4}, Vector{0.4, 0.4, 0.4}};
+    }
+
+    // Target of the chain for the specific frame, moves around the rest tip position. Target is out of reach 
+    // on odd frames, so the solver spends all given iterations like for the stretched limbs in the real scene.
+    static Vector GetTarget(const Vector& rest, size_t frame)
+    {
+        real phase = static_cast<real>(frame % 29) * real(0.01);
+        real scale = (frame & 1) ? real(3) : real(0.8);
+        return rest * scale + Vector{phase, -phase, phase * real(0.5)};
+    }
+
+private:
+    size_t                              m_chainLength;
+    std::vector<std::vector<BoneDesc>>  m_chains;
+};
+
+}
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include "light_ik/light_ik.h"
+
+#include <vector>
+
+namespace LightIK
+{
+
+// Passive spine with the arms attached to its tip, the targets of the arms are reachable only if the spine bends
+class TorsoRig
+{
+public:
+    static constexpr size_t SpineBones  = 4;
+    static constexpr size_t ArmBones    = 3;
+
+    TorsoRig(size_t armsCount, bool group, LightIK& library)
+    {
+        std::vector<BoneDesc> spine;
+        for (size_t i = 0; i < SpineBones; ++i)
+        {
+            spine.emplace_back(BoneDesc{glm::identity<Quaternion>(), 1, static_cast<int>(i)});
+        }
+        library.CreatePassiveChain(spine);
+
+        std::vector<size_t> chains {0};
+        for (size_t a = 0; a < armsCount; ++a)
+        {
+            std::vector<BoneDesc> arm = spine;
+            real angle = glm::two_pi<real>() * static_cast<real>(a) / static_cast<real>(armsCount);
+            Quaternion side = glm::angleAxis(angle, Vector{0, 1, 0}) * glm::angleAxis(glm::half_pi<real>(), Vector{0, 0, 1});
+            for (size_t i = 0; i < ArmBones; ++i)
+            {
+                int index = static_cast<int>(SpineBones + a * ArmBones + i);
+                arm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : side, 1, index});
+            }
+            TargetPosition& target = library.CreateTarget();
+            size_t chain = library.CreateIKChain(arm, static_cast<int>(SpineBones + a * ArmBones), target);
+            Convergence convergence;
+            convergence.tolerance = real(1e-3);
+            library.SetConvergence(chain, convergence);
+
+            m_targets.emplace_back(&target);
+            m_rest.emplace_back(library.GetTipPosition(chain));
+            chains.emplace_back(chain);
+        }
+        if (group)
+        {
+            library.CreateEffectorGroup(chains);
+        }
+    }
+
+    static size_t GetBonesCount(size_t armsCount)   { return SpineBones + armsCount * ArmBones; }
+
+    // arms reach forward and down, further than they can without the spine
+    void MoveTargets(size_t frame)
+    {
+        real phase = static_cast<real>(frame % 17) * real(0.02);
+        for (size_t a = 0; a < m_targets.size(); ++a)
+        {
+            m_targets[a]->SetPosition(m_rest[a] * real(0.75) + Vector{0, -1 - phase, 1.5});
+        }
+    }
+
+private:
+    std::vector<TargetPosition*>    m_targets;
+    std::vector<Vector>             m_rest;
+};
+
+// Arms solved one by one against the arms solved together with the spine by the damped least squares solver
+static void BM_LightIKEffectorGroup(benchmark::State& state)
+{
+    size_t armsCount    = static_cast<size_t>(state.range(0));
+    bool group          = state.range(1) != 0;
+    size_t iterations   = static_cast<size_t>(state.range(2));
+
+    LightIK library(TorsoRig::GetBonesCount(armsCount));
+    TorsoRig rig(armsCount, group, library);
+
+    size_t frame = 0;
+    size_t steps = 0;
+    double error = 0;
+    for (auto _ : state)
+    {
+        rig.MoveTargets(frame++);
+        steps += library.Update(iterations);
+
+        state.PauseTiming();
+        for (size_t a = 0; a < armsCount; ++a)
+        {
+            error += glm::length(library.GetTipPosition(a + 1) - library.GetTargetPosition(a + 1));
+        }
+        state.ResumeTiming();
+    }
+    state.counters["steps"] = benchmark::Counter(static_cast<double>(steps), benchmark::Counter::kAvgIterations);
+    state.counters["error"] = benchmark::Counter(error / static_cast<double>(armsCount), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LightIKEffectorGroup)
+    ->ArgsProduct({{2, 4}, {0, 1}, {8, 32}})
+    ->ArgNames({"arms", "group", "iterations"});
+
+}
@@ -0,0 +1,187 @@
+#include <benchmark/benchmark.h>
+
+#include "../../light_ik/headers/bone.h"
+#include "../../light_ik/headers/bone_storage.h"
+#include "../../light_ik/headers/helpers.h"
+#include "../../light_ik/headers/batch_math.h"
+
+#include <vector>
+#include <cmath>
+
+namespace LightIK
+{
+
+// Set of rotations that covers the range of euler angles, including values outside of the constraints
+static std::vector<Quaternion> GenerateRotations(size_t count)
+{
+    std::vector<Quaternion> rotations;
+    rotations.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        real t = static_cast<real>(i) / static_cast<real>(count);
+        Vector angles {
+            glm::pi<real>() * (t * 2 - 1),
+            glm::pi<real>() * std::fmod(t * 7, real(1)) - glm::half_pi<real>(),
+            glm::half_pi<real>() * std::fmod(t * 13, real(1)) * real(0.99)
+        };
+        rotations.emplace_back(Helpers::FromEulerXZY(angles));
+    }
+    return rotations;
+}
+
+static constexpr size_t SamplesCount = 1024;
+
+// argument selects the constraint kind: free, euler limits or swing-twist limits
+static Constraints BenchmarkConstraints(int64_t kind)
+{
+    switch (kind)
+    {
+    case 0:
+        return Constraints{};
+    case 1:
+        return Constraints{1, Vector{-0.4, -0.8, -0.2}, Vector{0.4, 0.8, 0.2}};
+    default:
+        return Constraints::SwingTwist(0.4, -0.8, 0.8);
+    }
+}
+
+static void BM_BoneApplyConstraint(benchmark::State& state)
+{
+    BoneStorage storage;
+    Bone bone(storage, storage.Add(1, glm::identity<Quaternion>()));
+    bone.SetConstraints(BenchmarkConstraints(state.range(0)));
+    const auto rotations = GenerateRotations(SamplesCount);
+
+    for (auto _ : state)
+    {
+        for (const Quaternion& rotation : rotations)
+        {
+            benchmark::DoNotOptimize(bone.ApplyConstraint(rotation));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rotations.size());
+}
+BENCHMARK(BM_BoneApplyConstraint)->ArgName("kind")->DenseRange(0, 2);
+
+static void BM_HelpersToEulerXZY(benchmark::State& state)
+{
+    const auto rotations = GenerateRotations(SamplesCount);
+
+    for (auto _ : state)
+    {
+        for (const Quaternion& rotation : rotations)
+        {
+            benchmark::DoNotOptimize(Helpers::ToEulerXZY(rotation));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rotations.size());
+}
+BENCHMARK(BM_HelpersToEulerXZY);
+
+static void BM_HelpersFromEulerXZY(benchmark::State& state)
+{
+    std::vector<Vector> angles;
+    for (const Quaternion& rotation : GenerateRotations(SamplesCount))
+    {
+        angles.emplace_back(Helpers::ToEulerXZY(rotation));
+    }
+
+    for (auto _ : state)
+    {
+        for (const Vector& value : angles)
+        {
+            benchmark::DoNotOptimize(Helpers::FromEulerXZY(value));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * angles.size());
+}
+BENCHMARK(BM_HelpersFromEulerXZY);
+
+// Structure-of-arrays copy of the samples for the array versions of the helpers
+struct SampleArrays
+{
+    explicit SampleArrays(const std::vector<Quaternion>& rotations)
+    {
+        for (const Quaternion& rotation : rotations)
+        {
+            const Vector angles = Helpers::ToEulerXZY(rotation);
+            const Vector axis   = rotation * Helpers::DefaultAxis();
+            qw.push_back(rotation.w); qx.push_back(rotation.x); qy.push_back(rotation.y); qz.push_back(rotation.z);
+            ax.push_back(angles.x); ay.push_back(angles.y); az.push_back(angles.z);
+            vx.push_back(axis.x); vy.push_back(axis.y); vz.push_back(axis.z);
+        }
+        rw.resize(qw.size()); rx.resize(qw.size()); ry.resize(qw.size()); rz.resize(qw.size());
+        ex.resize(qw.size()); ey.resize(qw.size()); ez.resize(qw.size());
+        up.resize(qw.size()); yAxis.resize(qw.size(), 1);
+    }
+
+    ConstQuaternionSpan Rotations() const   { return {qw, qx, qy, qz}; }
+    ConstVectorSpan Angles() const          { return {ax, ay, az}; }
+    ConstVectorSpan Axes() const            { return {vx, vy, vz}; }
+    ConstVectorSpan DefaultAxes() const     { return {up, yAxis, up}; }
+    QuaternionSpan ResultRotations()        { return {rw, rx, ry, rz}; }
+    VectorSpan ResultAngles()               { return {ex, ey, ez}; }
+
+    std::vector<real> qw, qx, qy, qz, ax, ay, az, vx, vy, vz;
+    std::vector<real> rw, rx, ry, rz, ex, ey, ez, up, yAxis;
+};
+
+static void BM_PackHelpersToEulerXZY(benchmark::State& state)
+{
+    SampleArrays samples(GenerateRotations(SamplesCount));
+
+    for (auto _ : state)
+    {
+        PackHelpers::ToEulerXZY(samples.Rotations(), samples.ResultAngles());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * SamplesCount);
+}
+BENCHMARK(BM_PackHelpersToEulerXZY);
+
+static void BM_PackHelpersFromEulerXZY(benchmark::State& state)
+{
+    SampleArrays samples(GenerateRotations(SamplesCount));
+
+    for (auto _ : state)
+    {
+        PackHelpers::FromEulerXZY(samples.Angles(), samples.ResultRotations());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * SamplesCount);
+}
+BENCHMARK(BM_PackHelpersFromEulerXZY);
+
+static void BM_HelpersCalculateRotation(benchmark::State& state)
+{
+    std::vector<Vector> axes;
+    for (const Quaternion& rotation : GenerateRotations(SamplesCount))
+    {
+        axes.emplace_back(rotation * Helpers::DefaultAxis());
+    }
+
+    for (auto _ : state)
+    {
+        for (const Vector& axis : axes)
+        {
+            benchmark::DoNotOptimize(Helpers::CalculateRotation(Helpers::DefaultAxis(), axis));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * axes.size());
+}
+BENCHMARK(BM_HelpersCalculateRotation);
+
+static void BM_PackHelpersCalculateRotation(benchmark::State& state)
+{
+    SampleArrays samples(GenerateRotations(SamplesCount));
+
+    for (auto _ : state)
+    {
+        PackHelpers::CalculateRotation(samples.DefaultAxes(), samples.Axes(), samples.ResultRotations());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * SamplesCount);
+}
+BENCHMARK(BM_PackHelpersCalculateRotation);
+
+}
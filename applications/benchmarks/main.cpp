@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Results are written into JSON file by default to track the performance between releases,
+// the default can be overridden by the regular --benchmark_out and --benchmark_out_format options
+int main(int argc, char** argv)
+{
+    std::vector<char*> arguments(argv, argv + argc);
+
+    bool hasOutput = false;
+    bool hasFormat = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view argument(argv[i]);
+        hasOutput |= argument.starts_with("--benchmark_out=");
+        hasFormat |= argument.starts_with("--benchmark_out_format=");
+    }
+
+    std::string output = "--benchmark_out=light_ik_benchmarks.json";
+    std::string format = "--benchmark_out_format=json";
+    if (!hasOutput)
+    {
+        arguments.emplace_back(output.data());
+    }
+    if (!hasFormat)
+    {
+        arguments.emplace_back(format.data());
+    }
+
+    int count = static_cast<int>(arguments.size());
+    benchmark::Initialize(&count, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(count, arguments.data()))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include "light_ik/light_ik.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace LightIK
+{
+
+// Creature with a short body and several long tentacles, the tentacles are independent from each other
+class TentacleRig
+{
+public:
+    static constexpr size_t BodyBones       = 3;
+    static constexpr size_t TentacleBones   = 16;
+
+    TentacleRig(size_t tentaclesCount, LightIK& library)
+    {
+        Quaternion bend = glm::angleAxis(real(0.1), Vector{1, 0, 0});
+        std::vector<BoneDesc> body;
+        for (size_t i = 0; i < BodyBones; ++i)
+        {
+            body.emplace_back(BoneDesc{glm::identity<Quaternion>(), real(0.3), static_cast<int>(i)});
+        }
+        // body stays in the rest pose
+        TargetPosition& bodyTarget = library.CreateTarget();
+        bodyTarget.SetPosition(library.GetTipPosition(library.CreateIKChain(body, 1, bodyTarget)));
+
+        for (size_t t = 0; t < tentaclesCount; ++t)
+        {
+            std::vector<BoneDesc> tentacle = body;
+            real angle = glm::two_pi<real>() * static_cast<real>(t) / static_cast<real>(tentaclesCount);
+            for (size_t i = 0; i < TentacleBones; ++i)
+            {
+                int index = static_cast<int>(BodyBones + t * TentacleBones + i);
+                tentacle.emplace_back(BoneDesc{i ? bend : glm::angleAxis(angle, Vector{0, 1, 0}) * bend, real(0.2), index});
+            }
+            TargetPosition& target = library.CreateTarget();
+            library.CreateIKChain(tentacle, static_cast<int>(BodyBones + t * TentacleBones), target);
+            m_targets.emplace_back(&target);
+            m_rest.emplace_back(library.GetTipPosition(t + 1));
+        }
+    }
+
+    static size_t GetBonesCount(size_t tentaclesCount)  { return BodyBones + tentaclesCount * TentacleBones; }
+
+    void MoveTargets(size_t frame)
+    {
+        real phase = static_cast<real>(frame % 31) * real(0.02);
+        for (size_t t = 0; t < m_targets.size(); ++t)
+        {
+            m_targets[t]->SetPosition(m_rest[t] + Vector{phase, -phase, phase});
+        }
+    }
+
+private:
+    std::vector<TargetPosition*>    m_targets;
+    std::vector<Vector>             m_rest;
+};
+
+static void BM_TentaclesUpdate(benchmark::State& state)
+{
+    size_t tentaclesCount   = static_cast<size_t>(state.range(0));
+    size_t threadsCount     = static_cast<size_t>(state.range(1));
+
+    LightIK library(TentacleRig::GetBonesCount(tentaclesCount));
+    TentacleRig rig(tentaclesCount, library);
+    if (threadsCount)
+    {
+        library.SetThreadPool(LightIK::CreateThreadPool(threadsCount));
+    }
+
+    size_t frame = 0;
+    for (auto _ : state)
+    {
+        rig.MoveTargets(frame++);
+        benchmark::DoNotOptimize(library.Update(4));
+    }
+}
+BENCHMARK(BM_TentaclesUpdate)
+    ->ArgsProduct({{8, 16}, {0, 1, 3, 7}})
+    ->ArgNames({"tentacles", "workers"})
+    ->UseRealTime();
+
+}
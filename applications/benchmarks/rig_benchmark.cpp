@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark_rigs.h"
+#include "light_ik/rig_file.h"
+#include "light_ik/rig.h"
+
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace LightIK
+{
+
+namespace
+{
+    // rig file of the fan rig with the constrained bones
+    std::vector<uint8_t> WriteFanRig(const FanRig& rig)
+    {
+        std::vector<RigBone> bones(rig.GetBonesCount());
+        std::vector<Constraints> constraints(rig.GetBonesCount(), FanRig::GetConstraints());
+        std::vector<RigChain> chains;
+        for (size_t c = 0; c < rig.GetChainsCount(); ++c)
+        {
+            int parent = -1;
+            for (const BoneDesc& desc : rig.GetChain(c))
+            {
+                bones[desc.boneIndex] = RigBone{desc.orientation, desc.length, parent, desc.boneIndex != 0};
+                parent = desc.boneIndex;
+            }
+            chains.emplace_back(RigChain{static_cast<int32_t>(rig.GetStartBone(c)), parent});
+        }
+        std::stringstream stream;
+        WriteRig(stream, bones, constraints, chains);
+        const std::string content = stream.str();
+        return std::vector<uint8_t>(content.begin(), content.end());
+    }
+}
+
+// Construction of the character: chains are created one by one from the root chain descriptors,
+// from the rig file, and as the instance of the shared rig
+static void BM_RigSpawn(benchmark::State& state)
+{
+    size_t chainLength  = static_cast<size_t>(state.range(0));
+    size_t chainsCount  = static_cast<size_t>(state.range(1));
+    int method          = static_cast<int>(state.range(2));
+
+    FanRig fan(chainsCount, chainLength);
+    RigFile file(WriteFanRig(fan));
+    std::shared_ptr<const Rig> rig = Rig::Create(file.GetView());
+
+    for (auto _ : state)
+    {
+        std::unique_ptr<LightIK> library;
+        if (method == 0)
+        {
+            library = std::make_unique<LightIK>(fan.GetBonesCount());
+            for (size_t c = 0; c < fan.GetChainsCount(); ++c)
+            {
+                library->CreateIKChain(fan.GetChain(c), static_cast<int>(fan.GetStartBone(c)), library->CreateTarget());
+            }
+            for (size_t bone = 1; bone < fan.GetBonesCount(); ++bone)
+            {
+                library->SetConstraint(bone, FanRig::GetConstraints());
+            }
+            library->Finalize();
+        }
+        else if (method == 1)
+        {
+            library = std::make_unique<LightIK>(fan.GetBonesCount());
+            library->CreateRig(file.GetView());
+            library->Finalize();
+        }
+        else
+        {
+            library = std::make_unique<LightIK>(*rig);
+        }
+        benchmark::DoNotOptimize(library.get());
+    }
+    state.SetItemsProcessed(state.iterations() * fan.GetBonesCount());
+}
+BENCHMARK(BM_RigSpawn)
+    ->ArgsProduct({{8, 32}, {4, 16}, {0, 1, 2}})
+    ->ArgNames({"length", "chains", "method"});
+
+// Construction of the deep spine with the two bone limb on every spine bone: the chains are described by the full root
+// chains from the skeleton root, or by the start and tip bones of the hierarchy
+static void BM_HierarchySetup(benchmark::State& state)
+{
+    size_t depth        = static_cast<size_t>(state.range(0));
+    bool hierarchy      = state.range(1) != 0;
+
+    // spine bones are 0..depth-1, the limb of the spine bone s is the bones depth + 2s and depth + 2s + 1
+    const size_t bonesCount = depth * 3;
+    const Quaternion side   = glm::angleAxis(glm::half_pi<real>(), Vector{0, 0, 1});
+    std::vector<int> parents(bonesCount);
+    std::vector<real> lengths(bonesCount, real(0.1));
+    std::vector<Quaternion> rotations(bonesCount, glm::identity<Quaternion>());
+    for (size_t s = 0; s < depth; ++s)
+    {
+        parents[s]                  = static_cast<int>(s) - 1;
+        parents[depth + 2 * s]      = static_cast<int>(s);
+        parents[depth + 2 * s + 1]  = static_cast<int>(depth + 2 * s);
+        rotations[depth + 2 * s]    = side;
+    }
+
+    for (auto _ : state)
+    {
+        LightIK library(bonesCount);
+        TargetPosition& target = library.CreateTarget();
+        if (hierarchy)
+        {
+            library.SetHierarchy(parents, lengths, rotations);
+            library.CreatePassiveChain(static_cast<int>(depth - 1));
+            for (size_t s = 0; s < depth; ++s)
+            {
+                library.CreateIKChain(static_cast<int>(depth + 2 * s), static_cast<int>(depth + 2 * s + 1), target);
+            }
+        }
+        else
+        {
+            std::vector<BoneDesc> rootChain;
+            for (size_t s = 0; s < depth; ++s)
+            {
+                rootChain.emplace_back(BoneDesc{rotations[s], lengths[s], static_cast<int>(s)});
+            }
+            library.CreatePassiveChain(rootChain);
+            for (size_t s = 0; s < depth; ++s)
+            {
+                // the application describes the spine again for every limb
+                std::vector<BoneDesc> limb(rootChain.begin(), rootChain.begin() + s + 1);
+                limb.emplace_back(BoneDesc{side, lengths[s], static_cast<int>(depth + 2 * s)});
+                limb.emplace_back(BoneDesc{rotations[s], lengths[s], static_cast<int>(depth + 2 * s + 1)});
+                library.CreateIKChain(limb, static_cast<int>(depth + 2 * s), target);
+            }
+        }
+        benchmark::DoNotOptimize(&library);
+    }
+    state.SetItemsProcessed(state.iterations() * bonesCount);
+}
+BENCHMARK(BM_HierarchySetup)
+    ->ArgsProduct({{16, 64, 256}, {0, 1}})
+    ->ArgNames({"depth", "hierarchy"});
+
+}
@@ -0,0 +1,235 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark_rigs.h"
+#include "../../light_ik/headers/skeleton.h"
+#include "../../light_ik/headers/solver_base.h"
+
+#include <memory>
+#include <vector>
+
+namespace LightIK
+{
+
+static void BM_LightIKUpdate(benchmark::State& state)
+{
+    size_t chainLength  = static_cast<size_t>(state.range(0));
+    size_t chainsCount  = static_cast<size_t>(state.range(1));
+    bool constraints    = state.range(2) != 0;
+    size_t iterations   = static_cast<size_t>(state.range(3));
+
+    FanRig rig(chainsCount, chainLength);
+    LightIK library(rig.GetBonesCount());
+
+    std::vector<TargetPosition*> targets;
+    std::vector<Vector> rest;
+    for (size_t c = 0; c < rig.GetChainsCount(); ++c)
+    {
+        TargetPosition& target = library.CreateTarget();
+        size_t chain = library.CreateIKChain(rig.GetChain(c), static_cast<int>(rig.GetStartBone(c)), target);
+        targets.emplace_back(&target);
+        rest.emplace_back(library.GetTipPosition(chain));
+    }
+    if (constraints)
+    {
+        for (size_t bone = 1; bone < rig.GetBonesCount(); ++bone)
+        {
+            library.SetConstraint(bone, FanRig::GetConstraints());
+        }
+    }
+    library.Finalize();
+
+    size_t frame = 0;
+    size_t steps = 0;
+    for (auto _ : state)
+    {
+        for (size_t c = 0; c < targets.size(); ++c)
+        {
+            targets[c]->SetPosition(FanRig::GetTarget(rest[c], frame));
+        }
+        steps += library.Update(iterations);
+        ++frame;
+    }
+    state.counters["steps"] = benchmark::Counter(static_cast<double>(steps), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * chainsCount * chainLength);
+}
+BENCHMARK(BM_LightIKUpdate)
+    ->ArgsProduct({{2, 8, 32, 128}, {1, 4, 16}, {0, 1}, {1, 4, 16}})
+    ->ArgNames({"length", "chains", "constraints", "iterations"});
+
+// Binary joint and FABRIK solvers on the same rigs and targets, the residual distance to the target
+// shows how far each solver gets within the iterations budget
+static void BM_LightIKSolverType(benchmark::State& state)
+{
+    size_t chainLength  = static_cast<size_t>(state.range(0));
+    SolverType type     = static_cast<SolverType>(state.range(1));
+    bool constraints    = state.range(2) != 0;
+    size_t iterations   = static_cast<size_t>(state.range(3));
+
+    FanRig rig(4, chainLength);
+    LightIK library(rig.GetBonesCount());
+
+    std::vector<TargetPosition*> targets;
+    std::vector<Vector> rest;
+    for (size_t c = 0; c < rig.GetChainsCount(); ++c)
+    {
+        TargetPosition& target = library.CreateTarget();
+        size_t chain = library.CreateIKChain(rig.GetChain(c), static_cast<int>(rig.GetStartBone(c)), target, type);
+        targets.emplace_back(&target);
+        rest.emplace_back(library.GetTipPosition(chain));
+    }
+    if (constraints)
+    {
+        for (size_t bone = 1; bone < rig.GetBonesCount(); ++bone)
+        {
+            library.SetConstraint(bone, FanRig::GetConstraints());
+        }
+    }
+    library.Finalize();
+
+    size_t frame = 0;
+    size_t steps = 0;
+    double error = 0;
+    for (auto _ : state)
+    {
+        for (size_t c = 0; c < targets.size(); ++c)
+        {
+            targets[c]->SetPosition(FanRig::GetTarget(rest[c], frame));
+        }
+        steps += library.Update(iterations);
+        ++frame;
+
+        state.PauseTiming();
+        for (size_t c = 0; c < targets.size(); ++c)
+        {
+            error += glm::length(library.GetTipPosition(c) - targets[c]->GetPosition());
+        }
+        state.ResumeTiming();
+    }
+    state.counters["steps"] = benchmark::Counter(static_cast<double>(steps), benchmark::Counter::kAvgIterations);
+    state.counters["error"] = benchmark::Counter(error / static_cast<double>(targets.size()), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * rig.GetChainsCount() * chainLength);
+}
+BENCHMARK(BM_LightIKSolverType)
+    ->ArgsProduct({
+        {8, 32, 128}, 
+        {static_cast<int64_t>(SolverType::binaryJoint), static_cast<int64_t>(SolverType::fabrik)}, 
+        {0, 1}, 
+        {4, 16}})
+    ->ArgNames({"length", "solver", "constraints", "iterations"});
+
+// Idle crowd: targets only jitter around the converged positions, converged chains may sleep
+static void BM_LightIKIdleUpdate(benchmark::State& state)
+{
+    size_t chainsCount  = static_cast<size_t>(state.range(0));
+    bool sleep          = state.range(1) != 0;
+
+    FanRig rig(chainsCount, 8);
+    LightIK library(rig.GetBonesCount());
+
+    Convergence convergence;
+    convergence.sleepThreshold = sleep ? real(1e-3) : real(0);
+    std::vector<TargetPosition*> targets;
+    std::vector<Vector> rest;
+    for (size_t c = 0; c < rig.GetChainsCount(); ++c)
+    {
+        TargetPosition& target = library.CreateTarget();
+        size_t chain = library.CreateIKChain(rig.GetChain(c), static_cast<int>(rig.GetStartBone(c)), target);
+        library.SetConvergence(chain, convergence);
+        targets.emplace_back(&target);
+        rest.emplace_back(FanRig::GetTarget(library.GetTipPosition(chain), 0));
+        target.SetPosition(rest.back());
+    }
+    library.Finalize();
+    library.Update(16);
+
+    size_t frame = 0;
+    for (auto _ : state)
+    {
+        real jitter = (frame++ & 1) ? real(1e-4) : real(0);
+        for (size_t c = 0; c < targets.size(); ++c)
+        {
+            targets[c]->SetPosition(rest[c] + Vector{jitter, 0, 0});
+        }
+        benchmark::DoNotOptimize(library.Update(4));
+    }
+    state.SetItemsProcessed(state.iterations() * chainsCount);
+}
+BENCHMARK(BM_LightIKIdleUpdate)
+    ->ArgsProduct({{4, 16, 64}, {0, 1}})
+    ->ArgNames({"chains", "sleep"});
+
+// Front kinematics of the whole chain, the root bone of every chain is rotated on each frame
+// so the positions can not be reused from the previous calculation
+static void BM_SkeletonCalculateBonePositions(benchmark::State& state)
+{
+    size_t chainLength  = static_cast<size_t>(state.range(0));
+    size_t chainsCount  = static_cast<size_t>(state.range(1));
+
+    FanRig rig(chainsCount, chainLength);
+    Skeleton skeleton(rig.GetBonesCount());
+    TargetPosition target;
+    std::vector<Bone*> roots;
+    for (size_t c = 0; c < rig.GetChainsCount(); ++c)
+    {
+        skeleton.AddSolver(rig.GetChain(c), rig.GetStartBone(c), target);
+        roots.emplace_back(skeleton.GetBones()[rig.GetStartBone(c)]);
+    }
+
+    const Quaternion rotations[] = {
+        glm::angleAxis(real(0.1), Vector{0, 0, 1}),
+        glm::angleAxis(real(-0.1), Vector{0, 0, 1})
+    };
+    size_t frame = 0;
+    for (auto _ : state)
+    {
+        for (Bone* root : roots)
+        {
+            root->SetRotation(rotations[frame & 1]);
+        }
+        skeleton.FinalizeChains();
+        benchmark::ClobberMemory();
+        ++frame;
+    }
+    state.SetItemsProcessed(state.iterations() * chainsCount * chainLength);
+}
+BENCHMARK(BM_SkeletonCalculateBonePositions)
+    ->ArgsProduct({{2, 8, 32, 128}, {1, 4, 16}})
+    ->ArgNames({"length", "chains"});
+
+// Single pass of the solver, bone positions stay the same between the passes
+static void BM_SolverExecute(benchmark::State& state)
+{
+    size_t chainLength  = static_cast<size_t>(state.range(0));
+    bool constraints    = state.range(1) != 0;
+
+    SolverType type     = static_cast<SolverType>(state.range(2));
+
+    FanRig rig(1, chainLength);
+    Skeleton skeleton(rig.GetBonesCount());
+    TargetPosition target;
+    SolverBase& solver = skeleton.AddSolver(rig.GetChain(0), rig.GetStartBone(0), target, type);
+    if (constraints)
+    {
+        for (size_t bone = 1; bone < rig.GetBonesCount(); ++bone)
+        {
+            skeleton.SetConstraint(static_cast<int>(bone), FanRig::GetConstraints());
+        }
+    }
+    skeleton.FinalizeChains();
+    target.SetPosition(FanRig::GetTarget(solver.GetTipPosition(), 7));
+
+    for (auto _ : state)
+    {
+        solver.Execute();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * chainLength);
+}
+BENCHMARK(BM_SolverExecute)
+    ->ArgsProduct({
+        {2, 4, 8, 16, 32, 64, 128}, 
+        {0, 1}, 
+        {static_cast<int64_t>(SolverType::binaryJoint), static_cast<int64_t>(SolverType::fabrik)}})
+    ->ArgNames({"length", "constraints", "solver"});
+
+}
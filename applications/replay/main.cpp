@@ -0,0 +1,116 @@
+#include "light_ik/light_ik.h"
+#include "light_ik/recorder.h"
+#include "light_ik/profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Repeats the captured session, checks that every update reproduces the captured result and reports
+// the time of the frames. The slowest frames are the candidates for the profiling with --trace
+int main(int argc, char** argv)
+{
+    std::string logPath;
+    std::string tracePath;
+    size_t      repeat = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view argument(argv[i]);
+        if (argument == "--repeat" && i + 1 < argc)
+        {
+            repeat = std::max<size_t>(1, std::stoul(argv[++i]));
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else
+        {
+            logPath = argument;
+        }
+    }
+    if (logPath.empty())
+    {
+        std::cerr << "usage: replay <log> [--repeat N] [--trace trace.json]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream file(logPath, std::ios::binary);
+    LightIK::Replay replay(file);
+    if (!replay.IsValid())
+    {
+        std::cerr << "not a light_ik log or captured with another precision: " << logPath << std::endl;
+        return 1;
+    }
+
+    LightIK::ChromeTraceWriter writer;
+    if (!tracePath.empty())
+    {
+        LightIK::SetProfiler(&writer);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    // the best time of every frame over the repeats
+    std::vector<double> frameTimes;
+    size_t mismatches = 0;
+    bool   finished   = true;
+    for (size_t run = 0; run < repeat; ++run)
+    {
+        replay.Rewind();
+        LightIK::LightIK library(replay.GetBonesCount());
+        for (size_t frame = 0; ; ++frame)
+        {
+            const Clock::time_point start = Clock::now();
+            if (!replay.Step(library))
+            {
+                break;
+            }
+            const double time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            if (frame == frameTimes.size())
+            {
+                frameTimes.emplace_back(time);
+            }
+            frameTimes[frame] = std::min(frameTimes[frame], time);
+        }
+        mismatches = std::max(mismatches, replay.GetMismatches());
+        finished = finished && replay.IsFinished();
+    }
+    LightIK::SetProfiler(nullptr);
+
+    double total = 0;
+    for (double time : frameTimes)
+    {
+        total += time;
+    }
+    std::cout << "frames: " << frameTimes.size() << ", mismatches: " << mismatches << std::endl;
+    std::cout << "total: " << total << " us, average: " << (frameTimes.empty() ? 0 : total / frameTimes.size()) << " us" << std::endl;
+
+    std::vector<size_t> slowest(frameTimes.size());
+    for (size_t frame = 0; frame < slowest.size(); ++frame)
+    {
+        slowest[frame] = frame;
+    }
+    const size_t shown = std::min<size_t>(5, slowest.size());
+    std::partial_sort(slowest.begin(), slowest.begin() + shown, slowest.end(),
+        [&frameTimes](size_t left, size_t right) { return frameTimes[left] > frameTimes[right]; });
+    for (size_t i = 0; i < shown; ++i)
+    {
+        std::cout << "frame " << slowest[i] << ": " << frameTimes[slowest[i]] << " us" << std::endl;
+    }
+
+    if (!tracePath.empty())
+    {
+        std::ofstream trace(tracePath);
+        writer.Write(trace);
+    }
+    if (!finished)
+    {
+        std::cerr << "the log is damaged or truncated after frame " << frameTimes.size() << ": " << logPath << std::endl;
+        return 3;
+    }
+    return mismatches == 0 ? 0 : 2;
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include "light_ik/light_ik.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Global allocation functions are replaced to count the heap allocations of the library calls
+namespace
+{
+    std::atomic<bool>   g_countAllocations  {false};
+    std::atomic<size_t> g_allocations       {0};
+
+    // alignment 0 selects the default alignment of malloc
+    void* Allocate(std::size_t size, std::size_t alignment)
+    {
+        if (g_countAllocations.load(std::memory_order_relaxed))
+        {
+            ++g_allocations;
+        }
+        size = size ? size : 1;
+#ifdef _WIN32
+        void* memory = alignment ? _aligned_malloc(size, alignment) : std::malloc(size);
+#else
+        // aligned_alloc requires the size to be a multiple of the alignment
+        void* memory = alignment ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment) : std::malloc(size);
+#endif
+        if (!memory)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    void Release(void* memory, std::size_t alignment)
+    {
+#ifdef _WIN32
+        alignment ? _aligned_free(memory) : std::free(memory);
+#else
+        (void)alignment;
+        std::free(memory);
+#endif
+    }
+}
+
+// GCC pairs the inlined free of the replaced operator delete with the replaced operator new that is not inlined
+//  and reports -Wmismatched-new-delete, though both sides are replaced here and use malloc and free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size)                                        { return Allocate(size, 0); }
+void* operator new[](std::size_t size)                                      { return Allocate(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment)            { return Allocate(size, (std::size_t)alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment)          { return Allocate(size, (std::size_t)alignment); }
+void operator delete(void* memory) noexcept                                 { Release(memory, 0); }
+void operator delete[](void* memory) noexcept                               { Release(memory, 0); }
+void operator delete(void* memory, std::size_t) noexcept                    { Release(memory, 0); }
+void operator delete[](void* memory, std::size_t) noexcept                  { Release(memory, 0); }
+void operator delete(void* memory, std::align_val_t alignment) noexcept     { Release(memory, (std::size_t)alignment); }
+void operator delete[](void* memory, std::align_val_t alignment) noexcept   { Release(memory, (std::size_t)alignment); }
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept   { Release(memory, (std::size_t)alignment); }
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept { Release(memory, (std::size_t)alignment); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace LightIK
+{
+
+class AllocationTest : public ::testing::Test
+{
+protected:
+    static constexpr size_t BonesCount = 12;
+
+    AllocationTest()
+        : m_library(BonesCount)
+    {
+        Quaternion bend = glm::angleAxis(real(0.3), Vector{1, 0, 0});
+        Quaternion side = glm::angleAxis(glm::half_pi<real>(), Vector{0, 0, 1});
+        std::vector<BoneDesc> spine {{glm::identity<Quaternion>(), 1, 0}, {bend, 1, 1}, {bend, 1, 2}, {bend, 1, 3}};
+
+        std::vector<BoneDesc> leftArm  = spine;
+        std::vector<BoneDesc> rightArm = spine;
+        for (int i = 0; i < 4; ++i)
+        {
+            leftArm.emplace_back(BoneDesc{i ? bend : side, 1, 4 + i});
+            rightArm.emplace_back(BoneDesc{i ? bend : glm::inverse(side), 1, 8 + i});
+        }
+
+        m_targets.emplace_back(&m_library.CreateTarget());
+        m_library.CreateIKChain(spine, 1, *m_targets.back());
+        m_targets.emplace_back(&m_library.CreateTarget());
+        m_library.CreateIKChain(leftArm, 4, *m_targets.back());
+        // right arm follows the tip of the left arm
+        m_library.CreateIKLink(rightArm, 8, 7);
+        m_library.SetConstraint(5, Constraints{1, {-1, -1, -1}, {1, 1, 1}});
+
+        for (size_t c = 0; c < m_targets.size(); ++c)
+        {
+            m_rest.emplace_back(m_library.GetTipPosition(c));
+        }
+    }
+
+    // moves the targets on every frame, so the chains are solved on every update
+    size_t CountUpdateAllocations(size_t frames)
+    {
+        g_allocations       = 0;
+        g_countAllocations  = true;
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            real phase = static_cast<real>(frame % 7) * real(0.1);
+            for (size_t c = 0; c < m_targets.size(); ++c)
+            {
+                m_targets[c]->SetPosition(m_rest[c] + Vector{phase, -phase, phase});
+            }
+            m_library.Update(4);
+        }
+        g_countAllocations  = false;
+        return g_allocations;
+    }
+
+    LightIK                         m_library;
+    std::vector<TargetPosition*>    m_targets;
+    std::vector<Vector>             m_rest;
+};
+
+TEST_F(AllocationTest, update_does_not_allocate)
+{
+    // the first update builds the execution plan
+    m_library.Update(1);
+
+    ASSERT_EQ(0, CountUpdateAllocations(32));
+}
+
+TEST_F(AllocationTest, parallel_update_does_not_allocate)
+{
+    m_library.SetThreadPool(LightIK::CreateThreadPool(2));
+    // the first update builds the chains dependency graph
+    m_library.Update(1);
+
+    ASSERT_EQ(0, CountUpdateAllocations(32));
+}
+
+TEST_F(AllocationTest, effector_group_update_does_not_allocate)
+{
+    ASSERT_TRUE(m_library.CreateEffectorGroup({0, 1}));
+    m_library.Update(1);
+
+    ASSERT_EQ(0, CountUpdateAllocations(32));
+}
+
+TEST_F(AllocationTest, reset_and_rebuild)
+{
+    std::vector<BoneDesc> chain {{glm::identity<Quaternion>(), 1, 0}, {glm::identity<Quaternion>(), 1, 1}};
+
+    m_library.Reset();
+    ASSERT_EQ(0, m_library.GetSolversCount());
+
+    TargetPosition& target = m_library.CreateTarget();
+    target.SetPosition({1, 1, 0});
+    size_t index = m_library.CreateIKChain(chain, 0, target);
+    m_library.Update(10);
+
+    ASSERT_NEAR(0, glm::length(m_library.GetTipPosition(index) - target.GetPosition()), 1e-4);
+}
+
+}
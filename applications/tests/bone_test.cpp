@@ -20,8 +20,10 @@ namespace LightIK
 TEST(SolverTest, can_create_solver)
 {
     std::unique_ptr<Solver> library;
-    Bone bone(2, glm::angleAxis(glm::pi<real>()/2, Vector{1,0,0}));
-    Bone ref;
+    BoneStorage storage;
+    storage.Reserve(2);
+    Bone ref(storage, storage.Add(0, glm::identity<Quaternion>()));
+    Bone bone(storage, storage.Add(2, glm::angleAxis(glm::pi<real>()/2, Vector{1,0,0})));
     TargetPosition target;
     ASSERT_NO_THROW(library = std::make_unique<Solver>(BoneSubchain{std::ref(bone)}, ref, target));
 };
@@ -156,7 +158,7 @@ TEST_F(BoneLookAtTest, overlength)
     SetupChain({Vector{0, 1, 1}}, 0, target);
     Step(1);
 
-    ASSERT_TRUE(TestHelpers::CompareVectors(target * sqrt(2), GetSolver().GetTipPosition()));
+    ASSERT_TRUE(TestHelpers::CompareVectors(target * glm::sqrt((real)2), GetSolver().GetTipPosition()));
 }
 
 TEST_F(BoneLookAtTest, distant)
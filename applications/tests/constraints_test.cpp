@@ -3,6 +3,7 @@
 
 #include "test_helpers.h"
 #include "test_body.h"
+#include "../../light_ik/headers/solver_two_bone.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/norm.hpp"
@@ -38,9 +39,18 @@ protected:
     }
 
 protected:
-    Solver& GetSolver() 
+    SolverBase& GetSolver() 
     {
-        return *static_cast<Solver*>(m_solver);
+        return *m_solver;
+    }
+    const BoneSubchain& GetChain() const
+    {
+        // two bone chains are solved by the closed form solver
+        if (auto solver = dynamic_cast<const SolverTwoBone*>(m_solver))
+        {
+            return solver->GetChain();
+        }
+        return static_cast<const Solver*>(m_solver)->GetChain();
     }
     TargetPosition& GetTarget()
     {
@@ -136,7 +146,7 @@ TEST_F(BoneFlexibilityTest, fixed_preserve_angle)
     GetSkeleton().SetConstraint(1, std::move(constraints));
 
     Step(1);
-    const auto& bones   = GetSolver().GetChain();
+    const auto& bones   = GetChain();
     ASSERT_NE(0, bones.size());
     Vector axis1        = bones[0].get().GetGlobalOrientation() * Helpers::DefaultAxis();
     Vector axis2        = bones[1].get().GetGlobalOrientation() * Helpers::DefaultAxis();
@@ -155,9 +165,9 @@ public:
 
 TEST_F(BoneLookAtConstraintsTest, free_rotation)
 {
-    ASSERT_FALSE(GetSolver().GetChain().empty());
+    ASSERT_FALSE(GetChain().empty());
 
-    Bone& bone = GetSolver().GetChain().front();
+    Bone& bone = GetChain().front();
     Constraints constraints;
     GetSkeleton().SetConstraint(0, std::move(constraints));
     GetTarget().SetPosition(Vector{1,0,0});
@@ -168,9 +178,9 @@ TEST_F(BoneLookAtConstraintsTest, free_rotation)
 
 TEST_F(BoneLookAtConstraintsTest, no_rotation)
 {
-    ASSERT_FALSE(GetSolver().GetChain().empty());
+    ASSERT_FALSE(GetChain().empty());
     
-    Bone& bone = GetSolver().GetChain().front();
+    Bone& bone = GetChain().front();
     // the joint is fullly flexible, but rotation limits blocks it from any rotation
     Constraints constraints = { 1, Vector{0, 0, 0}, Vector{0, 0, 0} };
     GetSkeleton().SetConstraint(0, std::move(constraints));
@@ -229,6 +239,65 @@ TEST_F(BoneLookAtConstraintsTest, sector_allowed)
     ASSERT_TRUE(TestHelpers::CompareVectors(glm::normalize(Vector{sqrt(0.5), 0.5, 0.5}), GetSolver().GetTipPosition()));
 }
 
+TEST_F(BoneLookAtConstraintsTest, swing_cone)
+{
+    GetSkeleton().SetConstraint(0, Constraints::SwingTwist(glm::pi<real>() / 4, -glm::pi<real>(), glm::pi<real>()));
+    GetTarget().SetPosition(Vector{1, 0, 1});
+    Step(1);
+
+    ASSERT_TRUE(TestHelpers::CompareVectors(glm::normalize(Vector{0.5, sqrt(0.5), 0.5}), GetSolver().GetTipPosition()));
+}
+
+TEST(ConstraintLimitsTest, classification)
+{
+    BoneStorage storage;
+    storage.Add(1, glm::identity<Quaternion>());
+    ASSERT_EQ(ConstraintLimits::Kind::free, storage.limits[0].kind);
+
+    // Z angle never exceeds +-pi/2, so the wider limits do not constrain anything
+    const real pi = glm::pi<real>();
+    storage.SetConstraints(0, Constraints{0.5, {-pi, -pi, -pi / 2}, {pi, pi, pi / 2}});
+    ASSERT_EQ(ConstraintLimits::Kind::free, storage.limits[0].kind);
+    storage.SetConstraints(0, Constraints{1, {-pi, -pi, -1}, {pi, pi, pi}});
+    ASSERT_EQ(ConstraintLimits::Kind::euler, storage.limits[0].kind);
+    storage.SetConstraints(0, Constraints::SwingTwist(pi, -pi, pi));
+    ASSERT_EQ(ConstraintLimits::Kind::free, storage.limits[0].kind);
+    storage.SetConstraints(0, Constraints::SwingTwist(pi, -1, 1));
+    ASSERT_EQ(ConstraintLimits::Kind::swingTwist, storage.limits[0].kind);
+
+    // free bones keep the rotation untouched
+    storage.SetConstraints(0, Constraints{});
+    const Quaternion rotation = glm::angleAxis((real)2, glm::normalize(Vector{1, 2, 3}));
+    ASSERT_EQ(rotation, storage.ApplyConstraint(0, rotation));
+}
+
+TEST(ConstraintLimitsTest, swing_twist_clamp)
+{
+    BoneStorage storage;
+    storage.Add(1, glm::identity<Quaternion>());
+    const real swingLimit   = 0.5;
+    const real twistLimit   = 0.3;
+    storage.SetConstraints(0, Constraints::SwingTwist(swingLimit, -twistLimit, twistLimit));
+
+    const Quaternion swing  = glm::angleAxis((real)1.2, glm::normalize(Vector{1, 0, 1}));
+    const Quaternion twist  = glm::angleAxis((real)-0.8, Vector{0, 1, 0});
+    const Quaternion result = storage.ApplyConstraint(0, swing * twist);
+
+    // the bone axis keeps the swing direction, the angle is reduced to the cone
+    const Vector axis       = result * Helpers::DefaultAxis();
+    ASSERT_NEAR(swingLimit, glm::angle(axis, Helpers::DefaultAxis()), 1e-5);
+    const Vector swingAxis  = swing * Helpers::DefaultAxis();
+    ASSERT_TRUE(TestHelpers::CompareDirections(Vector{swingAxis.x, 0, swingAxis.z}, Vector{axis.x, 0, axis.z}));
+    // the twist is the rest of the rotation after the swing is removed
+    const Quaternion clampedSwing = Helpers::CalculateRotation(Helpers::DefaultAxis(), axis);
+    const Quaternion restTwist    = glm::inverse(clampedSwing) * result;
+    ASSERT_NEAR(-twistLimit, 2 * glm::atan(restTwist.y, restTwist.w), 1e-5);
+
+    // rotations within the limits are not changed
+    const Quaternion inside = glm::angleAxis((real)0.2, Vector{0, 0, 1}) * glm::angleAxis((real)0.1, Vector{0, 1, 0});
+    ASSERT_EQ(inside, storage.ApplyConstraint(0, inside));
+}
+
 class BoneRotationConstraintsTest : public BoneLookAtConstraintsTest
 {
 public:
@@ -302,9 +371,9 @@ public:
             Vector{0, 0, 0}, 
             Vector{0, 0, 0} };
             
-        ASSERT_FALSE(GetSolver().GetChain().empty());
+        ASSERT_FALSE(GetChain().empty());
 
-        for (size_t i = 0; i < GetSolver().GetChain().size() - 1; ++i)
+        for (size_t i = 0; i < GetChain().size() - 1; ++i)
         {
             ASSERT_TRUE(GetSkeleton().SetConstraint(i + 2, std::move(constraints)));
         }
@@ -3,6 +3,7 @@
 
 #include "test_helpers.h"
 #include "test_body.h"
+#include "../../light_ik/headers/thread_pool.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/norm.hpp"
@@ -59,6 +60,7 @@ public:
     TargetPosition& GetRootTarget() {return m_root;}
     Target& GetBranch1Target() {return m_branch1;}
     Target& GetBranch2Target() {return m_branch2;}
+    SolverBase& GetSolver(size_t index) {return m_solvers[index];}
 private:
     TargetPosition m_root;
     TargetBone m_branch1;
@@ -87,6 +89,159 @@ TEST_F(CoordinationTest, movement_top_down)
     ASSERT_TRUE(TestHelpers::CompareVectors(GetSkeleton().GetBones().at(6)->GetPosition(), GetBranch2Target().GetPosition()));
 }
 
+TEST_F(CoordinationTest, schedule_dependencies)
+{
+    // branches start from the spine, second branch follows the bone of the first one
+    ASSERT_TRUE(GetSkeleton().DependsOn(GetSolver(1), GetSolver(0)));
+    ASSERT_TRUE(GetSkeleton().DependsOn(GetSolver(2), GetSolver(0)));
+    ASSERT_TRUE(GetSkeleton().DependsOn(GetSolver(2), GetSolver(1)));
+    ASSERT_FALSE(GetSkeleton().DependsOn(GetSolver(1), GetSolver(2)));
+}
+
+TEST_F(CoordinationTest, parallel_update)
+{
+    ThreadPool pool(2);
+    GetRootTarget().SetPosition({0, 2, 2});
+    GetSkeleton().SetThreadPool(&pool);
+    GetSkeleton().Update(5);
+
+    std::vector<Vector> positions;
+    for (const Bone* bone : GetSkeleton().GetBones())
+    {
+        positions.emplace_back(bone ? bone->GetPosition() : Vector{0, 0, 0});
+    }
+
+    GetSkeleton().ResetPose();
+    GetSkeleton().SetThreadPool(nullptr);
+    GetSkeleton().Update(5);
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const Bone* bone = GetSkeleton().GetBones()[i];
+        if (bone)
+        {
+            ASSERT_TRUE(TestHelpers::CompareVectors(bone->GetPosition(), positions[i])) << "bone " << i;
+        }
+    }
+}
+
+TEST_F(CoordinationTest, batched_update)
+{
+    // the first update finalizes the changed structure by itself, the same way as the explicit call
+    GetRootTarget().SetPosition({0, 2, 2});
+    GetSkeleton().Update(5);
+
+    std::vector<Vector> positions;
+    for (const Bone* bone : GetSkeleton().GetBones())
+    {
+        positions.emplace_back(bone ? bone->GetPosition() : Vector{0, 0, 0});
+    }
+
+    GetSkeleton().ResetPose();
+    GetSkeleton().Finalize();
+    GetSkeleton().Update(5);
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const Bone* bone = GetSkeleton().GetBones()[i];
+        if (bone)
+        {
+            ASSERT_TRUE(TestHelpers::CompareVectors(bone->GetPosition(), positions[i])) << "bone " << i;
+        }
+    }
+}
+
+class CoordinationSharedBonesTest : public ::testing::Test, public LightIKTestBody
+{
+public: 
+    // both chains start from the skeleton root, the IK part of the second chain takes the bones of the first one
+    void ConstructSkeleton(const std::vector<int>& firstStructure, SolverType firstType, SolverType secondType)
+    {
+        std::vector<std::vector<Vector>> bones ={
+            /*                                           0          1          2            */
+            /*root chain*/ std::vector<Vector>{Vector{0, 0, 0}, {0, 1, 0}, {0, 2, 0}, {0, 3, 0}},
+            /*                                           3          4            */ 
+            /*branch   */                     {      {0, 2, 0}, {1, 2, 0}, {2, 2, 0}},
+        };
+
+        std::vector<BoneDesc> descriptors = LightIKTestBody::ConstructSkeleton(bones);
+        std::vector<int> branchStructure {0, 1, 3, 4};
+
+        std::vector<BoneDesc> first;
+        std::vector<BoneDesc> second;
+        for (int i : firstStructure)
+        {
+            first.emplace_back(descriptors[i]);
+        }
+        for (int i : branchStructure)
+        {
+            second.emplace_back(descriptors[i]);
+        }
+        m_first     = &GetSkeleton().AddSolver(first, 0, m_firstTarget, firstType);
+        m_second    = &GetSkeleton().AddSolver(second, 0, m_secondTarget, secondType);
+    }
+
+    std::vector<Vector> GetPositions()
+    {
+        std::vector<Vector> positions;
+        for (const Bone* bone : GetSkeleton().GetBones())
+        {
+            positions.emplace_back(bone ? bone->GetPosition() : Vector{0, 0, 0});
+        }
+        return positions;
+    }
+
+protected:
+    TargetPosition  m_firstTarget;
+    TargetPosition  m_secondTarget;
+    SolverBase*     m_first     = nullptr;
+    SolverBase*     m_second    = nullptr;
+};
+
+TEST_F(CoordinationSharedBonesTest, schedule_dependencies)
+{
+    ConstructSkeleton({0, 1, 2}, SolverType::binaryJoint, SolverType::binaryJoint);
+    ASSERT_EQ(GetSkeleton().GetBaseBone(*m_first), GetSkeleton().GetBaseBone(*m_second));
+    // the chains rotate the same bones, so the later one waits for the earlier one
+    ASSERT_TRUE(GetSkeleton().DependsOn(*m_second, *m_first));
+    ASSERT_FALSE(GetSkeleton().DependsOn(*m_first, *m_second));
+}
+
+TEST_F(CoordinationSharedBonesTest, parallel_update)
+{
+    ConstructSkeleton({0, 1, 2}, SolverType::binaryJoint, SolverType::binaryJoint);
+    m_firstTarget.SetPosition({1, 2, 0});
+    m_secondTarget.SetPosition({-1, 2, 1});
+    GetSkeleton().Update(5);
+    const std::vector<Vector> positions = GetPositions();
+
+    ThreadPool pool(2);
+    GetSkeleton().ResetPose();
+    GetSkeleton().SetThreadPool(&pool);
+    GetSkeleton().Update(5);
+
+    const std::vector<Vector> parallel = GetPositions();
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        ASSERT_TRUE(TestHelpers::CompareVectors(positions[i], parallel[i])) << "bone " << i;
+    }
+}
+
+TEST_F(CoordinationSharedBonesTest, mixed_solver_kinds)
+{
+    // the closed form chain has the higher solver kind, it still has to be solved before the later chain
+    ConstructSkeleton({0, 1}, SolverType::twoBone, SolverType::binaryJoint);
+    m_firstTarget.SetPosition({1, 1, 0});
+    m_secondTarget.SetPosition({-1, 2, 1});
+    ASSERT_TRUE(GetSkeleton().DependsOn(*m_second, *m_first));
+
+    GetSkeleton().Update(100);
+    GetSkeleton().FinalizeChains();
+    // the chain solved last keeps its tip on the target, the shared bones were turned away from the first target
+    ASSERT_TRUE(TestHelpers::CompareVectors(m_secondTarget.GetPosition(), m_second->GetTipPosition(), 1e-3));
+    ASSERT_FALSE(TestHelpers::CompareVectors(m_firstTarget.GetPosition(), m_first->GetTipPosition(), 1e-3));
+}
+
 class CoordinationWithPassiveChainTest : public ::testing::Test, public LightIKTestBody
 {
 public: 
@@ -218,4 +373,12 @@ TEST_F(CoordinationLinkChainTest, target_position)
     ASSERT_TRUE(TestHelpers::CompareDirections(bone10->GetPosition() - bone7->GetPosition(), direction));
 }
 
+TEST_F(CoordinationLinkChainTest, link_dependencies)
+{
+    // passive chain starts from the spine root bone, link chain starts from the spine and follows the passive chain
+    ASSERT_TRUE(GetSkeleton().DependsOn(m_solvers[1], m_solvers[0]));
+    ASSERT_TRUE(GetSkeleton().DependsOn(m_solvers[2], m_solvers[0]));
+    ASSERT_TRUE(GetSkeleton().DependsOn(m_solvers[2], m_solvers[1]));
+}
+
 };
@@ -0,0 +1,216 @@
+#include <memory>
+#include <limits>
+
+#include "light_ik/light_ik.h"
+#include "light_ik/light_ik_batch.h"
+#include "test_helpers.h"
+#include "test_body.h"
+#include "../../light_ik/headers/batch_math.h"
+
+namespace LightIK
+{
+
+TEST(LightIKBatchTest, can_create_batch)
+{
+    std::unique_ptr<LightIKBatch> batch;
+    ASSERT_NO_THROW(batch = std::make_unique<LightIKBatch>(3, 5));
+    ASSERT_EQ(5, batch->GetInstancesCount());
+};
+
+TEST(LightIKBatchTest, movement_returns_true)
+{
+    LightIKBatch batch(3, 3);
+    size_t chainIndex = batch.CreateIKChain({
+        BoneDesc{glm::identity<Quaternion>(), 1, 0},
+        BoneDesc{glm::identity<Quaternion>(), 1, 1}}, 0);
+    for (size_t i = 0; i < batch.GetInstancesCount(); ++i)
+    {
+        batch.SetTargetPosition(chainIndex, i, {2, 0, 0});
+    }
+
+    ASSERT_EQ(1, batch.Update());
+};
+
+TEST(LightIKBatchTest, pack_transcendentals)
+{
+    const real tolerance = std::numeric_limits<real>::epsilon() * 8;
+    for (real value = -4; value < 4; value += (real)0.01)
+    {
+        Pack a          = Pack::Broadcast(value);
+        Pack unit       = Pack::Broadcast(glm::clamp(value / 4, (real)-1, (real)1));
+        Pack sine, cosine;
+        SinCos(a, sine, cosine);
+
+        ASSERT_NEAR(std::sin(value),            sine.v[0],              tolerance) << value;
+        ASSERT_NEAR(std::cos(value),            cosine.v[0],            tolerance) << value;
+        ASSERT_NEAR(std::atan(value),           Atan(a).v[0],           tolerance) << value;
+        ASSERT_NEAR(std::atan2(value, -1.5),    Atan2(a, Pack::Broadcast(-1.5)).v[0], tolerance) << value;
+        ASSERT_NEAR(std::asin(unit.v[0]),       Asin(unit).v[0],        tolerance) << value;
+        ASSERT_NEAR(std::acos(unit.v[0]),       Acos(unit).v[0],        tolerance) << value;
+    }
+}
+
+TEST(LightIKBatchTest, pack_span_helpers)
+{
+    // the size does not fill the last pack completely
+    constexpr size_t Count = 2 * BatchLanes + 3;
+    std::vector<real> fx(Count), fy(Count), fz(Count), tx(Count), ty(Count), tz(Count);
+    std::vector<real> qw(Count), qx(Count), qy(Count), qz(Count), ax(Count), ay(Count), az(Count);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const real t = (real)i / Count;
+        fx[i] = glm::sin(t * 5); fy[i] = glm::cos(t * 3); fz[i] = t - (real)0.5;
+        // the first value is collinear with its pair, the second one is opposite
+        tx[i] = i == 0 ? fx[i] : i == 1 ? -fx[i] : glm::cos(t * 7);
+        ty[i] = i == 0 ? fy[i] : i == 1 ? -fy[i] : t;
+        tz[i] = i == 0 ? fz[i] : i == 1 ? -fz[i] : glm::sin(t * 2);
+        const real fromLength = glm::length(Vector{fx[i], fy[i], fz[i]});
+        const real toLength   = glm::length(Vector{tx[i], ty[i], tz[i]});
+        fx[i] /= fromLength; fy[i] /= fromLength; fz[i] /= fromLength;
+        tx[i] /= toLength; ty[i] /= toLength; tz[i] /= toLength;
+    }
+    const ConstVectorSpan from {fx, fy, fz};
+    const ConstVectorSpan to {tx, ty, tz};
+    const QuaternionSpan rotations {qw, qx, qy, qz};
+    const VectorSpan angles {ax, ay, az};
+
+    PackHelpers::CalculateRotation(from, to, rotations);
+    PackHelpers::ToEulerXZY(rotations, angles);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const Vector f {fx[i], fy[i], fz[i]};
+        const Vector t {tx[i], ty[i], tz[i]};
+        const Quaternion reference = Helpers::CalculateRotation(f, t);
+        ASSERT_TRUE(TestHelpers::CompareDirections(reference * f, Quaternion{qw[i], qx[i], qy[i], qz[i]} * f)) << i;
+        ASSERT_TRUE(TestHelpers::CompareVectors(Helpers::ToEulerXZY(Quaternion{qw[i], qx[i], qy[i], qz[i]}), Vector{ax[i], ay[i], az[i]})) << i;
+    }
+
+    PackHelpers::FromEulerXZY(angles, rotations);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const Quaternion reference = Helpers::FromEulerXZY(Vector{ax[i], ay[i], az[i]});
+        ASSERT_TRUE(TestHelpers::CompareRotations(reference, Quaternion{qw[i], qx[i], qy[i], qz[i]})) << i;
+    }
+}
+
+// Batch of instances has to produce exactly the same pose as the separate skeletons with the same targets
+class LightIKBatchCoordinationTests : public ::testing::Test, public LightIKTestBody
+{
+public:
+    // number of instances that does not fill the last block completely
+    static constexpr size_t InstancesCount = 11;
+
+    LightIKBatchCoordinationTests()
+        : m_batch(10, InstancesCount)
+    {
+        for (size_t i = 0; i < InstancesCount; ++i)
+        {
+            m_references.emplace_back(std::make_unique<LightIK>(10));
+        }
+        m_spineTargets.resize(InstancesCount);
+        m_branchTargets.resize(InstancesCount);
+    }
+
+    void SetUp() override
+    {
+        std::vector<std::vector<Vector>> bones = {
+            /*                                           0          1          2          3          4          */
+            /*root chain*/ std::vector<Vector>{Vector{0, 0, 0}, {0, 1, 0}, {0, 2, 0}, {0, 3, 0}, {0, 4, 0}, {0, 5, 0}},
+            /*                                           5          6            */ 
+            /*branch 1 */                     {      {0, 2, 0}, {1, 2, 0}, {2, 2, 0}},
+            /*                                           7          8            */ 
+            /*branch 2 */                     {      {0, 4, 0}, {1, 4, 0}, {2, 4, 0}}
+        };
+        std::vector<BoneDesc> descriptors = ConstructSkeleton(bones);
+
+        auto select = [&descriptors](const std::vector<int>& structure)
+        {
+            std::vector<BoneDesc> result;
+            for (int index : structure)
+            {
+                result.emplace_back(descriptors[index]);
+            }
+            return result;
+        };
+
+        m_batch.CreateIKChain(select({0, 1, 2, 3, 4}), 0);
+        m_batch.CreatePassiveChain(select({0, 1, 2, 3, 7, 8}));
+        m_batch.CreateIKChain(select({0, 1, 5, 6}), 5);
+        m_batch.SetConstraint(6, Constraints{1, {-1, -1, -1}, {1, 1, 1}});
+        m_batch.SetConstraint(3, Constraints::SwingTwist(0.4, -0.2, 0.2));
+
+        for (size_t i = 0; i < InstancesCount; ++i)
+        {
+            m_references[i]->CreateIKChain(select({0, 1, 2, 3, 4}), 0, m_spineTargets[i]);
+            m_references[i]->CreatePassiveChain(select({0, 1, 2, 3, 7, 8}));
+            m_references[i]->CreateIKChain(select({0, 1, 5, 6}), 5, m_branchTargets[i]);
+            m_references[i]->SetConstraint(6, Constraints{1, {-1, -1, -1}, {1, 1, 1}});
+            m_references[i]->SetConstraint(3, Constraints::SwingTwist(0.4, -0.2, 0.2));
+        }
+    }
+
+    void SetTargets(size_t instance, const Vector& spine, const Vector& branch)
+    {
+        m_spineTargets[instance].SetPosition(spine);
+        m_branchTargets[instance].SetPosition(branch);
+        m_batch.SetTargetPosition(0, instance, spine);
+        m_batch.SetTargetPosition(2, instance, branch);
+    }
+
+protected:
+    LightIKBatch                            m_batch;
+    std::vector<std::unique_ptr<LightIK>>   m_references;
+    std::vector<TargetPosition>             m_spineTargets;
+    std::vector<TargetPosition>             m_branchTargets;
+};
+
+TEST_F(LightIKBatchCoordinationTests, same_as_separate_skeletons)
+{
+    for (size_t i = 0; i < InstancesCount; ++i)
+    {
+        real shift = static_cast<real>(i) / InstancesCount;
+        SetTargets(i, {shift, 3, 2 - shift}, {1 + shift, 1, shift});
+    }
+
+    size_t steps = m_batch.Update(10);
+
+    size_t referenceSteps = 10;
+    for (size_t i = 0; i < InstancesCount; ++i)
+    {
+        referenceSteps = std::min(referenceSteps, m_references[i]->Update(10));
+    }
+    ASSERT_EQ(referenceSteps, steps);
+
+    for (size_t i = 0; i < InstancesCount; ++i)
+    {
+        const auto& rotations = m_references[i]->GetDeltaRotations();
+        for (size_t bone = 0; bone < rotations.size(); ++bone)
+        {
+            if (!rotations[bone])
+            {
+                continue;
+            }
+            ASSERT_TRUE(TestHelpers::CompareRotations(*rotations[bone], m_batch.GetDeltaRotation(i, bone))) << "instance " << i << " bone " << bone;
+            ASSERT_TRUE(TestHelpers::CompareVectors(m_references[i]->GetBonePosition(bone), m_batch.GetBonePosition(i, bone)));
+        }
+        ASSERT_TRUE(TestHelpers::CompareVectors(m_references[i]->GetTipPosition(0), m_batch.GetTipPosition(0, i)));
+        ASSERT_TRUE(TestHelpers::CompareVectors(m_references[i]->GetTipPosition(2), m_batch.GetTipPosition(2, i)));
+    }
+}
+
+TEST_F(LightIKBatchCoordinationTests, reset_pose)
+{
+    for (size_t i = 0; i < InstancesCount; ++i)
+    {
+        SetTargets(i, {1, 3, 1}, {1, 1, 1});
+    }
+    m_batch.Update(10);
+    m_batch.ResetPose();
+
+    for (size_t i = 0; i < InstancesCount; ++i)
+    {
+        ASSERT_TRUE(TestHelpers::CompareRotations(glm::identity<Quaternion>(), m_batch.GetDeltaRotation(i, 0)));
+    }
+}
+
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "test_helpers.h"
+#include "../../light_ik/headers/math_policy.h"
+
+namespace LightIK
+{
+
+// Documented error bounds of the approximations
+static const real AtanTolerance     = std::numeric_limits<real>::epsilon() * 4;
+static const real SinCosTolerance   = std::numeric_limits<real>::epsilon() * 2;
+
+TEST(MathPolicyTest, atan2_error_bound)
+{
+    for (real angle = -4; angle < 4; angle += (real)0.001)
+    {
+        for (real radius : {(real)1e-3, (real)1, (real)1e3})
+        {
+            const real y = radius * std::sin(angle);
+            const real x = radius * std::cos(angle);
+            ASSERT_NEAR(std::atan2(y, x), FastMath::Atan2(y, x), AtanTolerance) << y << ", " << x;
+        }
+        ASSERT_NEAR(std::atan(angle * 10), FastMath::Atan(angle * 10), AtanTolerance) << angle;
+    }
+    ASSERT_EQ(0, FastMath::Atan2(0, 0));
+    ASSERT_NEAR(glm::half_pi<real>(), FastMath::Atan2(1, 0), AtanTolerance);
+    ASSERT_NEAR(-glm::half_pi<real>(), FastMath::Atan2(-1, 0), AtanTolerance);
+}
+
+TEST(MathPolicyTest, sincos_error_bound)
+{
+    for (real angle = -20; angle < 20; angle += (real)0.001)
+    {
+        real sine, cosine;
+        FastMath::SinCos(angle, sine, cosine);
+        ASSERT_NEAR(std::sin(angle), sine, SinCosTolerance) << angle;
+        ASSERT_NEAR(std::cos(angle), cosine, SinCosTolerance) << angle;
+    }
+    // the bound holds up to the documented range of the angles
+    const real limit = std::is_same_v<real, float> ? (real)1e3 : (real)1e5;
+    for (real angle = -limit; angle < limit; angle += limit / 10000)
+    {
+        real sine, cosine;
+        FastMath::SinCos(angle, sine, cosine);
+        ASSERT_NEAR(std::sin(angle), sine, SinCosTolerance) << angle;
+        ASSERT_NEAR(std::cos(angle), cosine, SinCosTolerance) << angle;
+    }
+}
+
+TEST(MathPolicyTest, sincos_out_of_range)
+{
+    for (real angle : {std::numeric_limits<real>::infinity(), -std::numeric_limits<real>::infinity(),
+        std::numeric_limits<real>::quiet_NaN()})
+    {
+        real sine, cosine;
+        FastMath::SinCos(angle, sine, cosine);
+        ASSERT_TRUE(std::isnan(sine));
+        ASSERT_TRUE(std::isnan(cosine));
+    }
+    // the quadrant of the angle does not fit the integer
+    real sine, cosine;
+    FastMath::SinCos((real)1e30, sine, cosine);
+    ASSERT_EQ(std::sin((real)1e30), sine);
+    ASSERT_EQ(std::cos((real)1e30), cosine);
+}
+
+TEST(MathPolicyTest, angle_axis_matches_glm)
+{
+    const Vector axis = glm::normalize(Vector{1, -2, 3});
+    for (real angle = -7; angle < 7; angle += (real)0.01)
+    {
+        ASSERT_TRUE(TestHelpers::CompareRotations(glm::angleAxis(angle, axis), FastMath::AngleAxis(angle, axis))) << angle;
+    }
+}
+
+}
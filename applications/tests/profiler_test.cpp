@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "test_helpers.h"
+#include "light_ik/light_ik.h"
+#include "light_ik/profiler.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace LightIK
+{
+
+namespace
+{
+    size_t CountOccurrences(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+        for (size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+        {
+            ++count;
+        }
+        return count;
+    }
+}
+
+TEST(ProfilerTest, trace_events)
+{
+    ChromeTraceWriter writer;
+    writer.BeginScope(ProfileScope::chain, 7);
+    writer.BeginScope(ProfileScope::kinematics, 7);
+    writer.EndScope(ProfileScope::kinematics);
+    writer.EndScope(ProfileScope::chain);
+
+    std::stringstream stream;
+    writer.Write(stream);
+    const std::string trace = stream.str();
+
+    ASSERT_EQ(0, trace.find("{\"traceEvents\":["));
+    ASSERT_EQ(2, CountOccurrences(trace, "\"ph\":\"B\""));
+    ASSERT_EQ(2, CountOccurrences(trace, "\"ph\":\"E\""));
+    ASSERT_EQ(2, CountOccurrences(trace, "\"name\":\"chain\""));
+    ASSERT_EQ(2, CountOccurrences(trace, "\"args\":{\"id\":7}"));
+}
+
+TEST(ProfilerTest, buffer_overflow)
+{
+    ChromeTraceWriter writer(2);
+    writer.BeginScope(ProfileScope::update, 0);
+    writer.BeginScope(ProfileScope::chain, 0);
+    writer.EndScope(ProfileScope::chain);
+    writer.EndScope(ProfileScope::update);
+
+    ASSERT_EQ(2, writer.GetDroppedCount());
+}
+
+TEST(ProfilerTest, thread_buffers)
+{
+    ChromeTraceWriter writer;
+    std::thread worker([&writer]()
+    {
+        writer.BeginScope(ProfileScope::chain, 1);
+        writer.EndScope(ProfileScope::chain);
+    });
+    writer.BeginScope(ProfileScope::chain, 0);
+    writer.EndScope(ProfileScope::chain);
+    worker.join();
+
+    std::stringstream stream;
+    writer.Write(stream);
+    const std::string trace = stream.str();
+    ASSERT_EQ(2, CountOccurrences(trace, "\"tid\":0"));
+    ASSERT_EQ(2, CountOccurrences(trace, "\"tid\":1"));
+}
+
+TEST(ProfilerTest, update_scopes)
+{
+#ifndef LIGHT_IK_PROFILER
+    GTEST_SKIP() << "profiler hooks are compiled out";
+#endif
+    LightIK library(3);
+    std::vector<BoneDesc> chain {{glm::identity<Quaternion>(), 1, 0}, {glm::identity<Quaternion>(), 1, 1}, {glm::identity<Quaternion>(), 1, 2}};
+    TargetPosition& target = library.CreateTarget();
+    target.SetPosition({1, 1, 1});
+    library.CreateIKChain(chain, 0, target, SolverType::binaryJoint);
+
+    ChromeTraceWriter writer;
+    SetProfiler(&writer);
+    library.Update(2);
+    SetProfiler(nullptr);
+
+    std::stringstream stream;
+    writer.Write(stream);
+    const std::string trace = stream.str();
+    ASSERT_EQ(2, CountOccurrences(trace, "\"name\":\"update\""));
+    ASSERT_EQ(2, CountOccurrences(trace, "\"name\":\"chain\""));
+    ASSERT_LE(2, CountOccurrences(trace, "\"name\":\"iteration\""));
+    ASSERT_LE(2, CountOccurrences(trace, "\"name\":\"kinematics\""));
+    ASSERT_EQ(CountOccurrences(trace, "\"ph\":\"B\""), CountOccurrences(trace, "\"ph\":\"E\""));
+}
+
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include "test_helpers.h"
+#include "light_ik/light_ik.h"
+#include "light_ik/recorder.h"
+
+#include <sstream>
+
+namespace LightIK
+{
+
+namespace
+{
+    // spine of 4 bones with the arm of 2 bones attached to the third bone
+    void CreateRig(LightIK& library, TargetPosition& target)
+    {
+        const Quaternion identity = glm::identity<Quaternion>();
+        const Quaternion side = glm::angleAxis(-glm::half_pi<real>(), Vector{0, 0, 1});
+        std::vector<BoneDesc> spine {{identity, 1, 0}, {identity, 1, 1}, {identity, 1, 2}, {identity, 1, 3}};
+        std::vector<BoneDesc> arm {{identity, 1, 0}, {identity, 1, 1}, {identity, 1, 2}, {side, 1, 4}, {identity, 1, 5}};
+
+        const size_t spineChain = library.CreateIKChain(spine, 1, target, SolverType::binaryJoint);
+        library.SetConvergence(spineChain, Convergence{(real)1e-3, 0, 0});
+        library.CreateIKLink(arm, 4, 1, SolverType::twoBone);
+        library.SetConstraint(2, Constraints::SwingTwist(glm::quarter_pi<real>(), -(real)0.5, (real)0.5));
+    }
+}
+
+TEST(RecorderTest, replay_session)
+{
+    Recorder recorder;
+    LightIK library(6);
+    library.SetRecorder(&recorder);
+    TargetPosition& target = library.CreateTarget();
+    CreateRig(library, target);
+
+    const size_t framesCount = 20;
+    for (size_t frame = 0; frame < framesCount; ++frame)
+    {
+        const real angle = (real)frame * (real)0.3;
+        target.SetPosition({glm::sin(angle) * 2, 3, glm::cos(angle)});
+        library.Update(4);
+    }
+    library.SetRecorder(nullptr);
+
+    std::stringstream stream;
+    ASSERT_TRUE(recorder.Save(stream));
+    Replay replay(stream);
+    ASSERT_TRUE(replay.IsValid());
+    ASSERT_EQ(6, replay.GetBonesCount());
+
+    LightIK replayed(replay.GetBonesCount());
+    while (replay.Step(replayed))
+    {
+    }
+    ASSERT_TRUE(replay.IsFinished());
+    ASSERT_EQ(framesCount, replay.GetFrame());
+    ASSERT_EQ(0, replay.GetMismatches());
+    for (size_t chainIndex = 0; chainIndex < library.GetSolversCount(); ++chainIndex)
+    {
+        ASSERT_EQ(library.GetTipPosition(chainIndex), replayed.GetTipPosition(chainIndex));
+    }
+
+    // the changed pose is detected by the result hash
+    replay.Rewind();
+    LightIK changed(replay.GetBonesCount());
+    ASSERT_TRUE(replay.Step(changed));
+    ASSERT_FALSE(replay.IsFinished());
+    changed.SetConstraint(3, Constraints::SwingTwist((real)0.1, -(real)0.1, (real)0.1));
+    while (replay.Step(changed))
+    {
+    }
+    ASSERT_EQ(framesCount, replay.GetFrame());
+    ASSERT_LT(0, replay.GetMismatches());
+}
+
+TEST(RecorderTest, invalid_log)
+{
+    ASSERT_FALSE(Replay(std::vector<uint8_t>{}).IsValid());
+    ASSERT_FALSE(Replay(std::vector<uint8_t>{'L', 'I', 'K', 'X', 1, 0, sizeof(real), 0}).IsValid());
+
+    // truncated log stops the replay at the last complete update
+    Recorder recorder;
+    LightIK library(6);
+    library.SetRecorder(&recorder);
+    TargetPosition& target = library.CreateTarget();
+    CreateRig(library, target);
+    library.Update(1);
+    library.Update(1);
+
+    std::vector<uint8_t> data = recorder.GetData();
+    data.resize(data.size() - 1);
+    Replay replay(std::move(data));
+    ASSERT_TRUE(replay.IsValid());
+    LightIK replayed(replay.GetBonesCount());
+    ASSERT_TRUE(replay.Step(replayed));
+    ASSERT_FALSE(replay.Step(replayed));
+    ASSERT_FALSE(replay.IsFinished());
+    ASSERT_EQ(0, replay.GetMismatches());
+
+    // the complete log ends cleanly
+    Replay complete(recorder.GetData());
+    LightIK completeReplayed(complete.GetBonesCount());
+    ASSERT_TRUE(complete.Step(completeReplayed));
+    ASSERT_TRUE(complete.Step(completeReplayed));
+    ASSERT_FALSE(complete.Step(completeReplayed));
+    ASSERT_TRUE(complete.IsFinished());
+}
+
+TEST(RecorderTest, corrupt_records)
+{
+    // header of the log is followed by the record type
+    constexpr size_t headerSize     = 16;
+    constexpr size_t descriptorSize = sizeof(Quaternion) + sizeof(real) + sizeof(int32_t);
+    const Quaternion identity       = glm::identity<Quaternion>();
+
+    auto replayed = [](const std::vector<uint8_t>& data)
+    {
+        Replay replay(data);
+        LightIK library(replay.GetBonesCount());
+        return replay.Step(library);
+    };
+
+    Recorder recorder;
+    LightIK library(2);
+    library.SetRecorder(&recorder);
+    TargetPosition& target = library.CreateTarget();
+    library.CreateIKChain({{identity, 1, 0}, {identity, 1, 1}}, 0, target, SolverType::binaryJoint);
+    library.Update(1);
+    ASSERT_TRUE(replayed(recorder.GetData()));
+
+    // chain start and solver type follow the type, the descriptors count and two descriptors
+    const size_t chainStart = headerSize + 1 + sizeof(uint32_t) + 2 * descriptorSize;
+    std::vector<uint8_t> data = recorder.GetData();
+    data[chainStart] = 5;
+    ASSERT_FALSE(replayed(data));
+    data = recorder.GetData();
+    data[chainStart + sizeof(int32_t)] = 9;
+    ASSERT_FALSE(replayed(data));
+    // empty root chain
+    data = recorder.GetData();
+    data[headerSize + 1] = 0;
+    ASSERT_FALSE(replayed(data));
+
+    // constraint type follows the bone index, the flexibility and the Euler limits
+    Recorder constraintRecorder;
+    LightIK constrained(2);
+    constrained.SetRecorder(&constraintRecorder);
+    constrained.SetConstraint(0, Constraints::SwingTwist((real)0.1, -(real)0.1, (real)0.1));
+    constrained.Update(1);
+    data = constraintRecorder.GetData();
+    ASSERT_TRUE(replayed(data));
+    data[headerSize + 1 + sizeof(uint64_t) + sizeof(real) + 2 * sizeof(Vector)] = 7;
+    ASSERT_FALSE(replayed(data));
+
+    // target bone of the link follows the chain record, the type, the descriptors count, two descriptors
+    //  and the chain start of the link. Bone 3 is registered only by the link itself, so it has no position
+    Recorder linkRecorder;
+    LightIK linked(4);
+    linked.SetRecorder(&linkRecorder);
+    TargetPosition& linkTarget = linked.CreateTarget();
+    linked.CreateIKChain({{identity, 1, 0}, {identity, 1, 1}}, 0, linkTarget, SolverType::binaryJoint);
+    ASSERT_EQ(1, linked.CreateIKLink({{identity, 1, 2}, {identity, 1, 3}}, 2, 1, SolverType::binaryJoint));
+    linked.Update(1);
+    data = linkRecorder.GetData();
+    ASSERT_TRUE(replayed(data));
+    const size_t chainSize  = 1 + sizeof(uint32_t) + 2 * descriptorSize + sizeof(int32_t) + 1;
+    const size_t targetBone = headerSize + chainSize + 1 + sizeof(uint32_t) + 2 * descriptorSize + sizeof(int32_t);
+    data[targetBone] = 3;
+    Replay linkReplay(data);
+    LightIK linkReplayed(linkReplay.GetBonesCount());
+    ASSERT_FALSE(linkReplay.Step(linkReplayed));
+    ASSERT_FALSE(linkReplay.IsFinished());
+    ASSERT_EQ(1, linkReplayed.GetSolversCount());
+}
+
+}
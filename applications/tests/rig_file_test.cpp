@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include "test_helpers.h"
+#include "light_ik/light_ik.h"
+#include "light_ik/rig_file.h"
+#include "light_ik/rig.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace LightIK
+{
+
+namespace
+{
+    // spine of 4 bones with the arm of 2 bones attached to the third bone
+    const Quaternion s_side = glm::angleAxis(-glm::half_pi<real>(), Vector{0, 0, 1});
+
+    std::vector<RigBone> CreateBones()
+    {
+        const Quaternion identity = glm::identity<Quaternion>();
+        std::vector<RigBone> bones {{identity, 1, -1}, {identity, 1, 0}, {identity, 1, 1}, {identity, 1, 2},
+            {s_side, 1, 2}, {identity, 1, 4}};
+        bones[2].constrained = 1;
+        return bones;
+    }
+
+    std::vector<uint8_t> WriteFile(const std::vector<RigBone>& bones, const std::vector<RigChain>& chains)
+    {
+        std::vector<Constraints> constraints(bones.size());
+        constraints[2] = Constraints::SwingTwist(glm::quarter_pi<real>(), -(real)0.5, (real)0.5);
+
+        std::stringstream stream;
+        EXPECT_TRUE(WriteRig(stream, bones, constraints, chains));
+        const std::string content = stream.str();
+        return std::vector<uint8_t>(content.begin(), content.end());
+    }
+
+    const std::vector<RigChain> s_chains {
+        RigChain{1, 3, -1, RigChainType::position, (uint8_t)SolverType::binaryJoint},
+        RigChain{4, 5, 3, RigChainType::bone, (uint8_t)SolverType::twoBone}};
+}
+
+TEST(RigFileTest, create_rig)
+{
+    RigFile file(WriteFile(CreateBones(), s_chains));
+    ASSERT_TRUE(file.IsValid());
+    ASSERT_EQ(6, file.GetView().GetBones().size());
+    ASSERT_EQ(2, file.GetView().GetChains().size());
+
+    LightIK library(6);
+    ASSERT_TRUE(library.CreateRig(file.GetView()));
+    ASSERT_EQ(2, library.GetSolversCount());
+    ASSERT_EQ(nullptr, library.GetRigTarget(1));
+    TargetPosition* target = library.GetRigTarget(0);
+    ASSERT_NE(nullptr, target);
+
+    // the same rig created chain by chain
+    const Quaternion identity = glm::identity<Quaternion>();
+    LightIK expected(6);
+    TargetPosition& expectedTarget = expected.CreateTarget();
+    expected.CreateIKChain({{identity, 1, 0}, {identity, 1, 1}, {identity, 1, 2}, {identity, 1, 3}}, 1, expectedTarget,
+        SolverType::binaryJoint);
+    expected.CreateIKLink({{identity, 1, 0}, {identity, 1, 1}, {identity, 1, 2}, {s_side, 1, 4}, {identity, 1, 5}}, 4, 3,
+        SolverType::twoBone);
+    expected.SetConstraint(2, Constraints::SwingTwist(glm::quarter_pi<real>(), -(real)0.5, (real)0.5));
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        const Vector position {glm::sin((real)frame) * 2, 3, 1};
+        target->SetPosition(position);
+        expectedTarget.SetPosition(position);
+        library.Update(4);
+        expected.Update(4);
+        ASSERT_EQ(expected.GetTipPosition(0), library.GetTipPosition(0));
+        ASSERT_EQ(expected.GetTipPosition(1), library.GetTipPosition(1));
+    }
+}
+
+TEST(RigFileTest, rig_instances)
+{
+    RigFile file(WriteFile(CreateBones(), s_chains));
+    std::shared_ptr<const Rig> rig = Rig::Create(file.GetView());
+    ASSERT_NE(nullptr, rig);
+    ASSERT_EQ(6, rig->GetBonesCount());
+
+    LightIK expected(6);
+    expected.CreateRig(file.GetView());
+    LightIK first(*rig);
+    auto second = std::make_unique<LightIK>(*rig);
+    // the instances keep the bone parameters after the rig is released
+    rig.reset();
+    ASSERT_EQ(2, first.GetSolversCount());
+    ASSERT_EQ(nullptr, first.GetRigTarget(1));
+    ASSERT_EQ(expected.GetTipPosition(1), first.GetTipPosition(1));
+
+    // the changed constraint of one instance does not change the others
+    second->SetConstraint(1, Constraints::SwingTwist((real)0.1, -(real)0.1, (real)0.1));
+    bool differs = false;
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        const Vector position {glm::sin((real)frame) * 2, 3, 1};
+        expected.GetRigTarget(0)->SetPosition(position);
+        first.GetRigTarget(0)->SetPosition(position);
+        second->GetRigTarget(0)->SetPosition(position);
+        expected.Update(4);
+        first.Update(4);
+        second->Update(4);
+        ASSERT_EQ(expected.GetTipPosition(0), first.GetTipPosition(0));
+        ASSERT_EQ(expected.GetTipPosition(1), first.GetTipPosition(1));
+        ASSERT_EQ(expected.GetBonePosition(3), first.GetBonePosition(3));
+        differs |= expected.GetBonePosition(3) != second->GetBonePosition(3);
+    }
+    ASSERT_TRUE(differs);
+
+    second.reset();
+    first.ResetPose();
+    expected.ResetPose();
+    ASSERT_EQ(expected.GetTipPosition(1), first.GetTipPosition(1));
+}
+
+TEST(RigFileTest, mapped_file)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "light_ik_rig_file_test.likg";
+    {
+        const std::vector<uint8_t> content = WriteFile(CreateBones(), s_chains);
+        std::ofstream stream(path, std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(content.data()), content.size());
+    }
+    {
+        RigFile file(path.string());
+        ASSERT_TRUE(file.IsValid());
+        ASSERT_EQ(s_side, file.GetView().GetBones()[4].rotation);
+        ASSERT_EQ(ConstraintType::swingTwist, file.GetView().GetConstraints()[2].type);
+        ASSERT_EQ(RigChainType::bone, file.GetView().GetChains()[1].type);
+    }
+    std::filesystem::remove(path);
+
+    ASSERT_FALSE(RigFile("light_ik_missing_rig.likg").IsValid());
+}
+
+TEST(RigFileTest, invalid_rig)
+{
+    std::stringstream stream;
+    // parents form the cycle
+    std::vector<RigBone> bones = CreateBones();
+    bones[0].parent = 3;
+    ASSERT_FALSE(WriteRig(stream, bones, {}, s_chains));
+
+    // start bone is not the ancestor of the tip
+    std::vector<RigChain> chains = s_chains;
+    chains[1].start = 3;
+    ASSERT_FALSE(WriteRig(stream, CreateBones(), {}, chains));
+
+    // target bone is not created by the earlier chains
+    chains = s_chains;
+    chains[1].targetBone = 5;
+    ASSERT_FALSE(WriteRig(stream, CreateBones(), {}, chains));
+    std::swap(chains[0], chains[1]);
+    chains[0].targetBone = 3;
+    ASSERT_FALSE(WriteRig(stream, CreateBones(), {}, chains));
+    // passive chain without new bones
+    chains = s_chains;
+    chains.emplace_back(RigChain{0, 2, -1, RigChainType::passive});
+    ASSERT_FALSE(WriteRig(stream, CreateBones(), {}, chains));
+
+    std::vector<uint8_t> content = WriteFile(CreateBones(), s_chains);
+    // the same chain in the file written without the validation
+    reinterpret_cast<RigChain*>(content.data() + content.size() - sizeof(RigChain))->targetBone = 5;
+    ASSERT_FALSE(RigFile(content).IsValid());
+    content = WriteFile(CreateBones(), s_chains);
+    content.pop_back();
+    ASSERT_FALSE(RigFile(content).IsValid());
+    content = WriteFile(CreateBones(), s_chains);
+    content[0] = 'X';
+    ASSERT_FALSE(RigFile(content).IsValid());
+
+    LightIK library(4);
+    ASSERT_FALSE(library.CreateRig(RigFile(WriteFile(CreateBones(), s_chains)).GetView()));
+
+    // bones of the passive chain are registered by the chain created before the rig, the rig is not created
+    const Quaternion identity = glm::identity<Quaternion>();
+    LightIK registered(6);
+    registered.CreatePassiveChain({{identity, 1, 0}, {identity, 1, 1}, {identity, 1, 2}});
+    ASSERT_FALSE(registered.CreateRig(RigFile(WriteFile(CreateBones(), {RigChain{0, 2, -1, RigChainType::passive}})).GetView()));
+    ASSERT_EQ(0, registered.GetSolversCount());
+}
+
+}
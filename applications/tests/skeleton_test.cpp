@@ -145,6 +145,33 @@ TEST_F(SkeletonBaseTest, add_second_chain)
     ASSERT_EQ(2, GetSkeleton().GetSolversCount());
 }
 
+TEST_F(SkeletonBaseTest, finalize_after_remove)
+{
+    TargetPosition removedTarget;
+    removedTarget.SetPosition({1, 1, 0});
+    SolverBase& removed = GetSkeleton().AddSolver({
+        BoneDesc{ glm::identity<Quaternion>(), 1.f, 0},
+        BoneDesc{ glm::identity<Quaternion>(), 1.f, 1}
+    }, 0, removedTarget);
+
+    TargetPosition target;
+    target.SetPosition({1, 1.5, 0});
+    SolverBase& solver = GetSkeleton().AddSolver({
+        BoneDesc{ glm::identity<Quaternion>(), 1.f, 2},
+        BoneDesc{ glm::identity<Quaternion>(), 1.f, 3},
+        BoneDesc{ glm::identity<Quaternion>(), 1.f, 4}
+    }, 2, target);
+
+    GetSkeleton().RemoveSolver(removed);
+    GetSkeleton().Finalize();
+    ASSERT_EQ(1, GetSkeleton().GetSolversCount());
+    ASSERT_EQ(3, GetSkeleton().GetRootChain(solver).size());
+
+    // the chain left in the plan is solved the same way as before the compaction
+    GetSkeleton().Update(50);
+    ASSERT_LT(glm::length(solver.GetTipPosition() - target.GetPosition()), 1e-2);
+}
+
 TEST_F(SkeletonBaseTest, one_bone_chain)
 {
     TargetPosition target;
@@ -365,6 +392,48 @@ TEST_F(SkeletonChainingTest, branches_independent)
     ASSERT_FALSE(solvers[2].get().HasDependencies());
 }
 
+TEST_F(SkeletonChainingTest, storage_dense_slots)
+{
+    ConstructSkeleton({0, 5, 7});
+    // 9 registered bones and the skeleton root
+    ASSERT_EQ(10LLU, GetSkeleton().GetStorage().Size());
+}
+
+TEST_F(SkeletonChainingTest, storage_packed_chain)
+{
+    auto& solvers = ConstructSkeleton({0, 5, 7});
+    auto& branchChain = GetSkeleton().GetRootChain(solvers[2]);
+    ASSERT_EQ(2LLU, branchChain.size());
+    ASSERT_EQ(branchChain[0].get().GetIndex() + 1, branchChain[1].get().GetIndex());
+}
+
+TEST_F(SkeletonChainingTest, storage_view)
+{
+    ConstructSkeleton({0, 5, 7});
+    const auto& bone = *GetSkeleton().GetBones().at(6);
+    ASSERT_TRUE(TestHelpers::CompareVectors(GetSkeleton().GetStorage().positions[bone.GetIndex()], bone.GetPosition()));
+}
+
+TEST_F(SkeletonChainingTest, incremental_positions)
+{
+    ConstructSkeleton({0, 5, 7});
+    GetSkeleton().FinalizeChains();
+
+    // rotate the spine bone, all bones after it have to turn around its joint
+    const Vector joint {0, 1, 0};
+    Quaternion turn = glm::angleAxis(glm::pi<real>() / 2, Vector{0, 0, 1});
+    Bone& bone = *GetSkeleton().GetBones().at(1);
+    bone.SetRotation(turn * bone.GetRotation());
+    GetSkeleton().FinalizeChains();
+
+    std::vector<std::pair<size_t, Vector>> expected {{1, {0, 1, 0}}, {3, {0, 3, 0}}, {6, {1, 2, 0}}, {8, {1, 4, 0}}};
+    for (const auto& [index, position] : expected)
+    {
+        Vector reference = joint + turn * (position - joint);
+        ASSERT_TRUE(TestHelpers::CompareVectors(reference, GetSkeleton().GetBones().at(index)->GetPosition())) << " Failed on " << index << "th bone";
+    }
+}
+
 class Skeleton3DChainingTest : public SkeletonBaseTest
 {
 public: 
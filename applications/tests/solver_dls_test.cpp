@@ -0,0 +1,231 @@
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "test_helpers.h"
+#include "light_ik/light_ik.h"
+
+namespace LightIK
+{
+
+// Passive spine with two arms attached to its tip, the targets are out of reach of the arms alone
+class SolverDlsTest : public ::testing::Test
+{
+protected:
+    SolverDlsTest()
+        : m_library(10)
+    {
+        Quaternion side = glm::angleAxis(glm::half_pi<real>(), Vector{0, 0, 1});
+        std::vector<BoneDesc> spine;
+        for (int i = 0; i < 4; ++i)
+        {
+            spine.emplace_back(BoneDesc{glm::identity<Quaternion>(), 1, i});
+        }
+        std::vector<BoneDesc> leftArm  = spine;
+        std::vector<BoneDesc> rightArm = spine;
+        for (int i = 0; i < 3; ++i)
+        {
+            leftArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : side, 1, 4 + i});
+            rightArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : glm::inverse(side), 1, 7 + i});
+        }
+
+        m_library.CreatePassiveChain(spine);
+        m_left  = m_library.CreateIKChain(leftArm, 4, m_leftTarget);
+        m_right = m_library.CreateIKChain(rightArm, 7, m_rightTarget);
+
+        Convergence convergence;
+        convergence.tolerance = real(1e-3);
+        m_library.SetConvergence(m_left, convergence);
+        m_library.SetConvergence(m_right, convergence);
+
+        m_leftTarget.SetPosition({-2.2, 2.5, 1.5});
+        m_rightTarget.SetPosition({2.2, 2.5, 1.5});
+    }
+
+    real GetError(size_t chain, const TargetPosition& target)
+    {
+        return glm::length(m_library.GetTipPosition(chain) - target.GetPosition());
+    }
+
+    LightIK         m_library;
+    TargetPosition  m_leftTarget;
+    TargetPosition  m_rightTarget;
+    size_t          m_left  = 0;
+    size_t          m_right = 0;
+};
+
+TEST_F(SolverDlsTest, separate_chains_miss_targets)
+{
+    m_library.Update(100);
+
+    ASSERT_GT(GetError(m_left, m_leftTarget), 0.05);
+    ASSERT_GT(GetError(m_right, m_rightTarget), 0.05);
+}
+
+TEST_F(SolverDlsTest, group_bends_spine_to_reach)
+{
+    ASSERT_TRUE(m_library.CreateEffectorGroup({0, m_left, m_right}));
+
+    ASSERT_LT(m_library.Update(100), 100);
+
+    ASSERT_EQ(StopReason::reached, m_library.GetStopReason(m_left));
+    ASSERT_EQ(StopReason::reached, m_library.GetStopReason(m_right));
+    ASSERT_LT(GetError(m_left, m_leftTarget), 1e-3);
+    ASSERT_LT(GetError(m_right, m_rightTarget), 1e-3);
+}
+
+TEST_F(SolverDlsTest, group_requires_common_chain)
+{
+    // arms are attached to the spine that is not in the group
+    ASSERT_FALSE(m_library.CreateEffectorGroup({m_left, m_right}));
+    ASSERT_FALSE(m_library.CreateEffectorGroup({0, m_left, m_left}));
+    ASSERT_TRUE(m_library.CreateEffectorGroup({m_right, 0, m_left}));
+    // chain can not be a member of two groups
+    ASSERT_FALSE(m_library.CreateEffectorGroup({0, m_left}));
+}
+
+TEST(SolverDlsGroupTest, shared_spine)
+{
+    // both arms start from the skeleton root, so the IK parts of the arms share the spine bones
+    const Quaternion side = glm::angleAxis(glm::half_pi<real>(), Vector{0, 0, 1});
+    std::vector<BoneDesc> leftArm;
+    for (int i = 0; i < 4; ++i)
+    {
+        leftArm.emplace_back(BoneDesc{glm::identity<Quaternion>(), 1, i});
+    }
+    std::vector<BoneDesc> rightArm  = leftArm;
+    for (int i = 0; i < 3; ++i)
+    {
+        leftArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : side, 1, 4 + i});
+        rightArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : glm::inverse(side), 1, 7 + i});
+    }
+
+    LightIK library(10);
+    TargetPosition leftTarget({-2.2, 2.5, 1.5});
+    TargetPosition rightTarget({2.2, 2.5, 1.5});
+    const size_t left       = library.CreateIKChain(leftArm, 0, leftTarget);
+    const size_t right      = library.CreateIKChain(rightArm, 0, rightTarget);
+    Convergence convergence;
+    convergence.tolerance   = real(1e-3);
+    library.SetConvergence(left, convergence);
+    library.SetConvergence(right, convergence);
+    ASSERT_TRUE(library.CreateEffectorGroup({left, right}));
+
+    ASSERT_LT(library.Update(100), 100);
+
+    ASSERT_EQ(StopReason::reached, library.GetStopReason(left));
+    ASSERT_EQ(StopReason::reached, library.GetStopReason(right));
+    ASSERT_LT(glm::length(library.GetTipPosition(left) - leftTarget.GetPosition()), 1e-3);
+    ASSERT_LT(glm::length(library.GetTipPosition(right) - rightTarget.GetPosition()), 1e-3);
+}
+
+TEST(SolverDlsGroupTest, partial_flexibility)
+{
+    // the arms of shared_spine with all bones half flexible
+    const Quaternion side = glm::angleAxis(glm::half_pi<real>(), Vector{0, 0, 1});
+    std::vector<BoneDesc> leftArm;
+    for (int i = 0; i < 4; ++i)
+    {
+        leftArm.emplace_back(BoneDesc{glm::identity<Quaternion>(), 1, i});
+    }
+    std::vector<BoneDesc> rightArm  = leftArm;
+    for (int i = 0; i < 3; ++i)
+    {
+        leftArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : side, 1, 4 + i});
+        rightArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : glm::inverse(side), 1, 7 + i});
+    }
+
+    LightIK library(10);
+    TargetPosition leftTarget({-2.2, 2.5, 1.5});
+    TargetPosition rightTarget({2.2, 2.5, 1.5});
+    const size_t left       = library.CreateIKChain(leftArm, 0, leftTarget);
+    const size_t right      = library.CreateIKChain(rightArm, 0, rightTarget);
+    for (size_t bone = 0; bone < 10; ++bone)
+    {
+        Constraints constraint;
+        constraint.flexibility = (real)0.5;
+        library.SetConstraint(bone, std::move(constraint));
+    }
+    ASSERT_TRUE(library.CreateEffectorGroup({left, right}, (real)0.01));
+    // bends the arms away from the rest pose
+    library.Update(2);
+
+    // the targets close to the tips are reached by the linearized step, the step scaled by the flexibility
+    //  instead of the weight of the system overshoots them twice as far
+    leftTarget.SetPosition(library.GetTipPosition(left) + Vector{0.01, -0.005, 0.01});
+    rightTarget.SetPosition(library.GetTipPosition(right) + Vector{-0.005, 0.01, 0.01});
+    real leftError  = glm::length(library.GetTipPosition(left) - leftTarget.GetPosition());
+    real rightError = glm::length(library.GetTipPosition(right) - rightTarget.GetPosition());
+    for (int iteration = 0; iteration < 5; ++iteration)
+    {
+        library.Update(1);
+        const real leftStep     = glm::length(library.GetTipPosition(left) - leftTarget.GetPosition());
+        const real rightStep    = glm::length(library.GetTipPosition(right) - rightTarget.GetPosition());
+        ASSERT_LT(leftStep, (real)0.25 * leftError);
+        ASSERT_LT(rightStep, (real)0.25 * rightError);
+        leftError   = leftStep;
+        rightError  = rightStep;
+        if (leftError < 1e-4 && rightError < 1e-4)
+        {
+            break;
+        }
+    }
+}
+
+TEST(SolverDlsGroupTest, link_to_group_member)
+{
+    // passive spine with two arms solved by the group and the separate chain that follows the tip of the right arm
+    const Quaternion side = glm::angleAxis(glm::half_pi<real>(), Vector{0, 0, 1});
+    std::vector<BoneDesc> spine;
+    for (int i = 0; i < 4; ++i)
+    {
+        spine.emplace_back(BoneDesc{glm::identity<Quaternion>(), 1, i});
+    }
+    std::vector<BoneDesc> leftArm   = spine;
+    std::vector<BoneDesc> rightArm  = spine;
+    for (int i = 0; i < 3; ++i)
+    {
+        leftArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : side, 1, 4 + i});
+        rightArm.emplace_back(BoneDesc{i ? glm::identity<Quaternion>() : glm::inverse(side), 1, 7 + i});
+    }
+    const std::vector<BoneDesc> follower {{glm::identity<Quaternion>(), 1, 10}, {glm::identity<Quaternion>(), 1, 11}};
+
+    // the follower is created before the right arm, so only the group orders it after the arm
+    LightIK library(12);
+    TargetPosition leftTarget({-2.2, 2.5, 1.5});
+    TargetPosition rightTarget({2.2, 2.5, 1.5});
+    library.CreatePassiveChain(spine);
+    const size_t left       = library.CreateIKChain(leftArm, 4, leftTarget);
+    TargetBone& tip         = library.CreateInternalTarget();
+    const size_t link       = library.CreateIKChain(follower, 10, tip);
+    const size_t right      = library.CreateIKChain(rightArm, 7, rightTarget);
+    tip.AssignBone(9);
+    ASSERT_TRUE(library.CreateEffectorGroup({0, left, right}));
+
+    // the same chains in the order they are solved
+    LightIK expected(12);
+    expected.CreatePassiveChain(spine);
+    const size_t expectedLeft   = expected.CreateIKChain(leftArm, 4, leftTarget);
+    const size_t expectedRight  = expected.CreateIKChain(rightArm, 7, rightTarget);
+    const size_t expectedLink   = expected.CreateIKLink(follower, 10, 9);
+    ASSERT_TRUE(expected.CreateEffectorGroup({0, expectedLeft, expectedRight}));
+
+    library.SetThreadPool(LightIK::CreateThreadPool(3));
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        library.Update(10);
+        expected.Update(10);
+        ASSERT_EQ(expected.GetTipPosition(expectedRight), library.GetTipPosition(right));
+        ASSERT_EQ(expected.GetTipPosition(expectedLink), library.GetTipPosition(link));
+    }
+
+    // sequential update of the batches keeps the same order
+    library.SetThreadPool(nullptr);
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        library.Update(10);
+        expected.Update(10);
+        ASSERT_EQ(expected.GetTipPosition(expectedLink), library.GetTipPosition(link));
+    }
+}
+
+}
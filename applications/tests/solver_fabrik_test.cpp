@@ -0,0 +1,83 @@
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "test_helpers.h"
+#include "test_body.h"
+#include "../../light_ik/headers/solver_fabrik.h"
+
+namespace LightIK
+{
+
+class SolverFabrikTest : public ::testing::Test, public LightIKTestBody
+{
+protected:
+    void SetUp() override
+    {
+        m_solver = &AddSolver({Vector{0, 1, 0}, {0, 2, 0}, {0, 3, 0}, {0, 4, 0}, {0, 5, 0}}, 0, m_target, SolverType::fabrik);
+    }
+
+    SolverBase& GetSolver()
+    {
+        return *m_solver;
+    }
+
+    TargetPosition& GetTarget()
+    {
+        return m_target;
+    }
+
+private:
+    SolverBase* m_solver;
+    TargetPosition m_target;
+};
+
+TEST_F(SolverFabrikTest, selected_by_type)
+{
+    ASSERT_TRUE(dynamic_cast<SolverFabrik*>(&GetSolver()));
+    ASSERT_EQ(5, GetSolver().GetChainSize());
+}
+
+TEST_F(SolverFabrikTest, reach_target)
+{
+    Convergence convergence;
+    convergence.tolerance = 1e-4;
+    GetSolver().SetConvergence(convergence);
+    Vector target{1, 3, 2};
+    GetTarget().SetPosition(target);
+
+    GetSkeleton().Update(100);
+
+    ASSERT_EQ(StopReason::reached, GetSkeleton().GetStopReason(GetSolver()));
+    ASSERT_NEAR(0, glm::length(target - GetSolver().GetTipPosition()), 1e-4);
+}
+
+TEST_F(SolverFabrikTest, unreachable_direction)
+{
+    Vector target{4, 6, 2};
+    GetTarget().SetPosition(target);
+
+    GetSkeleton().Update(10);
+
+    // the chain straightens towards the target geometrically with the iterations
+    Vector direction = glm::normalize(target - GetSolver().GetRootPosition());
+    Vector tip       = GetSolver().GetTipPosition() - GetSolver().GetRootPosition();
+    ASSERT_NEAR(0, glm::length(direction - glm::normalize(tip)), 1e-4);
+    ASSERT_NEAR(5, glm::length(tip), 1e-4);
+}
+
+TEST_F(SolverFabrikTest, constraints_respected)
+{
+    const real limit = 0.2;
+    GetSkeleton().SetConstraint(2, Constraints{1, {-limit, -limit, -limit}, {limit, limit, limit}});
+    GetTarget().SetPosition({2, 1, 1});
+
+    GetSkeleton().Update(20);
+
+    Vector angles = Helpers::ToEulerXZY(GetSkeleton().GetBones()[2]->GetRotation());
+    for (size_t i = 0; i < 3; ++i)
+    {
+        ASSERT_LE(glm::abs(angles[i]), limit + 1e-5);
+    }
+}
+
+}
@@ -0,0 +1,102 @@
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "test_helpers.h"
+#include "test_body.h"
+#include "../../light_ik/headers/solver_two_bone.h"
+
+namespace LightIK
+{
+
+class SolverTwoBoneTest : public ::testing::Test, public LightIKTestBody
+{
+protected:
+    void SetUp() override
+    {
+        // bone 0 holds the limb, bones 1 and 2 form the slightly bent limb
+        m_solver = &AddSolver({Vector{0, 1, 0}, {0, 2, 0.2}, {0, 3, 0}}, 1, m_target);
+    }
+
+    SolverBase& GetSolver()
+    {
+        return *m_solver;
+    }
+
+    TargetPosition& GetTarget()
+    {
+        return m_target;
+    }
+
+    const Vector& GetMiddleJoint()
+    {
+        return GetSkeleton().GetBones()[2]->GetPosition();
+    }
+
+private:
+    SolverBase* m_solver;
+    TargetPosition m_target;
+};
+
+TEST_F(SolverTwoBoneTest, selected_for_two_bones)
+{
+    TargetPosition target;
+    SolverBase& longChain = AddSolver({Vector{0, 1, 0}, {0, 2, 0}, {0, 3, 0}, {0, 4, 0}}, 1, target);
+
+    ASSERT_TRUE(GetSolver().IsClosedForm());
+    ASSERT_FALSE(longChain.IsClosedForm());
+    ASSERT_FALSE(GetSkeleton().SetPole(longChain, Vector{1, 0, 0}));
+}
+
+TEST_F(SolverTwoBoneTest, reach_in_one_step)
+{
+    Vector target{1, 2, 0.5};
+    GetTarget().SetPosition(target);
+
+    ASSERT_EQ(1, GetSkeleton().Update(10));
+    ASSERT_EQ(StopReason::reached, GetSkeleton().GetStopReason(GetSolver()));
+    ASSERT_TRUE(TestHelpers::CompareVectors(target, GetSolver().GetTipPosition()));
+}
+
+TEST_F(SolverTwoBoneTest, unreachable_direction)
+{
+    Vector target{3, 4, 1};
+    GetTarget().SetPosition(target);
+
+    ASSERT_EQ(1, GetSkeleton().Update(10));
+    ASSERT_EQ(StopReason::stalled, GetSkeleton().GetStopReason(GetSolver()));
+    ASSERT_TRUE(TestHelpers::CompareDirections(target - GetSolver().GetRootPosition(),
+                                               GetSolver().GetTipPosition() - GetSolver().GetRootPosition()));
+}
+
+TEST_F(SolverTwoBoneTest, pole_selects_bending_side)
+{
+    GetTarget().SetPosition({0, 2.5, 0});
+
+    ASSERT_TRUE(GetSkeleton().SetPole(GetSolver(), Vector{2, 2, 0}));
+    GetSkeleton().Update(1);
+    ASSERT_GT(GetMiddleJoint().x, 0.1);
+    ASSERT_NEAR(0, GetMiddleJoint().z, 1e-6);
+
+    ASSERT_TRUE(GetSkeleton().SetPole(GetSolver(), Vector{-2, 2, 0}));
+    GetSkeleton().Update(1);
+    ASSERT_LT(GetMiddleJoint().x, -0.1);
+    ASSERT_TRUE(TestHelpers::CompareVectors(GetTarget().GetPosition(), GetSolver().GetTipPosition()));
+}
+
+TEST_F(SolverTwoBoneTest, constraints_respected)
+{
+    const real limit = 0.3;
+    GetSkeleton().SetConstraint(2, Constraints{1, {-limit, -limit, -limit}, {limit, limit, limit}});
+    GetTarget().SetPosition({0, 1.5, 0.5});
+
+    GetSkeleton().Update(1);
+
+    Vector angles = Helpers::ToEulerXZY(GetSkeleton().GetBones()[2]->GetRotation());
+    for (size_t i = 0; i < 3; ++i)
+    {
+        ASSERT_LE(glm::abs(angles[i]), limit + 1e-5);
+    }
+    ASSERT_FALSE(TestHelpers::CompareVectors(GetTarget().GetPosition(), GetSolver().GetTipPosition()));
+}
+
+}
@@ -70,12 +70,12 @@ std::vector<BoneDesc> LightIKTestBody::ConstructSkeleton(const std::vector<std::
     return descriptors;
 }
 
-SolverBase& LightIKTestBody::AddSolver(const std::vector<Vector>& chain, size_t startIndex, Target& target)
+SolverBase& LightIKTestBody::AddSolver(const std::vector<Vector>& chain, size_t startIndex, Target& target, SolverType solverType)
 {
     // add solver based on provided descriptions of the bones, 
     // IK chain is build on a part of the chain starting from startIndex (bone index)
     auto descriptors = ConstructDescriptors(chain);
-    return m_skeleton->AddSolver(descriptors, startIndex, target);
+    return m_skeleton->AddSolver(descriptors, startIndex, target, solverType);
 }
 
 std::vector<SolverRef> LightIKTestBody::CreateSolvers(
@@ -22,7 +22,7 @@ public:
     std::vector<BoneDesc> ConstructSkeleton(const std::vector<std::vector<Vector>>& skeleton); 
     
     // Add IK chain
-    SolverBase& AddSolver(const std::vector<Vector>& chain, size_t startIndex, Target& target);
+    SolverBase& AddSolver(const std::vector<Vector>& chain, size_t startIndex, Target& target, SolverType solverType = SolverType::automatic);
 
     std::vector<SolverRef> CreateSolvers(
         const std::vector<BoneDesc>& skeleton, 
@@ -5,7 +5,8 @@
 namespace LightIK
 {
 
-static const real TestTolerance     = 1e-7;
+// single precision solver reaches the target with lower accuracy
+static const real TestTolerance     = std::is_same_v<real, float> ? (real)1e-4 : (real)1e-7;
     
 class TestHelpers
 {
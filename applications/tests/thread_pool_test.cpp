@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include "../../light_ik/headers/thread_pool.h"
+
+namespace LightIK
+{
+
+TEST(ThreadPoolTest, executes_all_tasks)
+{
+    ThreadPool pool(3);
+    std::atomic<size_t> pending = 100;
+    std::atomic<size_t> executed = 0;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        pool.Submit([&]() { ++executed; --pending; });
+    }
+    pool.Wait(pending);
+
+    ASSERT_EQ(100, executed);
+}
+
+TEST(ThreadPoolTest, no_worker_threads)
+{
+    ThreadPool pool(0);
+    std::atomic<size_t> pending = 2;
+    // tasks submitted from the task are executed by the waiting thread as well
+    pool.Submit([&]() { pool.Submit([&]() { --pending; }); --pending; });
+    pool.Wait(pending);
+
+    ASSERT_EQ(0, pending);
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "types.h"
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace LightIK
+{
+
+/// @brief Deleter of the objects placed into the arena, it only destroys the object,
+///        the memory is returned all at once when the arena is reset
+struct ArenaDelete
+{
+    template <class T>
+    void operator()(T* object) const                        { std::destroy_at(object); }
+};
+
+template <class T>
+using ArenaPtr      = std::unique_ptr<T, ArenaDelete>;
+
+template <class T>
+using ArenaVector   = std::pmr::vector<T>;
+
+/// @brief Monotonic memory arena of the skeleton instance. Chains, solvers, targets and their bone lists
+///        are placed into the arena, so the construction does not stress the global heap and all memory
+///        is released at once when the skeleton structure is reset.
+class Arena
+{
+public:
+    /// @brief Constructs the arena, memory is requested from the heap on the first allocation
+    /// @param initialSize size of the first memory block, the next blocks grow geometrically
+    Arena(size_t initialSize)
+        : m_resource(initialSize)
+    {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// @brief Constructs the object inside the arena
+    /// @return owning pointer, that destroys the object without releasing the memory
+    template <class T, class... Args>
+    ArenaPtr<T> Make(Args&&... args)
+    {
+        std::pmr::polymorphic_allocator<T> allocator(&m_resource);
+        T* object = allocator.allocate(1);
+        return ArenaPtr<T>(std::construct_at(object, std::forward<Args>(args)...));
+    }
+
+    /// @brief Returns the memory resource to place containers into the arena
+    std::pmr::memory_resource* GetResource()                { return &m_resource; }
+
+    /// @brief Returns all memory to the heap, all objects of the arena must be destroyed before
+    void Reset()                                            { m_resource.release(); }
+
+private:
+    std::pmr::monotonic_buffer_resource m_resource;
+};
+
+}
@@ -0,0 +1,297 @@
+#pragma once
+#include "types.h"
+#include "bone_storage.h"
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <cassert>
+
+namespace LightIK
+{
+
+// Number of skeleton instances processed by one batch operation, it matches one 256 bit register:
+// 4 lanes for double precision, 8 lanes for single precision.
+constexpr size_t BatchLanes = 32 / sizeof(real);
+
+// All pack operations are written as plain loops over the lanes with no data dependent branches,
+// so the compiler is able to map each of them onto vector instructions.
+#define LIGHT_IK_FOR_LANES(k) for (size_t k = 0; k < BatchLanes; ++k)
+
+// Lanes of the mask have the same width as the real values, so the comparisons and selections
+// map onto the vector compare and blend instructions.
+using MaskLane = std::conditional_t<sizeof(real) == sizeof(int64_t), int64_t, int32_t>;
+
+/// @brief Lane mask, result of the per-lane comparison. Each lane is either all bits set or zero.
+struct PackMask
+{
+    MaskLane v[BatchLanes];
+
+    static PackMask Broadcast(bool value)   { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = value ? -1 : 0; return r; }
+    
+    bool Get(size_t lane) const             { return v[lane] != 0; }
+    void Set(size_t lane, bool value)       { v[lane] = value ? -1 : 0; }
+};
+
+inline PackMask operator&&(const PackMask& a, const PackMask& b)    { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] & b.v[k]; return r; }
+inline PackMask operator||(const PackMask& a, const PackMask& b)    { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] | b.v[k]; return r; }
+inline PackMask operator!(const PackMask& a)                        { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = ~a.v[k]; return r; }
+inline bool Any(const PackMask& a)                                  { MaskLane r = 0;  LIGHT_IK_FOR_LANES(k) r |= a.v[k]; return r != 0; }
+inline bool All(const PackMask& a)                                  { MaskLane r = -1; LIGHT_IK_FOR_LANES(k) r &= a.v[k]; return r != 0; }
+
+/// @brief The same scalar value for several skeleton instances
+struct alignas(32) Pack
+{
+    real v[BatchLanes];
+
+    static Pack Broadcast(real value)       { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = value; return r; }
+
+    // loads count values starting from the data, the rest of the lanes is filled by the given value
+    static Pack Load(const real* data, size_t count, real fill)
+    {
+        Pack r;
+        if (count == BatchLanes)
+        {
+            LIGHT_IK_FOR_LANES(k) r.v[k] = data[k];
+            return r;
+        }
+        LIGHT_IK_FOR_LANES(k) r.v[k] = k < count ? data[k] : fill;
+        return r;
+    }
+    void Store(real* data, size_t count) const
+    {
+        if (count == BatchLanes)
+        {
+            LIGHT_IK_FOR_LANES(k) data[k] = v[k];
+            return;
+        }
+        LIGHT_IK_FOR_LANES(k) if (k < count) data[k] = v[k];
+    }
+};
+
+inline Pack operator+(const Pack& a, const Pack& b)     { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] + b.v[k]; return r; }
+inline Pack operator-(const Pack& a, const Pack& b)     { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] - b.v[k]; return r; }
+inline Pack operator*(const Pack& a, const Pack& b)     { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] * b.v[k]; return r; }
+inline Pack operator/(const Pack& a, const Pack& b)     { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] / b.v[k]; return r; }
+inline Pack operator+(const Pack& a, real b)            { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] + b; return r; }
+inline Pack operator-(const Pack& a, real b)            { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] - b; return r; }
+inline Pack operator-(real a, const Pack& b)            { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a - b.v[k]; return r; }
+inline Pack operator/(real a, const Pack& b)            { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a / b.v[k]; return r; }
+inline Pack operator*(const Pack& a, real b)            { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] * b; return r; }
+inline Pack operator*(real a, const Pack& b)            { return b * a; }
+inline Pack operator-(const Pack& a)                    { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = -a.v[k]; return r; }
+
+inline PackMask operator<(const Pack& a, const Pack& b) { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = (a.v[k] < b.v[k]) ? -1 : 0; return r; }
+inline PackMask operator>(const Pack& a, const Pack& b) { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = (a.v[k] > b.v[k]) ? -1 : 0; return r; }
+inline PackMask operator<(const Pack& a, real b)        { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = (a.v[k] < b) ? -1 : 0; return r; }
+inline PackMask operator>(const Pack& a, real b)        { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = (a.v[k] > b) ? -1 : 0; return r; }
+inline PackMask operator<=(const Pack& a, real b)       { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = (a.v[k] <= b) ? -1 : 0; return r; }
+inline PackMask operator==(const Pack& a, real b)       { PackMask r; LIGHT_IK_FOR_LANES(k) r.v[k] = (a.v[k] == b) ? -1 : 0; return r; }
+
+inline Pack Select(const PackMask& m, const Pack& a, const Pack& b)
+{
+    // bitwise blend, unlike the conditional it does not need the mask comparison instructions
+    Pack r; 
+    LIGHT_IK_FOR_LANES(k) r.v[k] = std::bit_cast<real>((std::bit_cast<MaskLane>(a.v[k]) & m.v[k]) | (std::bit_cast<MaskLane>(b.v[k]) & ~m.v[k]));
+    return r;
+}
+
+inline Pack Min(const Pack& a, const Pack& b)           { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] < b.v[k] ? a.v[k] : b.v[k]; return r; }
+inline Pack Max(const Pack& a, const Pack& b)           { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = a.v[k] > b.v[k] ? a.v[k] : b.v[k]; return r; }
+inline Pack Clamp(const Pack& a, const Pack& lo, const Pack& hi)    { return Min(Max(a, lo), hi); }
+inline Pack Clamp(const Pack& a, real lo, real hi)      { return Clamp(a, Pack::Broadcast(lo), Pack::Broadcast(hi)); }
+inline Pack Abs(const Pack& a)                          { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = std::abs(a.v[k]); return r; }
+inline Pack Sign(const Pack& a)                         { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = (real)((real)0 < a.v[k]) - (real)(a.v[k] < (real)0); return r; }
+inline Pack Sqrt(const Pack& a)                         { Pack r; LIGHT_IK_FOR_LANES(k) r.v[k] = std::sqrt(a.v[k]); return r; }
+
+// Transcendental functions use branch-free polynomial kernels (Cephes coefficients) instead of the libm calls,
+// so they vectorize as well. The error stays within a few ulp for the angles the solver works with.
+Pack Sin(const Pack& a);
+Pack Cos(const Pack& a);
+void SinCos(const Pack& a, Pack& sine, Pack& cosine);
+Pack Asin(const Pack& a);
+Pack Acos(const Pack& a);
+Pack Atan(const Pack& a);
+Pack Atan2(const Pack& y, const Pack& x);
+
+/// @brief Vector of several skeleton instances, components are stored separately
+struct PackVector
+{
+    Pack x, y, z;
+
+    static PackVector Broadcast(const Vector& value)
+    {
+        return {Pack::Broadcast(value.x), Pack::Broadcast(value.y), Pack::Broadcast(value.z)};
+    }
+
+    Vector Get(size_t lane) const                           { return {x.v[lane], y.v[lane], z.v[lane]}; }
+    void Set(size_t lane, const Vector& value)              { x.v[lane] = value.x; y.v[lane] = value.y; z.v[lane] = value.z; }
+};
+
+inline PackVector operator+(const PackVector& a, const PackVector& b)   { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline PackVector operator-(const PackVector& a, const PackVector& b)   { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline PackVector operator*(const PackVector& a, const Pack& b)         { return {a.x * b, a.y * b, a.z * b}; }
+inline PackVector operator*(const PackVector& a, real b)                { return {a.x * b, a.y * b, a.z * b}; }
+
+inline Pack Dot(const PackVector& a, const PackVector& b)               { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Pack Length2(const PackVector& a)                                { return Dot(a, a); }
+inline PackVector Cross(const PackVector& a, const PackVector& b)
+{
+    return {a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y};
+}
+inline PackVector Normalize(const PackVector& a)
+{
+    Pack inverseLength;
+    Pack length2 = Dot(a, a);
+    LIGHT_IK_FOR_LANES(k) inverseLength.v[k] = (real)1 / std::sqrt(length2.v[k]);
+    return a * inverseLength;
+}
+inline PackVector Select(const PackMask& m, const PackVector& a, const PackVector& b)
+{
+    return {Select(m, a.x, b.x), Select(m, a.y, b.y), Select(m, a.z, b.z)};
+}
+
+/// @brief Quaternion of several skeleton instances, components are stored separately
+struct PackQuaternion
+{
+    Pack w, x, y, z;
+
+    static PackQuaternion Broadcast(const Quaternion& value)
+    {
+        return {Pack::Broadcast(value.w), Pack::Broadcast(value.x), Pack::Broadcast(value.y), Pack::Broadcast(value.z)};
+    }
+    static PackQuaternion Identity()                        { return Broadcast(glm::identity<Quaternion>()); }
+
+    Quaternion Get(size_t lane) const                       { return Quaternion{w.v[lane], x.v[lane], y.v[lane], z.v[lane]}; }
+    void Set(size_t lane, const Quaternion& value)          { w.v[lane] = value.w; x.v[lane] = value.x; y.v[lane] = value.y; z.v[lane] = value.z; }
+};
+
+inline PackQuaternion operator*(const PackQuaternion& p, const PackQuaternion& q)
+{
+    return {
+        p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z,
+        p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y,
+        p.w * q.y + p.y * q.w + p.z * q.x - p.x * q.z,
+        p.w * q.z + p.z * q.w + p.x * q.y - p.y * q.x
+    };
+}
+
+inline PackVector operator*(const PackQuaternion& q, const PackVector& v)
+{
+    const PackVector axis{q.x, q.y, q.z};
+    const PackVector uv  = Cross(axis, v);
+    const PackVector uuv = Cross(axis, uv);
+    return v + ((uv * q.w) + uuv) * (real)2;
+}
+
+inline Pack Dot(const PackQuaternion& a, const PackQuaternion& b)       { return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline PackQuaternion Inverse(const PackQuaternion& q)
+{
+    Pack inverseDot = (real)1 / Dot(q, q);
+    return {q.w * inverseDot, -q.x * inverseDot, -q.y * inverseDot, -q.z * inverseDot};
+}
+
+inline PackQuaternion Normalize(const PackQuaternion& q)
+{
+    Pack length = Sqrt(Dot(q, q));
+    PackMask valid = length > (real)0;
+    Pack inverseLength = Select(valid, (real)1 / length, Pack::Broadcast(0));
+    return {
+        Select(valid, q.w * inverseLength, Pack::Broadcast(1)),
+        q.x * inverseLength,
+        q.y * inverseLength,
+        q.z * inverseLength
+    };
+}
+
+inline PackQuaternion AngleAxis(const Pack& angle, const PackVector& axis)
+{
+    Pack s, c;
+    SinCos(angle * (real)0.5, s, c);
+    return {c, axis.x * s, axis.y * s, axis.z * s};
+}
+
+inline PackQuaternion Select(const PackMask& m, const PackQuaternion& a, const PackQuaternion& b)
+{
+    return {Select(m, a.w, b.w), Select(m, a.x, b.x), Select(m, a.y, b.y), Select(m, a.z, b.z)};
+}
+
+/// @brief Structure-of-arrays view of the vectors, the component spans have the same size
+template <typename T>
+struct BasicVectorSpan
+{
+    std::span<T> x, y, z;
+
+    BasicVectorSpan(std::span<T> x, std::span<T> y, std::span<T> z) : x(x), y(y), z(z) { assert(x.size() == y.size() && x.size() == z.size()); }
+    template <typename U>
+    BasicVectorSpan(const BasicVectorSpan<U>& other) : x(other.x), y(other.y), z(other.z) {}
+
+    size_t size() const                                     { return x.size(); }
+
+    PackVector Load(size_t offset, size_t count, const Vector& fill) const
+    {
+        return {Pack::Load(&x[offset], count, fill.x), Pack::Load(&y[offset], count, fill.y), Pack::Load(&z[offset], count, fill.z)};
+    }
+    void Store(size_t offset, size_t count, const PackVector& value) const
+    {
+        value.x.Store(&x[offset], count); value.y.Store(&y[offset], count); value.z.Store(&z[offset], count);
+    }
+};
+using VectorSpan        = BasicVectorSpan<real>;
+using ConstVectorSpan   = BasicVectorSpan<const real>;
+
+/// @brief Structure-of-arrays view of the quaternions, the component spans have the same size
+template <typename T>
+struct BasicQuaternionSpan
+{
+    std::span<T> w, x, y, z;
+
+    BasicQuaternionSpan(std::span<T> w, std::span<T> x, std::span<T> y, std::span<T> z) : w(w), x(x), y(y), z(z) 
+    { 
+        assert(w.size() == x.size() && w.size() == y.size() && w.size() == z.size());
+    }
+    template <typename U>
+    BasicQuaternionSpan(const BasicQuaternionSpan<U>& other) : w(other.w), x(other.x), y(other.y), z(other.z) {}
+
+    size_t size() const                                     { return w.size(); }
+
+    PackQuaternion Load(size_t offset, size_t count) const
+    {
+        // the tail lanes are identity rotations, so no degenerate case appears there
+        return {Pack::Load(&w[offset], count, 1), Pack::Load(&x[offset], count, 0), Pack::Load(&y[offset], count, 0), Pack::Load(&z[offset], count, 0)};
+    }
+    void Store(size_t offset, size_t count, const PackQuaternion& value) const
+    {
+        value.w.Store(&w[offset], count); value.x.Store(&x[offset], count); value.y.Store(&y[offset], count); value.z.Store(&z[offset], count);
+    }
+};
+using QuaternionSpan        = BasicQuaternionSpan<real>;
+using ConstQuaternionSpan   = BasicQuaternionSpan<const real>;
+
+/// @brief Lane-parallel versions of the math helpers, every degenerate case is resolved by the lane selection
+class PackHelpers
+{
+public:
+    static PackVector           Normal(const PackVector& axis1, const PackVector& axis2);
+    static void                 CalculateParameters(const PackVector& from, const PackVector& to, PackVector& axis, Pack& angle);
+    static PackQuaternion       CalculateRotation(const PackVector& from, const PackVector& to);
+    static Pack                 TriangleAngle(const Pack& adjacent1, const Pack& adjacent2, const Pack& opposite);
+    static PackVector           ToEulerXZY(const PackQuaternion& q);
+    static PackQuaternion       FromEulerXZY(const PackVector& angles);
+    static PackQuaternion       ClampSwingTwist(const PackQuaternion& q, const ConstraintLimits& limits);
+
+    // Array versions of the helpers, the values are processed by packs of BatchLanes, the output spans must have
+    // the size of the input ones. They let the bones or instances stored in SoA form skip the per value calls
+    static void                 Normal(const ConstVectorSpan& axis1, const ConstVectorSpan& axis2, const VectorSpan& normals);
+    static void                 CalculateParameters(const ConstVectorSpan& from, const ConstVectorSpan& to, const VectorSpan& axes, std::span<real> angles);
+    static void                 CalculateRotation(const ConstVectorSpan& from, const ConstVectorSpan& to, const QuaternionSpan& rotations);
+    static void                 ToEulerXZY(const ConstQuaternionSpan& q, const VectorSpan& angles);
+    static void                 FromEulerXZY(const ConstVectorSpan& angles, const QuaternionSpan& q);
+    static void                 ClampSwingTwist(const ConstQuaternionSpan& q, const ConstraintLimits& limits, const QuaternionSpan& clamped);
+};
+
+}
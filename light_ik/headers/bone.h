@@ -1,10 +1,12 @@
 #pragma once
 #include "types.h"
+#include "bone_storage.h"
 
 #include <vector>
 #include <string>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/quaternion.hpp"
@@ -12,59 +14,53 @@
 namespace LightIK
 {
 
-class SolverBase;
+struct SolverBase;
 
+/// @brief Thin view over the bone state kept inside the bone storage
 class Bone
 {
 public:
-    Bone();
-    Bone(real length, const Quaternion& orientation); 
+    Bone(BoneStorage& storage, size_t index);
     
     // Global orientation of the bone in the system coordinates assotiated with the root bone
     void SetGlobalOrientation(const Quaternion& orientation);
-    const Quaternion& GetGlobalOrientation() const  { return m_globalOrientation;   }
+    const Quaternion& GetGlobalOrientation() const  { return m_storage->globalOrientations[m_index]; }
 
     // Local orientation of the bone in the sustem assotiated with the parent bone
     void SetRotation(const Quaternion& rotation);
-    const Quaternion& GetRotation() const           { return m_rotation;            }
+    const Quaternion& GetRotation() const           { return m_storage->rotations[m_index];         }
 
     // Geometric data of the bone
-    const real GetLength() const                    { return m_length.l;            }
-    const real GetLength2() const                   { return m_length.l2;           }
+    const real GetLength() const                    { return m_storage->lengths[m_index].l;         }
+    const real GetLength2() const                   { return m_storage->lengths[m_index].l2;        }
 
     // Roatation constraints of the bone
     void SetConstraints(Constraints && newConstraints);
-    const Constraints& GetConstraints() const       { return m_constraints;         }
+    const Constraints& GetConstraints() const       { return m_storage->constraints[m_index];       }
 
     // Apply constraints on local rotation, to update it and prevent the bone to overcome its limitations
     Quaternion ApplyConstraint(const Quaternion& rotation) const;
 
     // Global position of the bone in the system associated with the root bone
-    void SetPosition(const Vector& position)        { m_position = position;        }
-    const Vector& GetPosition() const               { return m_position;            }
+    void SetPosition(const Vector& position)        { m_storage->positions[m_index] = position;     }
+    const Vector& GetPosition() const               { return m_storage->positions[m_index];         }
 
-    void SetOwner(SolverBase* owner)                { m_owner = owner;              }
-    SolverBase* GetOwner() const                    { return m_owner;               }
+    void SetOwner(SolverBase* owner)                { m_storage->owners[m_index] = owner;           }
+    SolverBase* GetOwner() const                    { return m_storage->owners[m_index];            }
+
+    // Location of the bone data inside the storage
+    BoneStorage& GetStorage() const                 { return *m_storage;                            }
+    size_t GetIndex() const                         { return m_index;                               }
 
     void Reset();   
 private:
-    Quaternion  m_globalOrientation;
-    Quaternion  m_rotation;
-    Quaternion  m_initialRotation;
-
-    Length      m_length;
-
-    Constraints m_constraints;
-
-    // position of the bone joint
-    Vector      m_position = Vector(0,0,0);
-
-    // index of the bone, if index is negative the bone does not exists
-    SolverBase* m_owner = nullptr;
+    BoneStorage*    m_storage;
+    // dense slot of the bone inside the storage
+    size_t          m_index;
 };
 
-using BonePtr       = std::unique_ptr<Bone>;
+using BonePtr       = Bone*;
 using BoneRef       = std::reference_wrapper<Bone>;
-using BoneSubchain  = std::vector<BoneRef>;
+using BoneSubchain  = std::pmr::vector<BoneRef>;
 
 }
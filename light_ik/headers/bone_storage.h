@@ -0,0 +1,127 @@
+#pragma once
+#include "types.h"
+
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace LightIK
+{
+
+struct SolverBase;
+
+/// @brief Constraints of the bone classified at assignment time, the limits are prepared for the evaluation
+///        on the quaternion, so applying the constraint needs no trigonometry except the Euler limits
+struct ConstraintLimits
+{
+    enum class Kind : uint8_t
+    {
+        free,           // limits cover all rotations, the constraint is skipped
+        euler,          // XZY Euler angles are clamped
+        swingTwist      // swing cone and twist range are clamped on the quaternion
+    };
+
+    Kind kind               = Kind::free;
+    // half angle cosine and sine of the swing cone
+    real cosHalfSwing       = -1;
+    real sinHalfSwing       = 0;
+    // sines of the half twist limits, the sine is monotonic on the whole range of the twist
+    real sinHalfTwistMin    = -1;
+    real sinHalfTwistMax    = 1;
+};
+
+/// @brief Parameters of the bones that are not changed by the updates, in the slot order of the storage.
+///        The instances of one rig share them, so only the pose is kept per instance
+struct BoneParameters
+{
+    // rest pose rotations, used to reset the skeleton
+    std::vector<Quaternion>         initialRotations;
+    std::vector<Length>             lengths;
+    std::vector<Constraints>        constraints;
+    // classified constraints, the same slot as constraints
+    std::vector<ConstraintLimits>   limits;
+};
+
+/// @brief Structure-of-arrays storage of the bones state. Each field of the bone lives in the separate
+///        contiguous array, all arrays are addressed by the same dense slot index. Slots are allocated
+///        in the order the bones are added to the skeleton, so the bones of one chain are packed together.
+struct BoneStorage
+{
+    /// @brief Reserves memory for the bones, storage never reallocates until the capacity is exceeded
+    /// @param capacity maximum number of bones
+    void Reserve(size_t capacity);
+
+    /// @brief Makes the storage an instance of the rig storage: the parameters of the bones are shared with the rig,
+    ///        the pose is copied from it
+    /// @param rig storage of the rig, its parameters are not changed while they are shared
+    /// @param capacity maximum number of bones, as for Reserve
+    void Instantiate(const BoneStorage& rig, size_t capacity);
+
+    /// @brief Adds new bone into the storage
+    /// @param length length of the bone
+    /// @param orientation initial local rotation of the bone
+    /// @return dense slot index of the created bone
+    size_t Add(real length, const Quaternion& orientation);
+
+    /// @brief Assigns constraints of the bone and classifies them
+    /// @param slot dense slot index of the bone
+    /// @param constraint rotation constraints of the bone
+    void SetConstraints(size_t slot, const Constraints& constraint);
+
+    /// @brief Apply constraints of the bone on its local rotation
+    /// @param slot dense slot index of the bone
+    /// @param rotation local rotation of the bone
+    /// @return rotation that does not overcome bone limitations
+    Quaternion ApplyConstraint(size_t slot, const Quaternion& rotation) const;
+
+    /// @brief Changes local rotation of the bone, the version of the bone is increased if rotation differs
+    /// @param slot dense slot index of the bone
+    /// @param rotation new local rotation
+    void SetRotation(size_t slot, const Quaternion& rotation)
+    {
+        if (rotations[slot] != rotation)
+        {
+            rotations[slot] = rotation;
+            ++versions[slot];
+        }
+    }
+
+    /// @brief Restores initial rotations of all stored bones
+    void ResetPose();
+
+    /// @brief Removes all bones from the storage, capacity is preserved
+    void Clear();
+
+    size_t Size() const                                     { return rotations.size(); }
+
+    // position of the bone joint in the system associated with the root bone
+    std::vector<Vector>         positions;
+    // local rotation of the bone in the system associated with the parent bone
+    std::vector<Quaternion>     rotations;
+    // number of local rotation changes, lets front kinematics skip the unchanged part of the chain
+    std::vector<uint32_t>       versions;
+    // global orientation of the bone in the system associated with the root bone
+    std::vector<Quaternion>     globalOrientations;
+    // views of the bone parameters, they may be shared with other storages
+    std::span<const Quaternion>         initialRotations;
+    std::span<const Length>             lengths;
+    std::span<const Constraints>        constraints;
+    std::span<const ConstraintLimits>   limits;
+    // solver that controls the bone, nullptr if bone is not a part of any IK chain
+    std::vector<SolverBase*>    owners;
+#ifdef LIGHT_IK_STATISTICS
+    // number of rotations limited by the constraints, collected and cleared by the chain statistics
+    mutable std::vector<uint32_t> clamps;
+#endif
+
+private:
+    // parameters for the change, the parameters shared with other storages are copied first
+    BoneParameters& GetParameters();
+    // points the views to the current parameters
+    void BindParameters();
+
+    std::shared_ptr<BoneParameters> m_parameters = std::make_shared<BoneParameters>();
+};
+
+}
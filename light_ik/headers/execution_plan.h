@@ -0,0 +1,108 @@
+#pragma once
+#include "types.h"
+#include "bone_storage.h"
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <cassert>
+
+namespace LightIK
+{
+
+/// @brief Flat program of the front kinematics of all chains of the skeleton. Bones of the chains are stored one
+///        chain after another in the creation order, which is the topological order of the chains: base bone of
+///        the chain is always calculated by an earlier chain. Each bone keeps the slot of its parent and its length,
+///        so the update walks the plain index arrays without touching the bone views
+struct ExecutionPlan
+{
+    // 32 bit indices are enough for any storage, they halve the index arrays on 64 bit platforms
+    using Index = uint32_t;
+
+    // Concrete type of the chain solver, chains of one kind are executed by one loop with the inlined solver calls
+    enum class SolverKind : uint8_t
+    {
+        passive,
+        binaryJoint,
+        twoBone,
+        fabrik,
+        // chain is solved by the effector group
+        group,
+    };
+
+    // Chains of one solver kind that follow each other in the execution order
+    struct Batch
+    {
+        SolverKind      kind    = SolverKind::passive;
+        // first element of the batch chains in the batchChains
+        Index           first   = 0;
+        // number of chains in the batch
+        Index           count   = 0;
+    };
+
+    // Part of the plan arrays that belongs to one chain
+    struct ChainRange
+    {
+        // first element of the chain bones in the plan arrays
+        Index           first   = 0;
+        // number of bones of the chain
+        Index           count   = 0;
+        // storage slot of the bone the chain is attached to
+        Index           base    = 0;
+    };
+
+    /// @brief Appends the bones of the chain to the plan
+    /// @param storage the storage the slots belong to
+    /// @param chainSlots storage slots of the chain bones from the root to the tip
+    /// @param base storage slot of the bone the chain is attached to
+    /// @return index of the chain range
+    template <typename Slots>
+    Index Append(const BoneStorage& storage, const Slots& chainSlots, size_t base)
+    {
+        assert(storage.Size() <= std::numeric_limits<Index>::max());
+        ChainRange& range   = ranges.emplace_back();
+        range.first         = static_cast<Index>(slots.size());
+        range.count         = static_cast<Index>(chainSlots.size());
+        range.base          = static_cast<Index>(base);
+
+        size_t parent       = base;
+        for (size_t slot : chainSlots)
+        {
+            slots.emplace_back(static_cast<Index>(slot));
+            parents.emplace_back(static_cast<Index>(parent));
+            lengths.emplace_back(storage.lengths[slot].l);
+            versions.emplace_back(0);
+            parent          = slot;
+        }
+        return static_cast<Index>(ranges.size() - 1);
+    }
+
+    void Clear()
+    {
+        slots.clear();
+        parents.clear();
+        lengths.clear();
+        versions.clear();
+        ranges.clear();
+        batchChains.clear();
+        batches.clear();
+    }
+
+    // Storage slots of the chain bones
+    std::vector<Index>      slots;
+    // Storage slots of the parent bones: previous bone of the chain or the base bone for the first one
+    std::vector<Index>      parents;
+    // Lengths of the chain bones, copied from the storage to be read sequentially
+    std::vector<real>       lengths;
+    // Rotation versions of the bones used by the last front kinematics
+    std::vector<uint32_t>   versions;
+    // Chains in the creation order
+    std::vector<ChainRange> ranges;
+    // Chain indices in the execution order: chains are sorted by the dependency level, the independent chains
+    //  of one level are grouped by the solver kind
+    std::vector<Index>      batchChains;
+    // Batches of the chains in the execution order
+    std::vector<Batch>      batches;
+};
+
+}
@@ -1,9 +1,12 @@
 #pragma once
 #include "types.h"
+#include "bone_storage.h"
+#include "math_policy.h"
 #include <glm/glm.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/quaternion.hpp"
 
+#include <span>
 #include <string>
 
 namespace LightIK
@@ -15,11 +18,20 @@ public:
     static Vector               Normal(const Vector& axis1, const Vector& axis2);
     static Quaternion           CalculateRotation(const Vector& from, const Vector& to);
     static RotationParameters   CalculateParameters(const Vector& from, const Vector& to);
+    /// @brief Angle of the triangle between the sides adjacent1 and adjacent2, half-angle form of the law of cosines,
+    ///        unlike acos it keeps the precision for the degenerate (folded or straight) triangles
+    static real                 TriangleAngle(real adjacent1, real adjacent2, real opposite);
     static Matrix               CalculateTransferMatrix(const CoordinateSystem& base, const CoordinateSystem& target);
     static Vector               ToLocal(const CoordinateSystem& localSystem, const Vector& vector);
     static constexpr Vector     DefaultAxis() {return {0,1,0}; }
     static Vector               ToEulerXZY(const Quaternion& q);
     static Quaternion           FromEulerXZY(const Vector& angles);
+    /// @brief Splits the rotation into the swing of the Y axis and the twist around it, clamps both by the limits.
+    ///        Only square roots are used, the rotation is returned as is if it is within the limits
+    static Quaternion           ClampSwingTwist(const Quaternion& q, const ConstraintLimits& limits);
+    /// @brief Verifies that every bone reaches the skeleton root by its parents, each bone is visited once
+    /// @param parents index of the parent bone indexed by the bone index, -1 for the bones attached to the root
+    static bool                 ValidateParents(std::span<const int> parents);
 
     static void                 Print(const std::string& prefix, const Vector& value);
     static void                 Print(const std::string& prefix, const Quaternion& value);
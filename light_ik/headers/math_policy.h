@@ -0,0 +1,139 @@
+#pragma once
+#include "types.h"
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace LightIK
+{
+
+/// @brief Transcendental functions of the standard library, exact to the last bits of the real type
+struct PreciseMath
+{
+    static real Atan(real x)                                { return std::atan(x); }
+    static real Atan2(real y, real x)                       { return std::atan2(y, x); }
+    static void SinCos(real angle, real& sine, real& cosine) { sine = std::sin(angle); cosine = std::cos(angle); }
+    static Quaternion AngleAxis(real angle, const Vector& axis) { return glm::angleAxis(angle, axis); }
+};
+
+/// @brief Inline polynomial approximations of the transcendental functions (Cephes), the argument is reduced by
+///        a couple of selects and no library call is made, so the compiler keeps the solver math in registers.
+///        The polynomials follow the precision of the real type, the absolute error against the standard library
+///        in the epsilons of the real type (verified by math_policy_test):
+///         - Atan and Atan2: 4 epsilon
+///         - SinCos: 2 epsilon for the angles up to 1e5 rad in double and 1e3 rad in float
+///        SinCos passes the NaN, infinite and the angles above 1e15 rad to the standard library.
+struct FastMath
+{
+    static real Atan(real x)
+    {
+        constexpr real TanThreePiOver8  = (real)2.41421356237309504880;
+        constexpr real TanPiOver8       = (real)0.4142135623730950;
+        constexpr bool single           = std::is_same_v<real, float>;
+
+        // atan(x) = pi/2 - atan(1/x) and atan(x) = pi/4 + atan((x-1)/(x+1)) reduce the argument
+        const real a        = std::abs(x);
+        const bool large    = a > TanThreePiOver8;
+        const bool medium   = !large && a > (single ? TanPiOver8 : (real)0.66);
+        const real t        = large ? (real)-1 / a : (medium ? (a - (real)1) / (a + (real)1) : a);
+        const real offset   = large ? glm::half_pi<real>() : (medium ? glm::quarter_pi<real>() : (real)0);
+        const real z        = t * t;
+        real result;
+        if constexpr (single)
+        {
+            result          = offset + ((((real)8.05374449538e-2 * z - (real)1.38776856032e-1) * z + (real)1.99777106478e-1) * z 
+                                - (real)3.33329491539e-1) * z * t + t;
+        }
+        else
+        {
+            const real p    = ((((z * (real)-8.750608600031904122785E-1 - (real)1.615753718733365076637E1) * z 
+                                - (real)7.500855792314704667340E1) * z - (real)1.228866684490136173410E2) * z 
+                                - (real)6.485021904942025371773E1);
+            const real q    = (((((z + (real)2.485846490142306297962E1) * z + (real)1.650270098316988542046E2) * z 
+                                + (real)4.328810604912902668951E2) * z + (real)4.853903996359136964868E2) * z 
+                                + (real)1.945506571482613964425E2);
+            result          = offset + (t * z * p / q + t);
+        }
+        return x < 0 ? -result : result;
+    }
+
+    static real Atan2(real y, real x)
+    {
+        // the sign of zero selects the half plane the same way as std::atan2 does
+        const bool negative = std::signbit(y);
+        if (x == 0)
+        {
+            return y == 0 ? y : (negative ? -glm::half_pi<real>() : glm::half_pi<real>());
+        }
+        const real result   = Atan(y / x);
+        if (x > 0)
+        {
+            return result;
+        }
+        return negative ? result - glm::pi<real>() : result + glm::pi<real>();
+    }
+
+    static void SinCos(real angle, real& sine, real& cosine)
+    {
+        // pi/2 split into three parts, each part has enough trailing zero bits to be multiplied by the quadrant exactly
+        constexpr bool single       = std::is_same_v<real, float>;
+        constexpr real PiOver2A     = single ? (real)1.5703125                  : (real)1.57079625129699707031;
+        constexpr real PiOver2B     = single ? (real)4.837512969970703125e-4    : (real)7.54978941586159635336e-8;
+        constexpr real PiOver2C     = single ? (real)7.54978995489188216e-8     : (real)5.39030285815811905290e-15;
+        constexpr real TwoOverPi    = (real)0.63661977236758134308;
+        constexpr real MaxAngle     = (real)1e15;
+
+        // the quadrant of the huge or non finite angle does not fit the integer, the comparison is false for NaN
+        if (!(std::abs(angle) < MaxAngle))
+        {
+            PreciseMath::SinCos(angle, sine, cosine);
+            return;
+        }
+        const real quadrant = std::floor(angle * TwoOverPi + (real)0.5);
+        const real r        = ((angle - quadrant * PiOver2A) - quadrant * PiOver2B) - quadrant * PiOver2C;
+        const real r2       = r * r;
+        real s, c;
+        if constexpr (single)
+        {
+            s               = r + r * r2 * (((real)-1.9515295891e-4 * r2 + (real)8.3321608736e-3) * r2 - (real)1.6666654611e-1);
+            c               = (real)1 - r2 * (real)0.5 + r2 * r2 * (((real)2.443315711809948e-5 * r2 - (real)1.388731625493765e-3) * r2 
+                                + (real)4.166664568298827e-2);
+        }
+        else
+        {
+            s               = r + r * r2 * ((((((r2 * (real)1.58962301576546568060E-10 - (real)2.50507477628578072866E-8) * r2 
+                                + (real)2.75573136213857245213E-6) * r2 - (real)1.98412698295895385996E-4) * r2 
+                                + (real)8.33333333332211858878E-3) * r2 - (real)1.66666666666666307295E-1));
+            c               = (real)1 - r2 * (real)0.5 + r2 * r2 * ((((((r2 * (real)-1.13585365213876817300E-11 
+                                + (real)2.08757008419747316778E-9) * r2 - (real)2.75573141792967388112E-7) * r2 
+                                + (real)2.48015872888517045348E-5) * r2 - (real)1.38888888888730564116E-3) * r2 
+                                + (real)4.16666666666665929218E-2));
+        }
+
+        // odd quadrants swap sine and cosine, the signs follow the quadrant bits. Selects instead of the switch
+        //  let the compiler use blends, the quadrants of the solver angles are not predictable
+        const int64_t index = static_cast<int64_t>(quadrant);
+        const bool swap     = index & 1;
+        sine                = swap ? c : s;
+        cosine              = swap ? s : c;
+        sine                = (index & 2) ? -sine : sine;
+        cosine              = ((index + 1) & 2) ? -cosine : cosine;
+    }
+
+    static Quaternion AngleAxis(real angle, const Vector& axis)
+    {
+        real sine, cosine;
+        SinCos(angle * (real)0.5, sine, cosine);
+        return Quaternion{cosine, axis.x * sine, axis.y * sine, axis.z * sine};
+    }
+};
+
+// Math policy of the scalar solvers is chosen at build time, LIGHT_IK_FAST_MATH option swaps in the approximations
+#ifdef LIGHT_IK_FAST_MATH
+using Math = FastMath;
+#else
+using Math = PreciseMath;
+#endif
+
+}
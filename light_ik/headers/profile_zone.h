@@ -0,0 +1,52 @@
+#pragma once
+#include "types.h"
+#include "light_ik/profiler.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace LightIK
+{
+
+namespace Profiling
+{
+    // Profiler attached by SetProfiler, nullptr if profiling is disabled
+    extern std::atomic<Profiler*> activeProfiler;
+}
+
+/// @brief Reports the scope to the attached profiler. Without the profiler the zone costs one atomic load,
+///        the zone is empty if the hooks are compiled out (LIGHT_IK_PROFILER option)
+class ProfileZone
+{
+public:
+#ifdef LIGHT_IK_PROFILER
+    explicit ProfileZone(ProfileScope scope, uint32_t id = 0)
+        : m_profiler(Profiling::activeProfiler.load(std::memory_order_acquire))
+        , m_scope(scope)
+    {
+        if (m_profiler)
+        {
+            m_profiler->BeginScope(scope, id);
+        }
+    }
+
+    ~ProfileZone()
+    {
+        if (m_profiler)
+        {
+            m_profiler->EndScope(m_scope);
+        }
+    }
+
+private:
+    Profiler*       m_profiler;
+    ProfileScope    m_scope;
+#else
+    explicit ProfileZone(ProfileScope, uint32_t = 0) {}
+#endif
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+}
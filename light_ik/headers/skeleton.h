@@ -3,15 +3,23 @@
 #include "bone.h"
 #include "target.h"
 #include "solver_base.h"
+#include "solver_dls.h"
+#include "arena.h"
+#include "execution_plan.h"
+#include "statistics.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/quaternion.hpp"
 
 #include <vector>
+#include <atomic>
+#include <span>
 
 namespace LightIK
 {
 
+class ThreadPool;
+
 class Skeleton
 {
 public:
@@ -19,21 +27,46 @@ public:
     /// @param bonesCount total number of bones in the skeleton
     Skeleton(size_t bonesCount);
 
+    /// @brief Selects the constructor of the rig instance
+    struct InstanceTag {};
+
+    /// @brief Constructs the instance of the rig skeleton: bones share the parameters with the rig and start from
+    ///        its current pose, the chains are added by InstantiateChains
+    /// @param rig finalized skeleton of the rig without effector groups, it is not changed while the instances exist
+    Skeleton(InstanceTag, const Skeleton& rig);
+
+    // the chains are not copied with the storage, the instance is created only by InstantiateChains
+    Skeleton(const Skeleton&) = delete;
+    Skeleton& operator=(const Skeleton&) = delete;
+
+    /// @brief Creates the chains of the rig with the same solvers and convergence criteria, the chains start from
+    ///        the state of the rig chains, so the front kinematics is not calculated
+    /// @param rig the skeleton the instance was constructed from
+    /// @param targets targets of the chains indexed by the chain index, nullptr for the passive chains
+    void InstantiateChains(const Skeleton& rig, std::span<Target* const> targets);
+
     /// @brief Create solver for the bone chain.
     /// @param rootChain The root chain is the list of bones from the current chain tip to the skeleton root bone.
     /// @param startBoneIndex Index of the bone from which the IK chain starts
     /// @param target The target model for the chain, it can be either coordinates or bone inside the skeleton
+    /// @param solverType Algorithm that solves the chain
     /// @return reference to the created IK solver
-    SolverBase& AddSolver(const std::vector<BoneDesc>& rootChain, size_t startBoneIndex, Target& target);
+    SolverBase& AddSolver(const std::vector<BoneDesc>& rootChain, size_t startBoneIndex, Target& target, 
+        SolverType solverType = SolverType::automatic);
 
     /// @brief Adds specific bone chain for monitoring, bones of the chain can be used as internal targets for other skeleton chains.
     /// @param rootChain The root chain is the list of bones from the current chain tip to the skeleton root bone.
     /// @return pointer to the created dummy IK solver, or nullptr if chain was not created
     SolverBase* AddChain(const std::vector<BoneDesc>& rootChain);
 
-    /// @brief Removes IK chain
+    /// @brief Removes IK chain, the chain is dropped from the execution plan by the next Finalize
     /// @param solver the solver assotiated with IK chain that will be removed
     void RemoveSolver(const SolverRef& solver);
+
+    /// @brief Compacts the chains into the flat execution plan after the chains were removed and groups the independent
+    ///        chains into the batches by the solver type. The update finalizes the changed structure by itself, the call
+    ///        lets the application move the allocations out of the first update
+    void Finalize();
     
     /// @brief Assigns constraint to a particular bone of the skeleton
     /// @param boneIndex index of the bone that will have constraints assigned
@@ -45,12 +78,69 @@ public:
     /// @return number of IK chains
     size_t GetSolversCount() const                                  { return m_chains.size();      }
 
+    /// @brief Returns the solver of the chain
+    /// @param chainIndex index of the chain in the creation order
+    const SolverBase& GetSolver(size_t chainIndex) const            { return *m_chains[chainIndex]->solver; }
+    SolverBase& GetSolver(size_t chainIndex)                        { return *m_chains[chainIndex]->solver; }
+
     /// @brief Executes all IK mechanics for all chains to reach assotiated target positions
-    ///        execution priority equals to the order of chains in the cahin list
+    ///        execution priority equals to the order of chains in the cahin list, independent chains are
+    ///        executed in batches of one solver type
     /// @param iterations maximum number of iterrations required to move chains to final position (unused)
     /// @return maximum number of iterrations required to complete chain
     size_t Update(size_t iterations);
 
+    /// @brief Returns the reason the chain finished its iterations on the last update
+    /// @param solver solver the chain is assotiated with
+    /// @return the stop reason, StopReason::none if chain was not updated yet
+    StopReason GetStopReason(const SolverBase& solver) const;
+
+    /// @brief Sets the point the middle joint of the chain bends towards, the sleeping chain is woken up
+    /// @param solver solver the chain is assotiated with
+    /// @param pole position of the pole, nullopt to keep the current bending plane
+    /// @return false if the solver of the chain does not support the pole
+    bool SetPole(SolverBase& solver, const std::optional<Vector>& pole);
+
+    /// @brief Solves the chains together by the damped least squares solver, tips of the IK chains are the effectors
+    ///        of one linear system, so the chains do not fight for the shared bones. Bones of the passive chains are
+    ///        moved by the group as well. After the sorting by the creation order the first chain must be the ancestor
+    ///        of the others: they start from the skeleton root or are attached to its bones directly or through the
+    ///        other chains of the group. Members may share the bones, the shared bone is rotated once for all of them.
+    /// @param solvers solvers of the chains, at least two chains with 1 up to SolverDls::MaxEffectors IK chains
+    /// @param damping damping factor of the solver
+    /// @return false if the chains can not form the group
+    bool AddEffectorGroup(const std::vector<SolverRef>& solvers, real damping);
+
+    /// @brief Assigns the thread pool to solve independent chains in parallel. Chains are ordered by the dependency
+    ///        graph, so the result is the same as for sequential execution in the order of the chains creation.
+    /// @param pool the pool to execute chains, nullptr to solve chains on the calling thread
+    void SetThreadPool(ThreadPool* pool)                            { m_threadPool = pool;          }
+
+    /// @brief Forces the dependency graph of the chains to be rebuilt on the next update
+    void InvalidateSchedule()                                       { m_scheduleDirty = true;       }
+
+    /// @brief Enables collection of the chain statistics, the statistics are reset. Without LIGHT_IK_STATISTICS
+    ///        option the statistics are compiled out and the call does nothing
+    /// @param enable true to measure the chains on every update
+    void EnableStatistics(bool enable);
+
+    /// @brief Clears the measurements of all chains and the aggregated histograms
+    void ResetStatistics();
+
+    /// @brief Returns the measurements of the chain
+    /// @param solver solver the chain is assotiated with
+    /// @return the statistics of the last update and the totals since the reset
+    const ChainStatistics& GetStatistics(const SolverBase& solver) const;
+
+    /// @brief Returns the measurements of all chains aggregated since the reset
+    const Statistics& GetStatistics() const                         { return m_statistics;          }
+
+    /// @brief Verifies whether one chain has to be solved after another one
+    /// @param chain the chain to verify
+    /// @param dependency the chain that may have to be solved before
+    /// @return true if chain directly depends on the dependency chain
+    bool DependsOn(const SolverBase& chain, const SolverBase& dependency);
+
     // --------------------------------------------------------------------------------------------------
     // Validation functions should not be used directly inside application
     // --------------------------------------------------------------------------------------------------
@@ -62,7 +152,12 @@ public:
     ///        the tip of current chain
     /// @param solver solver the chain is assotiated with
     /// @return vector of bones that represents the root chain
-    const std::vector<BoneRef>& GetRootChain(const SolverBase& solver) const;
+    const BoneSubchain& GetRootChain(const SolverBase& solver) const;
+
+    /// @brief Returns the storage slot of the bone the root chain is attached to
+    /// @param solver solver the chain is assotiated with
+    /// @return storage slot of the base bone, the skeleton root slot if chain starts from the skeleton root
+    size_t GetBaseBone(const SolverBase& solver) const;
 
     /// @brief updates then chain joint positions according to local rotation of all IK bones from
     ///         root bone till the tip bone of the current chain
@@ -72,38 +167,178 @@ public:
     /// void CompleteChain(Solver& solver);
 
     /// @brief Returns the full list of bones envolved into IK mechanics
-    /// @return the full list of bones
+    /// @return the full list of bones indexed by the bone index, nullptr if bone is not registered
     const std::vector<BonePtr>& GetBones() const                    { return m_bones;               }
 
-    /// @brief Resets skeleton structure, drops all IK chains and solvers
+    /// @brief Returns the contiguous storage with the state of all registered bones
+    /// @return bone storage
+    const BoneStorage& GetStorage() const                           { return m_storage;             }
+
+    /// @brief Returns the memory arena of the skeleton, objects placed into the arena must be destroyed
+    ///        before the skeleton structure is reset
+    /// @return the arena that is released by ResetIK
+    Arena& GetArena()                                               { return m_arena;               }
+
+    /// @brief Resets skeleton structure, drops all IK chains and solvers, memory of the structure 
+    ///        is released at once
     void ResetIK();
 
     /// @brief Resets sceleton position to original pose
     void ResetPose();
 
 private:
+    struct EffectorGroup;
+
     // Descriptor for root chain
     struct RootChain
     {
+        RootChain(std::pmr::memory_resource* arena, size_t base)
+            : chain(arena)
+            , baseBone(base)
+        {
+        }
+
         // The element list of the root chain
-        BoneSubchain    chain;
-        // The parent  bone of the chain
-        BoneRef         baseBone;
-        // Solver that controls the chain
-        SolverPtr       solver;
+        BoneSubchain        chain;
+        // Storage slot of the parent bone of the chain
+        size_t              baseBone;
+        // Part of the execution plan with the storage slots of the root chain elements
+        ExecutionPlan::Index range = 0;
+        // Solver that controls the chain and its concrete type
+        SolverPtr           solver;
+        ExecutionPlan::SolverKind kind = ExecutionPlan::SolverKind::passive;
+        // Transform of the base bone used by the last front kinematics
+        Quaternion          baseOrientation;
+        Vector              basePosition;
+        // Tip position calculated by the last front kinematics
+        Vector              tip;
+        bool                calculated = false;
+        // The reason the chain finished the last update
+        StopReason          stopReason = StopReason::none;
+        // The chain converged, it is skipped until the target or the base bone moves
+        bool                sleeping = false;
+        // Target position the chain converged against
+        Vector              sleepTarget;
+        // The group that solves the chain together with other chains
+        EffectorGroup*      group = nullptr;
+        // Measurements of the chain, collected only if the statistics are enabled
+        ChainStatistics     statistics;
+    };
+    using RootChainPtr = ArenaPtr<RootChain>;
+
+    // Chains solved together by one multi-effector solver
+    struct EffectorGroup
+    {
+        EffectorGroup(std::pmr::memory_resource* arena, BoneStorage& storage)
+            : chains(arena)
+            , solver(storage, arena)
+        {
+        }
+
+        // Member chains in the creation order, the first one is the ancestor of the others and solves the group
+        ArenaVector<RootChain*> chains;
+        SolverDls           solver;
+    };
+
+    // Node of the chains dependency graph
+    struct ChainNode
+    {
+        // Chains that can be solved only after the current one
+        std::vector<size_t> successors;
+        // Number of chains that have to be solved before the current one
+        size_t              dependencies = 0;
     };
-    using RootChainPtr = std::unique_ptr<RootChain>;
 
     // Find the chain index assotiated with a given solver
     size_t FindChainIndex(const SolverBase& solver) const;
+    // Storage slots of the root chain elements
+    std::span<const ExecutionPlan::Index> GetSlots(const RootChain& chain) const;
     // Add bone to the skeleton structure. 
     std::pair<bool, BoneRef> AddBone(const BoneDesc& description);
-    // calculate positions for all bones in the current chain
+    // Create the solver of the instance chain over the same bones as the rig solver
+    template <typename ConcreteSolver>
+    SolverPtr InstantiateSolver(const SolverBase& rigSolver, std::span<const ExecutionPlan::Index> parents, Target& target);
+    // Add the bones of the root chain into the skeleton starting from the given descriptor
+    void AddRootChainBones(RootChain& chain, const std::vector<BoneDesc>& rootChain, size_t first);
+    // calculate positions for the bones of the current chain, starting from the first bone whose rotation
+    //  was changed since the last calculation. Whole chain is calculated if the base bone was moved.
     Vector CalculateBonePositions(RootChain& chain);
+    // calculate positions for the bones of the current chain, the time is added to the statistics of the chain
+    Vector CalculateBonePositions(RootChain& chain, ChainStatistics* statistics);
+    // solve single chain by the solver of its kind, returns number of performed iterations
+    size_t UpdateChain(RootChain& chain, size_t iterations);
+    // solve single chain by the solver of the known type, the solver calls are resolved at compile time
+    template <typename ConcreteSolver>
+    size_t UpdateChain(RootChain& chain, ConcreteSolver& solver, size_t iterations);
+    template <typename ConcreteSolver>
+    size_t SolveChain(RootChain& chain, ConcreteSolver& solver, size_t iterations, ChainStatistics* statistics);
+    // solve the chain that is a member of the group, the first member solves the whole group
+    size_t UpdateChain(RootChain& chain, EffectorGroup& group, size_t iterations);
+    // solve the chains of one batch, returns minimal number of performed iterations
+    size_t ExecuteBatch(const ExecutionPlan::Batch& batch, size_t iterations);
+    template <typename ConcreteSolver>
+    size_t ExecuteBatch(std::span<const ExecutionPlan::Index> chains, size_t iterations);
+    // solve all chains of the group together, returns number of performed iterations
+    size_t UpdateGroup(EffectorGroup& group, size_t iterations, ChainStatistics* statistics);
+    // statistics of the chain for the current update, nullptr if the statistics are disabled
+    ChainStatistics* StartStatistics(RootChain& chain);
+    // complete the statistics of the chain update: iterations, tip error and clamps of the chain bones
+    void RecordStatistics(RootChain& chain, size_t iterations, const Vector& tip, const Vector& target);
+    // add the statistics of the chains updated by the last update to the histograms
+    void AggregateStatistics();
+    // verifies that the converged chain can skip the update: the bones of the chain were not rotated outside 
+    //  of the solver, the target and the tip moved by the base bone are closer than threshold to the converged state
+    bool IsSleeping(const RootChain& chain, real threshold, const Vector& target) const;
+    // finish iterations of the converged chain, it sleeps until its inputs change
+    void StopChain(RootChain& chain, StopReason reason, const Vector& target);
+    // drop the removed chains from the chains list and the execution plan
+    void CompactPlan();
+    // solve chains in the thread pool following the dependency graph
+    size_t UpdateParallel(size_t iterations);
+    // build dependency graph of the chains: chain depends on the earlier chains that calculate its bones, 
+    //  its base bone and its target bone, or on the earlier chains that read its bones
+    void BuildSchedule();
+    // order the chains by the dependency levels and group the chains of one level by the solver kind
+    void BuildBatches();
+    // solve the chain as a task of the thread pool and submit the chains that wait for it
+    void SolveScheduled(size_t chain);
+
+    // Memory of chains, solvers and their bone lists, it must outlive all of them
+    Arena                   m_arena;
     // All full chains from root items to tip of the current chain
     std::vector<RootChainPtr> m_chains;
+    // Groups of the chains solved together
+    std::vector<ArenaPtr<EffectorGroup>> m_groups;
+    // State of all bones in structure-of-arrays layout, slot 0 is reserved for the skeleton root
+    BoneStorage             m_storage;
+    // Views for every storage slot
+    std::vector<Bone>       m_views;
     // Full list of bones assigned to IK chains and their root elements
     std::vector<BonePtr>    m_bones;
+    // Flat front kinematics of the chains, ranges follow the order of m_chains
+    ExecutionPlan           m_plan;
+    // Removed chains are still in the plan and in the chains list
+    bool                    m_planDirty     = false;
+
+    // Dependency graph of the chains, indexed by the chain index
+    std::vector<ChainNode>  m_schedule;
+    bool                    m_scheduleDirty = true;
+    ThreadPool*             m_threadPool    = nullptr;
+
+    // Aggregated measurements of the chains
+    Statistics              m_statistics;
+    bool                    m_statisticsEnabled = false;
+
+    // State of the parallel update, kept between updates to avoid allocations
+    // number of unsolved dependencies of each chain
+    std::unique_ptr<std::atomic<size_t>[]> m_pending;
+    // number of chains that are not solved yet
+    std::atomic<size_t>     m_remaining     = 0;
+    // minimal number of iterations performed by chains
+    std::atomic<size_t>     m_steps         = 0;
+    size_t                  m_iterations    = 0;
+
+    static constexpr size_t m_rootSlot = 0;
 };
 
 
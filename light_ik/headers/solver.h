@@ -14,8 +14,6 @@ namespace LightIK
 // Solver class
 class Solver final : public SolverBase
 {
-    const size_t m_defaultPose = 0;
-    const Bone   m_defaultBone{};
 public:
     Solver(BoneSubchain&& chain, const Bone& parentBone, Target& target);
     virtual ~Solver() = default;
@@ -27,26 +25,33 @@ public:
     void   SetTipPosition(Vector& position) override;
     Vector GetTipPosition() const;
 
-    const Vector& GetTargetPosition() const override        { return m_target.GetPosition(); }
+    const Vector& GetTargetPosition() const override        { return m_target.GetSolverPosition(); }
+    const Target* GetTarget() const override                { return &m_target; }
 
     Vector GetRootPosition() const;
 
     void   SetDependencies(bool hasDependencies) override   { m_hasDependencies = hasDependencies;}
     bool   HasDependencies() const override                 { return m_hasDependencies;}
 
+    void   SetConvergence(const Convergence& convergence) override { m_convergence = convergence; }
+    const Convergence& GetConvergence() const override      { return m_convergence; }
+
     bool   TargetReached() const override;
     void   Execute() override;
     
 private:
     void                    LookAt(const Vector& initialDirection, const Vector& target);
-    Vector                  SolveBinaryJoint(Bone& bone, const Bone& parent, const Vector& root, const Vector& tip, const Vector& target);
+    Vector                  SolveBinaryJoint(size_t bone, size_t parent, const Vector& root, const Vector& tip, const Vector& target);
     std::pair<real, real>   CalculateAngles(const Length& root, const Length& tip, Vector2 chord) const;
     
-    const Bone&             m_parentBone;
+    BoneStorage&            m_storage;
+    size_t                  m_parentBone;
     BoneSubchain            m_chain;   // bones chain
+    ArenaVector<size_t>     m_slots;   // storage slots of the chain bones
     Vector                  m_tipPosition {0.f, 0.f, 0.f};
     Target&                 m_target;
     Quaternion              m_cumulativeRotation;
+    Convergence             m_convergence;
     bool                    m_hasDependencies = false;
 };
 
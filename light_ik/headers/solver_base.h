@@ -1,6 +1,9 @@
 #pragma once
 #include "types.h"
 #include "bone.h"
+#include "target.h"
+
+#include <optional>
 
 namespace LightIK
 {
@@ -18,17 +21,27 @@ struct SolverBase
     virtual Vector GetTipPosition() const = 0;
     virtual Vector GetRootPosition() const = 0;
     virtual const Vector& GetTargetPosition() const = 0;
+    virtual const Target* GetTarget() const = 0;
     
     virtual void   SetDependencies(bool hasDependencies) = 0;
     virtual bool   HasDependencies() const = 0;
 
+    virtual void   SetConvergence(const Convergence& convergence) = 0;
+    virtual const Convergence& GetConvergence() const = 0;
+
+    // closed form solver finds the final pose in one pass, skeleton does not iterate it
+    virtual bool   IsClosedForm() const                     { return false; }
+    // point the middle joints of the chain bend towards, nullopt restores the default bending
+    // returns false if the solver does not support the pole vector
+    virtual bool   SetPole(const std::optional<Vector>&)    { return false; }
+
     virtual bool   TargetReached() const = 0;
     virtual void   Execute() = 0;
 
     virtual size_t GetChainSize() const = 0;
 };
 
-using SolverPtr = std::unique_ptr<SolverBase>;
+using SolverPtr = ArenaPtr<SolverBase>;
 using SolverRef = std::reference_wrapper<SolverBase>;
 
 }
@@ -0,0 +1,61 @@
+#pragma once
+#include "types.h"
+#include "bone_storage.h"
+#include "batch_math.h"
+
+#include <vector>
+
+namespace LightIK
+{
+
+/// @brief Pose of one block of skeleton instances, each element holds the bone state for all lanes of the block
+///        and is addressed by the storage slot of the bone
+struct PoseBlock
+{
+    PackVector*         positions;
+    PackQuaternion*     rotations;
+    PackQuaternion*     globalOrientations;
+};
+
+/// @brief Binary joint solver that processes one chain for the block of skeleton instances in lockstep.
+///        Mirrors the Solver algorithm, per-instance control flow is replaced by the lane masks.
+class SolverBatch
+{
+public:
+    /// @brief Constructs the batch solver
+    /// @param rig storage with the bone parameters shared by all instances: lengths and constraints
+    /// @param rootChain storage slots of the root chain bones
+    /// @param baseBone storage slot of the bone the root chain is attached to
+    /// @param chainSize number of the last root chain bones that form the IK chain, 0 for passive chains
+    SolverBatch(const BoneStorage& rig, std::vector<size_t>&& rootChain, size_t baseBone, size_t chainSize);
+
+    bool        IsPassive() const                           { return m_slots.empty(); }
+    /// @brief Two bone chains are solved in one pass, as the skeleton does for the SolverTwoBone chains
+    bool        IsClosedForm() const                        { return m_slots.size() == 2; }
+    
+    /// @brief Front kinematics for the root chain of all block instances
+    /// @return position of the chain tip
+    PackVector  CalculateBonePositions(PoseBlock& pose) const;
+
+    PackMask    TargetReached(const PackVector& tip, const PackVector& target) const;
+
+    /// @brief Performs one IK iteration for the active instances of the block
+    void        Execute(PoseBlock& pose, const PackVector& tip, const PackVector& target, const PackMask& active) const;
+
+private:
+    // closed form solution of the two bone chain, mirrors SolverTwoBone without the pole
+    void            ExecuteTwoBone(PoseBlock& pose, const PackVector& targetPosition, const PackMask& active) const;
+    PackVector      SolveBinaryJoint(PoseBlock& pose, size_t bone, size_t parent, const PackVector& root, const PackVector& tip, 
+                        const PackVector& target, PackQuaternion& cumulativeRotation, const PackMask& active) const;
+    void            CalculateAngles(const Pack& rootLength, const Pack& tipLength, Pack chordX, const Pack& chordY,
+                        Pack& angleRoot, Pack& angleJoint) const;
+    PackQuaternion  ApplyConstraint(size_t slot, const PackQuaternion& rotation) const;
+
+    const BoneStorage&      m_rig;
+    std::vector<size_t>     m_rootChain;    // storage slots of the root chain
+    size_t                  m_baseBone;
+    std::vector<size_t>     m_slots;        // storage slots of the IK chain
+    size_t                  m_parentBone;
+};
+
+}
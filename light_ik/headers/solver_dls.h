@@ -0,0 +1,61 @@
+#pragma once
+#include "types.h"
+#include "bone_storage.h"
+#include "solver_base.h"
+#include "arena.h"
+
+#include <cstdint>
+
+namespace LightIK
+{
+
+/// @brief Damped least squares solver of several end effectors that share the bones. Every iteration builds the
+///        linear system of all effectors at once, so the chains do not fight for the shared bones.
+///        Each bone rotates around its joint by 3 degrees of freedom, the bone flexibility weights its joint.
+///        The system size is 3 x number of effectors and it lives on the stack, the Jacobian is never stored.
+class SolverDls
+{
+public:
+    static constexpr size_t MaxEffectors    = 8;
+    static constexpr real   DefaultDamping  = (real)0.5;
+
+    /// @brief Constructs the solver
+    /// @param storage storage of the skeleton bones
+    /// @param arena memory of the bone and effector lists
+    SolverDls(BoneStorage& storage, std::pmr::memory_resource* arena);
+
+    /// @brief Adds the effector, the chain tip that follows its target
+    /// @param effector solver of the chain, its tip and target positions are used
+    /// @return index of the effector
+    size_t AddEffector(const SolverBase& effector);
+
+    /// @brief Adds the bone rotated by the solver
+    /// @param slot storage slot of the bone
+    /// @param parent storage slot of the parent bone
+    /// @param effectors bit mask of the effectors moved by the bone
+    void AddBone(size_t slot, size_t parent, uint32_t effectors);
+
+    size_t GetEffectorsCount() const                        { return m_effectors.size(); }
+
+    /// @brief Sets the damping factor, bigger values make the steps smaller and stable near the singular poses
+    void SetDamping(real damping)                           { m_damping = damping; }
+    real GetDamping() const                                 { return m_damping; }
+
+    /// @brief Performs one iteration for all effectors, tips of the effectors must be up to date
+    void Execute();
+
+private:
+    struct Joint
+    {
+        size_t      slot;
+        size_t      parent;
+        uint32_t    effectors;
+    };
+
+    BoneStorage&                    m_storage;
+    ArenaVector<Joint>              m_joints;
+    ArenaVector<const SolverBase*>  m_effectors;
+    real                            m_damping = DefaultDamping;
+};
+
+}
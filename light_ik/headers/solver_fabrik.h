@@ -0,0 +1,57 @@
+#pragma once
+#include "types.h"
+#include "target.h"
+#include "bone.h"
+#include "solver_base.h"
+#include "arena.h"
+
+namespace LightIK
+{
+
+/// @brief FABRIK solver: every iteration moves the joint positions from the tip to the root (backward reaching) and
+///        back from the root (forward reaching) keeping the bone lengths, then extracts the bone rotations
+///        from the new positions. Flexibility and constraints of each bone are applied during the extraction.
+class SolverFabrik final : public SolverBase
+{
+public:
+    SolverFabrik(BoneSubchain&& chain, const Bone& parentBone, Target& target);
+    virtual ~SolverFabrik() = default;
+
+    const BoneSubchain& GetChain() const                    { return m_chain; }
+
+    size_t GetChainSize() const override                    { return m_chain.size(); }
+
+    void   SetTipPosition(Vector& position) override        { m_tipPosition = position; }
+    Vector GetTipPosition() const override                  { return m_tipPosition; }
+
+    const Vector& GetTargetPosition() const override        { return m_target.GetSolverPosition(); }
+    const Target* GetTarget() const override                { return &m_target; }
+
+    Vector GetRootPosition() const override;
+
+    void   SetDependencies(bool hasDependencies) override   { m_hasDependencies = hasDependencies; }
+    bool   HasDependencies() const override                 { return m_hasDependencies; }
+
+    void   SetConvergence(const Convergence& convergence) override { m_convergence = convergence; }
+    const Convergence& GetConvergence() const override      { return m_convergence; }
+
+    bool   TargetReached() const override;
+    void   Execute() override;
+
+private:
+    // moves the joint towards the anchor joint to the distance of the bone length
+    static Vector           Reach(const Vector& anchor, const Vector& joint, real length);
+
+    BoneStorage&            m_storage;
+    size_t                  m_parentBone;
+    BoneSubchain            m_chain;
+    ArenaVector<size_t>     m_slots;
+    // joint positions of the current iteration, the last one is the chain tip
+    ArenaVector<Vector>     m_joints;
+    Vector                  m_tipPosition {0, 0, 0};
+    Target&                 m_target;
+    Convergence             m_convergence;
+    bool                    m_hasDependencies = false;
+};
+
+}
@@ -9,9 +9,7 @@ namespace LightIK
 // Solver class
 class SolverPassive final : public SolverBase
 {
-    const size_t m_defaultPose = 0;
     const Vector m_zero{0,0,0};
-    const Bone   m_defaultBone{};
 public:
     SolverPassive() = default;
     virtual ~SolverPassive() = default;
@@ -23,17 +21,22 @@ public:
     void   SetTipPosition(Vector& position) override        { }
     Vector GetTipPosition() const override                  { return Vector(0, 0, 0); }
     const Vector& GetTargetPosition() const override        { return m_zero; }
+    const Target* GetTarget() const override                { return nullptr; }
 
     Vector GetRootPosition() const override                 { return Vector(0, 0, 0); }
 
     void   SetDependencies(bool hasDependencies) override   { }
     bool   HasDependencies() const override                 { return false;}
 
+    void   SetConvergence(const Convergence&) override      { }
+    const Convergence& GetConvergence() const override      { return m_convergence; }
+
     bool   TargetReached() const override                   { return true; }
     void   Execute() override                               { }
     
 private:
     BoneSubchain            m_chain;
+    Convergence             m_convergence;
 };
 
 }
@@ -0,0 +1,63 @@
+#pragma once
+#include "types.h"
+#include "target.h"
+#include "bone.h"
+#include "solver_base.h"
+
+#include <optional>
+
+namespace LightIK
+{
+
+/// @brief Closed form solver of the chain with two bones (arms, legs). The middle joint bends in the plane
+///        that contains the target and either the pole point or the current middle joint. Solution is found
+///        in one pass, constraints of the bones are applied to the result.
+class SolverTwoBone final : public SolverBase
+{
+public:
+    SolverTwoBone(BoneSubchain&& chain, const Bone& parentBone, Target& target);
+    virtual ~SolverTwoBone() = default;
+
+    const BoneSubchain& GetChain() const                    { return m_chain; }
+
+    size_t GetChainSize() const override                    { return m_chain.size(); }
+
+    void   SetTipPosition(Vector& position) override        { m_tipPosition = position; }
+    Vector GetTipPosition() const override                  { return m_tipPosition; }
+
+    const Vector& GetTargetPosition() const override        { return m_target.GetSolverPosition(); }
+    const Target* GetTarget() const override                { return &m_target; }
+
+    Vector GetRootPosition() const override;
+
+    void   SetDependencies(bool hasDependencies) override   { m_hasDependencies = hasDependencies; }
+    bool   HasDependencies() const override                 { return m_hasDependencies; }
+
+    void   SetConvergence(const Convergence& convergence) override { m_convergence = convergence; }
+    const Convergence& GetConvergence() const override      { return m_convergence; }
+
+    bool   SetPole(const std::optional<Vector>& pole) override { m_pole = pole; m_poleChanged = true; return true; }
+    bool   IsClosedForm() const override                    { return true; }
+
+    bool   TargetReached() const override;
+    void   Execute() override;
+
+private:
+    // rotation that turns the middle bone towards the requested direction, scaled by the bone flexibility
+    Quaternion              Swing(const Quaternion& orientation, const Vector& direction) const;
+
+    BoneStorage&            m_storage;
+    size_t                  m_parentBone;
+    BoneSubchain            m_chain;
+    size_t                  m_rootBone;
+    size_t                  m_middleBone;
+    Vector                  m_tipPosition {0, 0, 0};
+    Target&                 m_target;
+    std::optional<Vector>   m_pole;
+    Convergence             m_convergence;
+    bool                    m_hasDependencies = false;
+    // new pole changes the pose even if the tip is already at the target
+    bool                    m_poleChanged = false;
+};
+
+}
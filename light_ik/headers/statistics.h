@@ -0,0 +1,46 @@
+#pragma once
+#include "types.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace LightIK
+{
+
+/// @brief Adds the duration of the scope in nanoseconds to the counter. Nothing is measured if the counter is nullptr,
+///        the timer is empty if the statistics are compiled out (LIGHT_IK_STATISTICS option)
+class ScopedTimer
+{
+public:
+#ifdef LIGHT_IK_STATISTICS
+    explicit ScopedTimer(uint64_t* counter)
+        : m_counter(counter)
+    {
+        if (m_counter)
+        {
+            m_start = Clock::now();
+        }
+    }
+
+    ~ScopedTimer()
+    {
+        if (m_counter)
+        {
+            *m_counter += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t*           m_counter;
+    Clock::time_point   m_start;
+#else
+    explicit ScopedTimer(uint64_t*) {}
+#endif
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "types.h"
+#include "arena.h"
 
 namespace LightIK
 {
@@ -10,17 +11,29 @@ class Skeleton;
 /// @brief the interface that represents target of the IK chain
 struct Target
 {
+    virtual ~Target() = default;
     virtual const Vector& GetPosition() const = 0;
+    /// @brief Returns the skeleton bone the target follows, it defines the order of the chains execution
+    /// @return the bone or nullptr if target does not depend on the skeleton
+    virtual const Bone* GetBone() const                 { return nullptr; }
+    /// @brief Position read by the solvers on every iteration, targets of the library are read without the virtual call
+    const Vector& GetSolverPosition() const             { return m_position ? *m_position : GetPosition(); }
+
+protected:
+    // Position of the targets of the library, the custom targets keep nullptr and are read by GetPosition
+    const Vector* m_position = nullptr;
 };
-using TargetPtr = std::unique_ptr<Target>;
+using TargetPtr = ArenaPtr<Target>;
 using TargetRef = std::reference_wrapper<Target>;
 
 // Target that is represented by a simple point in the 3D space
 class TargetPosition final : public Target 
 {
 public:
-    TargetPosition() = default;
-    TargetPosition(const Vector& target) : m_target(target) {}
+    TargetPosition()                                    { m_position = &m_target; }
+    TargetPosition(const Vector& target) : m_target(target) { m_position = &m_target; }
+    TargetPosition(const TargetPosition& other) : m_target(other.m_target) { m_position = &m_target; }
+    TargetPosition& operator=(const TargetPosition& other) { m_target = other.m_target; return *this; }
     const Vector& GetPosition() const        override  { return m_target;}
     void SetPosition(const Vector& position)           { m_target = position; }
 private:
@@ -34,6 +47,7 @@ public:
     TargetBone(Skeleton& skeleton);
     void AssignBone(int boneIndex);
     const Vector& GetPosition() const override;
+    const Bone* GetBone() const override               { return m_target; }
 
 private:
     Bone* m_target = nullptr;
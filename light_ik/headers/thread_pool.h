@@ -0,0 +1,73 @@
+#pragma once
+#include "types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LightIK
+{
+
+/// @brief Work-stealing thread pool. Every worker owns the task queue: it takes new tasks from the back
+///        of its own queue and steals the oldest tasks from the front of other queues when it runs out of work.
+///        Tasks submitted from outside of the pool are placed into the shared external queue.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /// @brief Constructs the pool
+    /// @param threadsCount number of worker threads, 0 means that tasks are executed only by waiting threads
+    ThreadPool(size_t threadsCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadsCount() const                          { return m_threads.size(); }
+
+    /// @brief Schedules the task for execution
+    /// @param task the task to execute
+    void Submit(Task&& task);
+
+    /// @brief Executes pending tasks on the calling thread until the counter drops to zero
+    /// @param pending counter of unfinished tasks the caller waits for
+    void Wait(const std::atomic<size_t>& pending);
+
+private:
+    // Ring buffer of the tasks, it grows when it is full and never shrinks, so the pool does not allocate
+    //  memory once the queues reached the size of the typical workload
+    struct Queue
+    {
+        void PushBack(Task&& task);
+        bool PopBack(Task& task);
+        bool PopFront(Task& task);
+
+        std::mutex          mutex;
+        std::vector<Task>   tasks = std::vector<Task>(InitialQueueSize);
+        size_t              head  = 0;
+        size_t              count = 0;
+    };
+
+    static constexpr size_t InitialQueueSize = 64;
+
+    // Index of the queue of the calling thread, external queue for non pool threads
+    size_t GetLocalQueue() const;
+    // Takes the task from the local queue or steals it from others
+    bool TryRun(size_t queue);
+    void WorkerLoop(size_t queue);
+
+    // Queue per worker, the last one is used by external threads
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread>            m_threads;
+    // upper bound of the queued tasks, the workers sleep while it is zero
+    std::atomic<size_t>                 m_queued {0};
+    std::mutex                          m_sleepMutex;
+    std::condition_variable             m_wakeUp;
+    bool                                m_stop = false;
+};
+
+}
@@ -1,13 +1,24 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <type_traits>
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <glm/glm.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
 namespace LightIK
 {
+// Precision of the library is chosen at build time, light_ik_float target defines LIGHT_IK_SINGLE_PRECISION
+#ifdef LIGHT_IK_SINGLE_PRECISION
+using real          = float;
+#else
 using real          = double;
+#endif
+
 using Vector        = glm::vec<3, real, glm::highp>;
 using Vector2       = glm::vec<2, real, glm::highp>;
 using Vector4       = glm::vec<4, real, glm::highp>;
@@ -15,7 +26,9 @@ using Matrix        = glm::mat<3, 3, real, glm::highp>;
 using Matrix3       = glm::mat<3, 3, real, glm::highp>;
 using Quaternion    = glm::qua<real, glm::highp>;
 
-static const real EPSILON   = 1e-14;
+// Tolerance for the squared distances and degenerate cases, it follows the precision of the real type:
+// single precision can not resolve distances much below 1e-5 on the unit scale.
+static const real EPSILON   = std::is_same_v<real, float> ? (real)1e-10 : (real)1e-14;
 
 constexpr bool EnableDebugLogging = true;
 
@@ -77,11 +90,108 @@ struct Length
     real stretch   = 0.f;       // extension factor. if 0 bone has fixed length
 };
     
+// How the rotation limits of the bone are evaluated
+enum class ConstraintType
+{
+    euler,          // limits of the XZY Euler angles of the local rotation
+    swingTwist      // cone of the bone direction around the parent Y axis and the twist around the bone, no trigonometry
+};
+
 struct Constraints
 {
     real flexibility = 1;
     Vector minAngles {-glm::pi<real>(), -glm::pi<real>(), -glm::pi<real>()};
     Vector maxAngles { glm::pi<real>(),  glm::pi<real>(),  glm::pi<real>()};
+    ConstraintType type = ConstraintType::euler;
+    // limits of ConstraintType::swingTwist: maximal angle between the bone and the parent Y axis, range of the twist
+    real swingLimit  = glm::pi<real>();
+    real twistMin    = -glm::pi<real>();
+    real twistMax    = glm::pi<real>();
+
+    static Constraints SwingTwist(real swingLimit, real twistMin, real twistMax, real flexibility = 1)
+    {
+        Constraints result;
+        result.flexibility  = flexibility;
+        result.type         = ConstraintType::swingTwist;
+        result.swingLimit   = swingLimit;
+        result.twistMin     = twistMin;
+        result.twistMax     = twistMax;
+        return result;
+    }
+};
+
+// Criteria to finish the chain iterations before the iterations budget is spent
+struct Convergence
+{
+    real tolerance       = glm::sqrt(EPSILON); // distance from the tip to the target that is treated as reached
+    real stallThreshold  = 0;                  // stop if the distance decreased less than this value during the iteration, 0 disables
+    real sleepThreshold  = 0;                  // skip the converged chain while its target and base moved less than this value, 0 disables
+};
+
+// The reason the chain finished its iterations on the last update
+enum class StopReason
+{
+    none,           // chain was not updated yet
+    reached,        // the tip is within the tolerance from the target
+    stalled,        // the distance to the target stopped improving
+    exhausted,      // all iterations were spent
+    sleeping        // the chain converged earlier and its inputs did not change, the update was skipped
+};
+
+// Histogram with power of two buckets: bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i),
+//  the last bucket takes all bigger values
+struct Histogram
+{
+    static constexpr size_t BucketsCount = 32;
+
+    void Add(uint64_t value)
+    {
+        const size_t bucket  = std::min<size_t>(std::bit_width(value), BucketsCount - 1);
+        ++buckets[bucket];
+        ++count;
+        total               += value;
+        max                 = std::max(max, value);
+    }
+
+    std::array<uint64_t, BucketsCount> buckets{};
+    uint64_t count  = 0;    // number of added values
+    uint64_t total  = 0;    // sum of added values
+    uint64_t max    = 0;    // maximal added value
+};
+
+// Measurements of one chain, the fields of the last update are overwritten by every update
+struct ChainStatistics
+{
+    // last update
+    size_t      iterations      = 0;                    // iterations performed by the chain
+    real        error           = 0;                    // distance from the tip of the last front kinematics to the target
+    StopReason  stopReason      = StopReason::none;     // converged, stalled or exhausted the iterations
+    uint64_t    kinematicsTime  = 0;                    // nanoseconds spent in the front kinematics
+    uint64_t    solverTime      = 0;                    // nanoseconds spent in the solver
+    uint32_t    clamps          = 0;                    // rotations of the chain bones limited by the constraints
+    // totals since the statistics were reset
+    uint64_t    updates         = 0;                    // number of updates of the chain
+    uint64_t    totalTime       = 0;                    // nanoseconds of all updates, front kinematics and solver together
+    uint64_t    maxTime         = 0;                    // nanoseconds of the longest update
+};
+
+// Measurements of all chains aggregated since the statistics were reset
+struct Statistics
+{
+    uint64_t    updates         = 0;                    // number of skeleton updates
+    Histogram   iterations;                             // iterations per chain update
+    Histogram   time;                                   // nanoseconds per chain update
+    Histogram   clamps;                                 // constraint clamps per chain update
+    std::array<uint64_t, 5> stopReasons{};              // chain updates per stop reason, indexed by StopReason
+};
+
+// Algorithm that solves the IK chain
+enum class SolverType
+{
+    automatic,      // closed form solver for two bone chains, binary joint solver for the others
+    binaryJoint,    // joints are solved one by one from the tip to the root as two segment joints
+    twoBone,        // closed form solution, only for the chains of two bones
+    fabrik          // forward and backward reaching of the joint positions, rotations are extracted afterwards
 };
 
 }
@@ -2,21 +2,50 @@
 #include <../headers/types.h>
 #include <../headers/target.h>
 #include <../headers/helpers.h>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 
 namespace LightIK
 {
 
 class Skeleton;
 class SolverBase;
+class ThreadPool;
+class Recorder;
+class RigView;
+class Rig;
 
 
+/// @brief Caller provided contiguous buffers of the pose, indexed by the bone index of the engine.
+///        Empty spans are skipped, the spans must cover the indices of all bones of IK chains.
+template <typename T>
+struct PoseBuffers
+{
+    std::span<glm::qua<T, glm::highp>>      rotations;      // local rotations, the same as GetDeltaRotations
+    std::span<glm::vec<3, T, glm::highp>>   positions;      // joint positions in the system of the skeleton root
+    std::span<glm::qua<T, glm::highp>>      orientations;   // global orientations in the system of the skeleton root
+};
+
+/// @brief Model space transform of the bone packed for the renderer: 3 rows of the affine matrix in the row major order,
+///        the last column is the joint position. 48 bytes aligned to 16, it can be copied into a GPU buffer as is
+struct alignas(16) BoneMatrix
+{
+    float rows[3][4];
+};
+
 class LightIK
 {
 public:
     /// @brief Constructs the Light IK plugin
     /// @param bonesCount - total number of bones inside the skeleton
     LightIK(size_t bonesCount);
+
+    /// @brief Constructs the instance of the rig: the parameters of the bones are shared with the rig, the pose
+    ///        starts from the rest pose of the rig. Targets of the position chains are returned by GetRigTarget
+    /// @param rig - the rig, the instance keeps the shared parameters of the bones alive after the rig is released
+    LightIK(const Rig& rig);
     ~LightIK();
 
     /// @brief Restores the default position of the skeleton
@@ -29,26 +58,133 @@ public:
     /// @param rootChainDesc - the chain, started from the skeleton root, till the tip of the current chain
     /// @param chainStartIndex - index of the bone from which the actual IK chain is starting
     /// @param target - the target for current chain, it can be either position or another bone
+    /// @param solverType - algorithm that solves the chain
     /// @return index of the created chain
-    size_t CreateIKChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, Target& target);
+    size_t CreateIKChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, Target& target, SolverType solverType = SolverType::automatic);
 
     /// @brief Creates IK chain that uses skeleton bone as a target
     /// @param rootChainDesc - the chain, started from the skeleton root, till the tip of the current chain
     /// @param chainStartIndex - index of the bone from which the actual IK chain is starting
     /// @param targetBoneIndex - the index of the bone that the chain is targeting to
-    /// @return index of the created chain
-    size_t CreateIKLink(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, int targetBoneIndex);
+    /// @param solverType - algorithm that solves the chain
+    /// @return index of the created chain, SIZE_MAX if the target bone is not registered by the previous chains
+    size_t CreateIKLink(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, int targetBoneIndex, SolverType solverType = SolverType::automatic);
 
     /// @brief Creates passive IK chain that can be used in dependent calculations
     /// @param rootChainDesc - the chain, started from the skeleton root
     void CreatePassiveChain(const std::vector<BoneDesc>& rootChainDesc);
 
+    /// @brief Describes the whole skeleton at once, the chains are then created by their start and tip bones, so the
+    ///        bones shared by several chains are described only once. The arrays are indexed by the bone index
+    /// @param parents - index of the parent bone, -1 for the bones attached to the skeleton root
+    /// @param lengths - lengths of the bones
+    /// @param rotations - rest rotations of the bones in the system of the parent bone
+    /// @return false if the sizes of the arrays differ, exceed the bones count or the parents form a cycle
+    bool SetHierarchy(std::span<const int> parents, std::span<const real> lengths, std::span<const Quaternion> rotations);
+
+    /// @brief Creates IK chain of the hierarchy, only the bones that are not registered by the previous chains
+    ///        are visited above the start bone
+    /// @param chainStartIndex - index of the bone from which the IK chain is starting, the tip or its ancestor
+    /// @param tipBoneIndex - index of the last bone of the chain
+    /// @param target - the target for current chain, it can be either position or another bone
+    /// @param solverType - algorithm that solves the chain
+    /// @return index of the created chain, SIZE_MAX if the bones are not in the hierarchy or the start bone
+    ///         is not the ancestor of the tip
+    size_t CreateIKChain(int chainStartIndex, int tipBoneIndex, Target& target, SolverType solverType = SolverType::automatic);
+
+    /// @brief Creates IK chain of the hierarchy that uses skeleton bone as a target
+    /// @param chainStartIndex - index of the bone from which the IK chain is starting, the tip or its ancestor
+    /// @param tipBoneIndex - index of the last bone of the chain
+    /// @param targetBoneIndex - the index of the bone that the chain is targeting to
+    /// @param solverType - algorithm that solves the chain
+    /// @return index of the created chain, SIZE_MAX if the bones are not in the hierarchy, the start bone is not
+    ///         the ancestor of the tip or the target bone is not registered by the previous chains
+    size_t CreateIKLink(int chainStartIndex, int tipBoneIndex, int targetBoneIndex, SolverType solverType = SolverType::automatic);
+
+    /// @brief Creates passive chain of the hierarchy from the registered bones down to the tip
+    /// @param tipBoneIndex - index of the last bone of the chain
+    /// @return false if the tip is not in the hierarchy or it is registered by the previous chains already
+    bool CreatePassiveChain(int tipBoneIndex);
+
+    /// @brief Creates the chains and the constraints of the rig file, the bones of the rig replace the hierarchy of
+    ///        the library. Chains that follow the target position get the targets created by the library, they are
+    ///        returned by GetRigTarget
+    /// @param rig - the rig, bones of the rig must fit into the bones count of the library
+    /// @return false if the rig is not valid or its chain can not be created, the library is reset in this case
+    bool CreateRig(const RigView& rig);
+
+    /// @brief Returns the target the library created for the chain of the rig
+    /// @param chainIndex - index of the chain
+    /// @return the target, nullptr if the chain is not created by CreateRig or does not follow the target position
+    TargetPosition* GetRigTarget(size_t chainIndex) const;
+
     /// @brief Sets constraint for the specific bone
     /// @param boneIndex - index of the bone to set the constraint
     /// @param constrinat - rotation constraint parameters
     void SetConstraint(size_t boneIndex, Constraints && constrinat);
     
-    /// @brief perform required number of backward/forward iteration steps
+    /// @brief Sets the criteria to finish iterations of the chain before the iterations budget is spent
+    /// @param chainIndex - index of the chain
+    /// @param convergence - tolerance to the target and minimal improvement of the distance per iteration
+    void SetConvergence(size_t chainIndex, const Convergence& convergence);
+
+    /// @brief Returns the reason the chain finished its iterations on the last update
+    /// @param chainIndex - index of the chain
+    /// @return the stop reason
+    StopReason GetStopReason(size_t chainIndex) const;
+
+    /// @brief Starts or stops collection of the chain statistics, the collected statistics are reset.
+    ///        Does nothing if the library is built without LIGHT_IK_STATISTICS option
+    /// @param enable - true to measure every chain on every update
+    void EnableStatistics(bool enable);
+
+    /// @brief Clears the measurements of all chains and the aggregated histograms
+    void ResetStatistics();
+
+    /// @brief Returns the measurements of the chain: the last update and the totals since the reset
+    /// @param chainIndex - index of the chain
+    /// @return the chain statistics
+    const ChainStatistics& GetChainStatistics(size_t chainIndex) const;
+
+    /// @brief Returns the histograms of the iterations, time and constraint clamps of all chain updates since the reset
+    /// @return the aggregated statistics
+    const Statistics& GetStatistics() const;
+
+    /// @brief Sets the pole (swivel) point of the two bone chain, the middle joint bends towards it
+    /// @param chainIndex - index of the chain
+    /// @param pole - position of the pole, nullopt to keep the current bending plane of the chain
+    /// @return false if the chain is not solved by the two bone solver
+    bool SetPole(size_t chainIndex, const std::optional<Vector>& pole);
+
+    /// @brief Solves the chains together: tips of the IK chains follow their targets by one damped least squares system,
+    ///        so the chains that share bones do not fight for them, bones of the passive chains bend to help them.
+    ///        The chains must start from the skeleton root or be attached to the earliest created chain of the group 
+    ///        directly or through the other chains of the group.
+    /// @param chainIndices - indices of the chains, at least two chains with 1 up to 8 IK chains
+    /// @param damping - damping factor, bigger values make the steps shorter and stable near the unreachable targets
+    /// @return false if the chains can not be solved together
+    bool CreateEffectorGroup(const std::vector<size_t>& chainIndices, real damping = (real)0.5);
+
+    /// @brief Creates the pool of worker threads, the pool can be shared by several skeletons
+    /// @param threadsCount - number of worker threads, calling thread always takes part in the execution
+    /// @return the pool object
+    static std::shared_ptr<ThreadPool> CreateThreadPool(size_t threadsCount);
+
+    /// @brief Enables parallel solving of independent chains. The result does not depend on the threads count.
+    /// @param pool - the pool to execute chains, nullptr to solve all chains on the calling thread
+    void SetThreadPool(std::shared_ptr<ThreadPool> pool);
+
+    /// @brief Builds the execution plan after the chains are created: independent chains are grouped by the solver
+    ///        type and solved in batches. Otherwise the first update after the chains are changed builds it
+    void Finalize();
+
+    /// @brief Captures the construction calls and the updates into the recorder, the session can be repeated by Replay.
+    ///        The recorder is attached before the chains are created, the calls made before are not captured
+    /// @param recorder - the recorder, its previous log is dropped; nullptr to stop the capture
+    void SetRecorder(Recorder* recorder);
+
+    /// @brief perform required number of backward/forward iteration steps, the update does not allocate memory 
+    ///        (the first update after the chains are changed builds the execution plan)
     /// @param iterations - number of iterations to calculate bones positions
     /// @return actual number of iterations
     size_t Update(size_t iterations = 1);
@@ -57,6 +193,21 @@ public:
     /// @return vector of quaternions
     const std::vector<const Quaternion*>& GetDeltaRotations();
 
+    /// @brief Writes the pose of the bones that take part in IK into the buffers, the elements of the other bones
+    ///        are not touched, so the buffers can hold the animation pose of the whole skeleton.
+    ///        Positions and orientations are brought up to date with the last iteration before they are written.
+    /// @param buffers - the buffers in single or double precision
+    /// @return number of written bones
+    size_t WritePose(const PoseBuffers<float>& buffers);
+    size_t WritePose(const PoseBuffers<double>& buffers);
+
+    /// @brief Writes model space matrices of the bones that take part in IK, the elements of the other bones are not
+    ///        touched. Matrices are built from the positions and orientations of the front kinematics, the pending
+    ///        front kinematics pass runs first for the chains whose bones were rotated by the last iteration
+    /// @param matrices - buffer indexed by the bone index
+    /// @return number of written bones
+    size_t WriteModelMatrices(std::span<BoneMatrix> matrices);
+
     const Vector& GetTargetPosition(size_t chainIndex) const;
     /// @brief Create target object that points on bone internal structure
     /// @return internal target object
@@ -72,10 +223,43 @@ public:
     Vector GetBonePosition(size_t index) const;
 
 private:
+    friend class Rig;
+
+    // remembers the bones of the created chain for the pose output
+    void RegisterBones(const std::vector<BoneDesc>& rootChainDesc);
+
+    // collects the root chain of the hierarchy from the registered ancestor of the start bone down to the tip into
+    //  m_rootChain, the ancestor is the first descriptor if any, so the skeleton attaches the chain to it.
+    //  Returns false if the bones are not in the hierarchy or the start bone is not the ancestor of the tip
+    bool CollectRootChain(int chainStartIndex, int tipBoneIndex);
+
+    // captures the chain with the position target or the bone target
+    void RecordChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, const Target& target, SolverType solverType);
+
+    template <typename T>
+    size_t WritePoseImpl(const PoseBuffers<T>& buffers);
+
+    struct PoseBone
+    {
+        size_t boneIndex;
+        size_t slot;
+    };
+
+    std::shared_ptr<ThreadPool> m_threadPool;
     std::unique_ptr<Skeleton> m_skeleton;
     std::vector<std::reference_wrapper<SolverBase>> m_solvers;
     std::vector<const Quaternion*> m_relativeRotations;
+    // bones of the IK chains sorted by the bone index, storage slots let the pose output avoid the bone objects
+    std::vector<PoseBone> m_poseBones;
     std::vector<TargetPtr> m_targets;
+    // targets created for the position chains of the rig, indexed by the chain index
+    std::vector<TargetPosition*> m_rigTargets;
+    // skeleton described by SetHierarchy: descriptors and parents indexed by the bone index
+    std::vector<BoneDesc> m_hierarchy;
+    std::vector<int> m_parents;
+    // root chain collected from the hierarchy, kept between the calls to avoid allocations
+    std::vector<BoneDesc> m_rootChain;
+    Recorder* m_recorder = nullptr;
 };
 
 }
\ No newline at end of file
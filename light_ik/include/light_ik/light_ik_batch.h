@@ -0,0 +1,95 @@
+#pragma once
+#include <../headers/types.h>
+#include <../headers/target.h>
+#include <memory>
+#include <vector>
+
+namespace LightIK
+{
+
+class Skeleton;
+class SolverBatch;
+struct SolverBase;
+struct PackVector;
+struct PackQuaternion;
+
+/// @brief Set of skeleton instances that share the same rig. All instances are solved in lockstep,
+///        the per-instance state is stored in blocks of lanes to let the math vectorize over instances.
+///        Chains of the batch support position targets only.
+class LightIKBatch
+{
+public:
+    /// @brief Constructs the batch
+    /// @param bonesCount - total number of bones inside the skeleton
+    /// @param instancesCount - number of skeleton instances in the batch
+    LightIKBatch(size_t bonesCount, size_t instancesCount);
+    ~LightIKBatch();
+
+    /// @brief Restores the default position of all skeleton instances
+    void ResetPose();
+
+    /// @brief Creates IK chain out of the root chain for all instances
+    /// @param rootChainDesc - the chain, started from the skeleton root, till the tip of the current chain
+    /// @param chainStartIndex - index of the bone from which the actual IK chain is starting
+    /// @return index of the created chain
+    size_t CreateIKChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex);
+
+    /// @brief Creates passive IK chain that can be used in dependent calculations
+    /// @param rootChainDesc - the chain, started from the skeleton root
+    void CreatePassiveChain(const std::vector<BoneDesc>& rootChainDesc);
+
+    /// @brief Sets constraint for the specific bone of all instances
+    /// @param boneIndex - index of the bone to set the constraint
+    /// @param constrinat - rotation constraint parameters
+    void SetConstraint(size_t boneIndex, Constraints && constrinat);
+
+    /// @brief Sets the target of the chain for the specific instance
+    /// @param chainIndex - index of the chain
+    /// @param instance - index of the skeleton instance
+    /// @param position - target position
+    void SetTargetPosition(size_t chainIndex, size_t instance, const Vector& position);
+
+    /// @brief perform required number of backward/forward iteration steps for all instances
+    /// @param iterations - number of iterations to calculate bones positions
+    /// @return minimal number of iterations over all instances
+    size_t Update(size_t iterations = 1);
+
+    /// @brief Returns relative rotation of the bone for the specific instance
+    Quaternion GetDeltaRotation(size_t instance, size_t boneIndex) const;
+
+    size_t GetInstancesCount() const                { return m_instancesCount; }
+    size_t GetSolversCount() const                  { return m_chains.size();  }
+
+    // functions to support tests
+    Vector GetTargetPosition(size_t chainIndex, size_t instance) const;
+    Vector GetTipPosition(size_t chainIndex, size_t instance) const;
+    Vector GetBonePosition(size_t instance, size_t boneIndex) const;
+
+private:
+    struct Chain;
+    using ChainPtr = std::unique_ptr<Chain>;
+
+    // Copies the rest pose of the rig into every instance
+    void InitializePose();
+    void PreparePose();
+    size_t GetSlot(size_t boneIndex) const;
+
+    size_t                      m_instancesCount;
+    size_t                      m_blocksCount;
+    size_t                      m_slotsCount = 0;
+    bool                        m_poseDirty  = true;
+
+    // Target of the rig solvers, they are never executed, so the target is not used. It is referenced by the rig
+    //  chains and outlives them
+    TargetPosition              m_rigTarget;
+    // Rig of the skeleton, stores the structure of the chains and parameters of the bones
+    std::unique_ptr<Skeleton>   m_rig;
+    std::vector<ChainPtr>       m_chains;
+
+    // Pose of all instances, element of block b for bone slot s is located at b * m_slotsCount + s
+    std::vector<PackVector>     m_positions;
+    std::vector<PackQuaternion> m_rotations;
+    std::vector<PackQuaternion> m_globalOrientations;
+};
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+namespace LightIK
+{
+
+/// @brief Parts of the update reported to the profiler
+enum class ProfileScope : uint8_t
+{
+    update,         // whole skeleton update, id is 0
+    chain,          // update of one chain, id is the chain index
+    iteration,      // one solver iteration of the chain, id is the iteration number
+    kinematics,     // front kinematics of the chain, id is the chain index
+    constraint,     // constraint applied to the bone rotation, id is the storage slot of the bone
+};
+
+/// @brief Returns the name of the scope as it is shown in the profiler
+const char* GetScopeName(ProfileScope scope);
+
+/// @brief Interface of the profiler the engine attaches to the library. Scopes are reported by the thread that
+///        executes them, with the thread pool the calls come from several threads at once. Scopes of one thread
+///        are nested, EndScope always closes the last opened scope of the thread.
+///        The hooks are compiled in by the LIGHT_IK_PROFILER option, without it the profiler is never called.
+struct Profiler
+{
+    virtual ~Profiler() = default;
+    virtual void BeginScope(ProfileScope scope, uint32_t id) = 0;
+    virtual void EndScope(ProfileScope scope) = 0;
+};
+
+/// @brief Attaches the profiler to all instances of the library
+/// @param profiler the profiler, nullptr to detach. The profiler must outlive the updates that report to it
+void SetProfiler(Profiler* profiler);
+
+/// @brief Profiler that records the scopes into Chrome trace event JSON (chrome://tracing, Perfetto).
+///        Every thread writes the events into its own fixed size buffer without locks, the events that do not fit
+///        are dropped and counted. The trace is written after the updates, or concurrently with them: events
+///        published before the call are written.
+class ChromeTraceWriter final : public Profiler
+{
+public:
+    /// @brief Constructs the writer
+    /// @param eventsPerThread capacity of the buffer of each thread, begin and end of the scope are two events
+    ChromeTraceWriter(size_t eventsPerThread = 1 << 16);
+    ~ChromeTraceWriter();
+
+    ChromeTraceWriter(const ChromeTraceWriter&) = delete;
+    ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+
+    void BeginScope(ProfileScope scope, uint32_t id) override;
+    void EndScope(ProfileScope scope) override;
+
+    /// @brief Writes the recorded events as the trace event JSON object
+    /// @param stream the output stream
+    void Write(std::ostream& stream) const;
+
+    /// @brief Returns the number of events that did not fit into the buffers
+    size_t GetDroppedCount() const;
+
+private:
+    struct Event;
+    struct ThreadBuffer;
+
+    // Buffer of the calling thread, created on the first event of the thread
+    ThreadBuffer& GetThreadBuffer();
+    void Record(ProfileScope scope, uint32_t id, bool begin);
+
+    using Clock = std::chrono::steady_clock;
+
+    const size_t                m_capacity;
+    const Clock::time_point     m_start;
+    // Unique identifier of the writer, the buffer cached by the thread is valid only for the same writer
+    const uint64_t              m_id;
+    // Buffers of all threads in the lock free list, new buffers are pushed to the head
+    std::atomic<ThreadBuffer*>  m_buffers {nullptr};
+    std::atomic<uint32_t>       m_threadsCount {0};
+};
+
+}
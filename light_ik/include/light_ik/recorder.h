@@ -0,0 +1,122 @@
+#pragma once
+#include <../headers/types.h>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace LightIK
+{
+
+class LightIK;
+class TargetPosition;
+
+/// @brief Captures the session of the LightIK instance into the compact binary log: construction of the chains,
+///        constraints and convergence settings, and every update with the positions of the position targets.
+///        The log keeps the raw bits of the values, so the replay repeats the session bit by bit on the same build.
+///        The recorder is attached by LightIK::SetRecorder right after the library is constructed, the calls made
+///        before are not captured. Targets are captured by the kind they have at the chain creation: bone targets
+///        are replayed as links to the same bone, the positions of the other targets are captured on every update.
+///        After every update the recorder stores the iterations count and the hash of all chain tips.
+class Recorder
+{
+public:
+    /// @brief Constructs the recorder
+    /// @param reserve initial capacity of the log in bytes, the log grows by reallocations after it is spent
+    Recorder(size_t reserve = 1 << 16);
+
+    /// @brief Returns the captured log
+    const std::vector<uint8_t>& GetData() const             { return m_data;                }
+
+    /// @brief Writes the captured log into the stream
+    /// @return false if the stream failed
+    bool Save(std::ostream& stream) const;
+
+    /// @brief Drops the captured log, the recorder can be attached again
+    void Clear();
+
+private:
+    friend class LightIK;
+
+    void RecordStart(size_t bonesCount);
+    void RecordChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, size_t chainIndex,
+        SolverType solverType);
+    void RecordLink(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, int targetBoneIndex,
+        SolverType solverType);
+    void RecordPassiveChain(const std::vector<BoneDesc>& rootChainDesc);
+    void RecordConstraint(size_t boneIndex, const Constraints& constraint);
+    void RecordConvergence(size_t chainIndex, const Convergence& convergence);
+    void RecordPole(size_t chainIndex, const std::optional<Vector>& pole);
+    void RecordEffectorGroup(const std::vector<size_t>& chainIndices, real damping);
+    void RecordResetPose();
+    void RecordReset();
+    void RecordUpdate(const LightIK& library, size_t iterations);
+    void RecordResult(const LightIK& library, size_t iterations);
+
+    template <typename T>
+    void Write(const T& value);
+    void WriteDescriptors(const std::vector<BoneDesc>& descriptors);
+
+    std::vector<uint8_t>    m_data;
+    // chains with the position targets in the creation order, their target positions are captured on every update
+    std::vector<size_t>     m_positionChains;
+};
+
+/// @brief Repeats the session captured by the Recorder. Construction calls are applied to the library as they come,
+///        every Step ends with the captured update. The result of the update is compared with the captured one:
+///        the iterations count and the hash of the chain tips.
+class Replay
+{
+public:
+    /// @brief Reads the log
+    /// @param stream the stream with the log written by Recorder::Save
+    Replay(std::istream& stream);
+
+    /// @brief Takes the log
+    /// @param data the log returned by Recorder::GetData
+    Replay(std::vector<uint8_t> data);
+
+    /// @brief Verifies the header of the log: format version and precision of the library
+    bool IsValid() const                                    { return m_valid;               }
+
+    /// @brief Returns the number of bones the captured library was constructed with
+    size_t GetBonesCount() const                            { return m_bonesCount;          }
+
+    /// @brief Applies the captured calls to the library up to the next update and performs the update
+    /// @param library the library constructed with GetBonesCount bones, it is used for the whole replay
+    /// @return false if there are no more updates in the log or the log is damaged, IsFinished tells them apart
+    bool Step(LightIK& library);
+
+    /// @brief Verifies that the replay has reached the end of the log, false while the log is replayed
+    ///        and after Step has stopped at a damaged or truncated record
+    bool IsFinished() const                                 { return m_finished;            }
+
+    /// @brief Restarts the replay, the next Step expects the new library
+    void Rewind();
+
+    /// @brief Number of replayed updates
+    size_t GetFrame() const                                 { return m_frame;               }
+
+    /// @brief Number of updates whose result differs from the captured one
+    size_t GetMismatches() const                            { return m_mismatches;          }
+
+private:
+    template <typename T>
+    bool Read(T& value);
+    bool ReadHeader();
+    bool ReadDescriptors(std::vector<BoneDesc>& descriptors);
+
+    std::vector<uint8_t>    m_data;
+    size_t                  m_offset        = 0;
+    size_t                  m_bodyOffset    = 0;
+    size_t                  m_bonesCount    = 0;
+    bool                    m_valid         = false;
+    bool                    m_finished      = false;
+    size_t                  m_frame         = 0;
+    size_t                  m_mismatches    = 0;
+    // targets of the replayed position chains in the creation order
+    std::vector<TargetPosition*> m_targets;
+};
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+namespace LightIK
+{
+
+class LightIK;
+class RigView;
+
+/// @brief Immutable definition of the skeleton: chains with their solvers, lengths, rest rotations and constraints
+///        of the bones. The rig is built once, the instances constructed by LightIK(const Rig&) share the parameters
+///        of the bones with it and copy its rest pose instead of building the chains again. The rig is not changed
+///        after it is built, so the instances can be constructed from several threads.
+class Rig
+{
+public:
+    /// @brief Builds the rig from the rig file
+    /// @param view the rig file, it is not used after the call
+    /// @return the rig, nullptr if the rig file is not valid
+    static std::shared_ptr<const Rig> Create(const RigView& view);
+    ~Rig();
+
+    /// @brief Returns the number of bones of the instances
+    size_t GetBonesCount() const;
+
+private:
+    friend class LightIK;
+
+    Rig();
+
+    // library the instances are copied from, it is finalized when the rig is built
+    std::unique_ptr<LightIK>    m_prototype;
+    // index of the bone the chain follows, -1 for the chains of the position targets and the passive chains
+    std::vector<int>            m_targetBones;
+};
+
+}
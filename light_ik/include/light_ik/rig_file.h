@@ -0,0 +1,106 @@
+#pragma once
+#include <../headers/types.h>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace LightIK
+{
+
+/// @brief Bone of the rig, bones are listed by the bone index of the engine
+struct RigBone
+{
+    Quaternion  rotation;                   // rest rotation in the system of the parent bone
+    real        length          = 0;
+    int32_t     parent          = -1;       // index of the parent bone, -1 for the bones attached to the skeleton root
+    uint32_t    constrained     = 0;        // not 0 if the constraint of the bone is set
+};
+
+/// @brief How the chain of the rig follows its target
+enum class RigChainType : uint8_t
+{
+    position,       // target position is set by the application, the library creates the target
+    bone,           // target is another bone of the skeleton
+    passive,        // chain is not solved, its bones are the targets or the bases of other chains
+};
+
+/// @brief Chain of the rig, the bones of the chain are found by the parents from the tip up to the start bone,
+///        the chains are created in the order of the list
+struct RigChain
+{
+    int32_t         start       = 0;        // first bone of the IK chain, ignored by the passive chains
+    int32_t         tip         = 0;        // last bone of the chain
+    int32_t         targetBone  = -1;       // bone the chain follows, only for RigChainType::bone
+    RigChainType    type        = RigChainType::position;
+    uint8_t         solverType  = (uint8_t)SolverType::automatic;
+    uint16_t        reserved    = 0;
+};
+
+/// @brief Read only view of the rig file. The sections are used in place: the file is aligned so the bones,
+///        constraints and chains are the arrays of the structures of this header. The file keeps the size of
+///        the real numbers, the view of the file written with another precision is not valid.
+class RigView
+{
+public:
+    RigView() = default;
+
+    /// @brief Validates the file: format version, sizes of the sections, bone and chain indices, the parents
+    ///        of the bones do not form cycles, target bones belong to the earlier chains
+    /// @param data the content of the file, it must outlive the view and be aligned to 16 bytes
+    RigView(std::span<const uint8_t> data);
+
+    bool IsValid() const                                        { return m_valid;               }
+
+    std::span<const RigBone>        GetBones() const            { return m_bones;               }
+    /// @brief Constraints of the bones, indexed by the bone index, applied only to the bones marked as constrained
+    std::span<const Constraints>    GetConstraints() const      { return m_constraints;         }
+    std::span<const RigChain>       GetChains() const           { return m_chains;              }
+
+private:
+    std::span<const RigBone>        m_bones;
+    std::span<const Constraints>    m_constraints;
+    std::span<const RigChain>       m_chains;
+    bool                            m_valid = false;
+};
+
+/// @brief Rig file mapped into the memory. The pages are mapped read only and shared, so the processes that map
+///        the same file share its physical memory
+class RigFile
+{
+public:
+    /// @brief Maps the file
+    /// @param path path to the file written by WriteRig
+    RigFile(const std::string& path);
+
+    /// @brief Takes the content of the file read by the application
+    /// @param data the content of the file
+    RigFile(std::vector<uint8_t> data);
+    ~RigFile();
+
+    RigFile(const RigFile&) = delete;
+    RigFile& operator=(const RigFile&) = delete;
+
+    bool IsValid() const                                        { return m_view.IsValid();      }
+    const RigView& GetView() const                              { return m_view;                }
+
+private:
+    // the mapped pages, nullptr if the file is not mapped
+    void*                   m_mapping   = nullptr;
+    size_t                  m_size      = 0;
+    // content of the file that is not mapped
+    std::vector<uint8_t>    m_data;
+    RigView                 m_view;
+};
+
+/// @brief Writes the rig file
+/// @param stream the binary output stream
+/// @param bones bones of the skeleton indexed by the bone index
+/// @param constraints constraints of the bones, indexed by the bone index, empty if no bone is constrained
+/// @param chains chains in the creation order
+/// @return false if the rig is not valid or the stream failed
+bool WriteRig(std::ostream& stream, std::span<const RigBone> bones, std::span<const Constraints> constraints,
+    std::span<const RigChain> chains);
+
+}
@@ -0,0 +1,300 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "batch_math.h"
+#include "helpers.h"
+
+#include <limits>
+
+namespace LightIK
+{
+    namespace
+    {
+        // Adding and subtracting this value drops the fraction part of any smaller non negative number
+        constexpr real RoundingShift    = (real)1 / std::numeric_limits<real>::epsilon();
+
+        // Floor of non negative values, plain arithmetic keeps it vectorizable without SSE4.1
+        inline Pack FloorPositive(const Pack& x)
+        {
+            Pack rounded    = (x + RoundingShift) - RoundingShift;
+            return rounded - Select(rounded > x, Pack::Broadcast(1), Pack::Broadcast(0));
+        }
+
+        inline Pack Constant(real value)
+        {
+            return Pack::Broadcast(value);
+        }
+
+        // calls the kernel for each pack of the array, the last pack may be incomplete
+        template <typename Kernel>
+        inline void ForEachPack(size_t size, Kernel&& kernel)
+        {
+            for (size_t offset = 0; offset < size; offset += BatchLanes)
+            {
+                kernel(offset, std::min(BatchLanes, size - offset));
+            }
+        }
+    }
+
+    void SinCos(const Pack& a, Pack& sine, Pack& cosine)
+    {
+        // extended precision pi/4 split into three parts for the exact range reduction, 
+        //  each part has enough trailing zero bits to be multiplied exactly in the chosen precision
+        constexpr bool single = std::is_same_v<real, float>;
+        constexpr real DP1  = single ? (real)0.78515625                  : (real)7.85398125648498535156E-1;
+        constexpr real DP2  = single ? (real)2.4187564849853515625E-4    : (real)3.77489470793079817668E-8;
+        constexpr real DP3  = single ? (real)3.77489497744594108E-8      : (real)2.69515142907905952645E-15;
+        constexpr real FOPI = 1.27323954473516268615;
+
+        const Pack x        = Abs(a);
+        Pack octant         = FloorPositive(x * FOPI);
+        // map zeros of sine and cosine to the origin
+        octant              = octant + (octant - FloorPositive(octant * (real)0.5) * (real)2);
+        const Pack z        = ((x - octant * DP1) - octant * DP2) - octant * DP3;
+        const Pack zz       = z * z;
+
+        const Pack s        = z + z * zz * ((((((zz * (real)1.58962301576546568060E-10 - (real)2.50507477628578072866E-8) * zz 
+                                + (real)2.75573136213857245213E-6) * zz - (real)1.98412698295895385996E-4) * zz 
+                                + (real)8.33333333332211858878E-3) * zz - (real)1.66666666666666307295E-1));
+        const Pack c        = (real)1 - zz * (real)0.5 + zz * zz * ((((((zz * (real)-1.13585365213876817300E-11 
+                                + (real)2.08757008419747316778E-9) * zz - (real)2.75573141792967388112E-7) * zz 
+                                + (real)2.48015872888517045348E-5) * zz - (real)1.38888888888730564116E-3) * zz 
+                                + (real)4.16666666666665929218E-2));
+
+        // octant is one of 0, 2, 4, 6 after the reduction
+        octant              = octant - FloorPositive(octant * (real)0.125) * (real)8;
+        const PackMask swap = octant == 2 || octant == 6;
+        const Pack sineSign = Select(octant > 3, Constant(-1), Constant(1)) * Select(a < 0, Constant(-1), Constant(1));
+        const Pack cosSign  = Select(octant == 2 || octant == 4, Constant(-1), Constant(1));
+
+        sine                = Select(swap, c, s) * sineSign;
+        cosine              = Select(swap, s, c) * cosSign;
+    }
+
+    Pack Sin(const Pack& a)
+    {
+        Pack s, c;
+        SinCos(a, s, c);
+        return s;
+    }
+
+    Pack Cos(const Pack& a)
+    {
+        Pack s, c;
+        SinCos(a, s, c);
+        return c;
+    }
+
+    Pack Atan(const Pack& a)
+    {
+        constexpr real T3P8     = 2.41421356237309504880;
+        constexpr real MOREBITS = 6.123233995736765886130E-17;
+
+        const Pack x            = Abs(a);
+        const PackMask large    = x > T3P8;
+        const PackMask medium   = !large && x > (real)0.66;
+
+        // reduce the argument to [0, 0.66] using atan(x) = pi/2 - atan(1/x) and atan(x) = pi/4 + atan((x-1)/(x+1))
+        const Pack t            = Select(large, (real)-1 / x, Select(medium, (x - (real)1) / (x + (real)1), x));
+        const Pack offset       = Select(large, Constant(glm::half_pi<real>() + MOREBITS), 
+                                    Select(medium, Constant(glm::quarter_pi<real>() + (real)0.5 * MOREBITS), Constant(0)));
+
+        const Pack z            = t * t;
+        const Pack p            = ((((z * (real)-8.750608600031904122785E-1 - (real)1.615753718733365076637E1) * z 
+                                    - (real)7.500855792314704667340E1) * z - (real)1.228866684490136173410E2) * z 
+                                    - (real)6.485021904942025371773E1);
+        const Pack q            = (((((z + (real)2.485846490142306297962E1) * z + (real)1.650270098316988542046E2) * z 
+                                    + (real)4.328810604912902668951E2) * z + (real)4.853903996359136964868E2) * z 
+                                    + (real)1.945506571482613964425E2);
+        const Pack result       = offset + (t * z * p / q + t);
+        return Select(a < 0, -result, result);
+    }
+
+    Pack Atan2(const Pack& y, const Pack& x)
+    {
+        Pack result             = Atan(y / x) + Select(x < 0, Select(y < 0, Constant(-glm::pi<real>()), Constant(glm::pi<real>())), Constant(0));
+        return Select(x == 0 && y == 0, Constant(0), result);
+    }
+
+    Pack Asin(const Pack& a)
+    {
+        return Atan2(a, Sqrt(((real)1 - a) * (a + (real)1)));
+    }
+
+    Pack Acos(const Pack& a)
+    {
+        return Atan2(Sqrt(((real)1 - a) * (a + (real)1)), a);
+    }
+
+    PackVector PackHelpers::Normal(const PackVector& axis1, const PackVector& axis2)
+    {
+        PackVector result   = Cross(axis1, axis2);
+        // if front is 0 length, try to cross it with arbitrary vector (Z axis)
+        result              = Select(Length2(result) < EPSILON, Cross(axis1, PackVector::Broadcast({0, 0, 1})), result);
+        // well it is possible that Z is aligned with the front , then choose another arbitraty vector (Y)
+        result              = Select(Length2(result) < EPSILON, Cross(axis1, PackVector::Broadcast({0, 1, 0})), result);
+        result              = Normalize(result);
+#ifndef NDEBUG
+        PackMask degenerate = Length2(axis1) < EPSILON || Length2(axis2) < EPSILON;
+        result              = Select(degenerate, PackVector::Broadcast({0, 1, 0}), result);
+#endif
+        return result;
+    }
+
+    void PackHelpers::CalculateParameters(const PackVector& from, const PackVector& to, PackVector& axis, Pack& angle)
+    {
+        const PackVector normal     = Cross(from, to);
+        const Pack cosine           = Dot(from, to);
+        // if from and to vectors are colinear, the rotation is zero
+        const PackMask aligned      = Length2(normal) < EPSILON && cosine > (real)0;
+        // calculate the rotation axis between the from and to vectors
+        const PackVector rotationAxis = Normal(from, to);
+        // calculate angle around calculated axis
+        Pack rotationAngle          = Atan2(Sqrt(Length2(normal)), cosine);
+        rotationAngle               = Select(Dot(rotationAxis, normal) < (real)0, -rotationAngle, rotationAngle);
+
+        axis                        = Select(aligned, PackVector::Broadcast(Helpers::DefaultAxis()), rotationAxis);
+        angle                       = Select(aligned, Pack::Broadcast(0), rotationAngle);
+    }
+
+    Pack PackHelpers::TriangleAngle(const Pack& adjacent1, const Pack& adjacent2, const Pack& opposite)
+    {
+        const Pack zero             = Pack::Broadcast(0);
+        const Pack halfPerimeter    = (adjacent1 + adjacent2 + opposite) * (real)0.5;
+        const Pack numerator        = Max(halfPerimeter - adjacent1, zero) * Max(halfPerimeter - adjacent2, zero);
+        const Pack denominator      = halfPerimeter * Max(halfPerimeter - opposite, zero);
+        return Atan2(Sqrt(numerator), Sqrt(denominator)) * (real)2;
+    }
+
+    PackQuaternion PackHelpers::CalculateRotation(const PackVector& from, const PackVector& to)
+    {
+        PackVector axis;
+        Pack angle;
+        CalculateParameters(from, to, axis, angle);
+        return AngleAxis(angle, axis);
+    }
+
+    PackVector PackHelpers::ToEulerXZY(const PackQuaternion& q)
+    {
+        PackVector result;
+        // calculate X and Y angles, angle stays zero if both parameters are zero
+        Pack x              = (q.w * q.x + q.y * q.z) * (real)2;
+        Pack y              = q.w * q.w - q.x * q.x + q.y * q.y - q.z * q.z;
+        result.x            = Select(x * x + y * y < EPSILON, Pack::Broadcast(0), Atan2(x, y));
+
+        x                   = (q.w * q.y + q.x * q.z) * (real)2;
+        y                   = q.w * q.w + q.x * q.x - q.y * q.y - q.z * q.z;
+        result.y            = Select(x * x + y * y < EPSILON, Pack::Broadcast(0), Atan2(x, y));
+
+        // Y parameters are cos(z) scaled by sin(y) and cos(y), atan2 keeps the precision close to +-90 degrees
+        result.z            = Atan2((q.w * q.z - q.x * q.y) * (real)2, Sqrt(x * x + y * y));
+
+        return result;
+    }
+
+    PackQuaternion PackHelpers::FromEulerXZY(const PackVector& angles)
+    {
+        const PackVector half   = angles * (real)0.5;
+        PackVector s, c;
+        SinCos(half.x, s.x, c.x);
+        SinCos(half.y, s.y, c.y);
+        SinCos(half.z, s.z, c.z);
+        // Q = Qx * Qz * Qy
+        return {
+            (c.x * c.y * c.z) + (s.x * s.y * s.z),
+            (s.x * c.y * c.z) - (c.x * s.y * s.z),
+            (c.x * s.y * c.z) - (s.x * c.y * s.z),
+            (c.x * c.y * s.z) + (s.x * s.y * c.z)
+        };
+    }
+
+    PackQuaternion PackHelpers::ClampSwingTwist(const PackQuaternion& q, const ConstraintLimits& limits)
+    {
+        const Pack twistLength2 = q.w * q.w + q.y * q.y;
+        const PackMask hasTwist = twistLength2 > EPSILON;
+        const Pack inverse      = Select(hasTwist, (real)1 / Sqrt(twistLength2), Pack::Broadcast(0));
+        // twist with non negative W has the angle in the range of +-pi, the swing is not affected by the sign
+        const Pack tw           = Select(hasTwist, q.w * inverse, Pack::Broadcast(1));
+        const Pack ty           = q.y * inverse;
+        const Pack twistSign    = Select(tw < (real)0, Pack::Broadcast(-1), Pack::Broadcast(1));
+
+        PackQuaternion swing    = {Select(hasTwist, q.w * tw + q.y * ty, q.w), q.x * tw + q.z * ty, Pack::Broadcast(0), q.z * tw - q.x * ty};
+        PackQuaternion twist    = {tw * twistSign, Pack::Broadcast(0), ty * twistSign, Pack::Broadcast(0)};
+
+        const PackMask twistClamped = twist.y < limits.sinHalfTwistMin || twist.y > limits.sinHalfTwistMax;
+        twist.y                 = Clamp(twist.y, limits.sinHalfTwistMin, limits.sinHalfTwistMax);
+        twist.w                 = Select(twistClamped, Sqrt(Max((real)1 - twist.y * twist.y, Pack::Broadcast(0))), twist.w);
+
+        // the swing axis lies in XZ plane, it is kept and the angle is reduced to the limit
+        const PackMask swingClamped = Abs(swing.w) < limits.cosHalfSwing;
+        const Pack axisLength2  = swing.x * swing.x + swing.z * swing.z;
+        const Pack scale        = Select(axisLength2 > (real)0, limits.sinHalfSwing / Sqrt(axisLength2), Pack::Broadcast(0));
+        swing                   = Select(swingClamped,
+                                    PackQuaternion{Pack::Broadcast(limits.cosHalfSwing), swing.x * scale, swing.y, swing.z * scale},
+                                    swing);
+
+        return Select(twistClamped || swingClamped, swing * twist, q);
+    }
+
+    void PackHelpers::Normal(const ConstVectorSpan& axis1, const ConstVectorSpan& axis2, const VectorSpan& normals)
+    {
+        assert(axis1.size() == axis2.size() && axis1.size() == normals.size());
+        ForEachPack(normals.size(), [&](size_t offset, size_t count)
+        {
+            const Vector fill = Helpers::DefaultAxis();
+            normals.Store(offset, count, Normal(axis1.Load(offset, count, fill), axis2.Load(offset, count, fill)));
+        });
+    }
+
+    void PackHelpers::CalculateParameters(const ConstVectorSpan& from, const ConstVectorSpan& to, const VectorSpan& axes, std::span<real> angles)
+    {
+        assert(from.size() == to.size() && from.size() == axes.size() && from.size() == angles.size());
+        ForEachPack(axes.size(), [&](size_t offset, size_t count)
+        {
+            const Vector fill = Helpers::DefaultAxis();
+            PackVector axis;
+            Pack angle;
+            CalculateParameters(from.Load(offset, count, fill), to.Load(offset, count, fill), axis, angle);
+            axes.Store(offset, count, axis);
+            angle.Store(&angles[offset], count);
+        });
+    }
+
+    void PackHelpers::CalculateRotation(const ConstVectorSpan& from, const ConstVectorSpan& to, const QuaternionSpan& rotations)
+    {
+        assert(from.size() == to.size() && from.size() == rotations.size());
+        ForEachPack(rotations.size(), [&](size_t offset, size_t count)
+        {
+            const Vector fill = Helpers::DefaultAxis();
+            rotations.Store(offset, count, CalculateRotation(from.Load(offset, count, fill), to.Load(offset, count, fill)));
+        });
+    }
+
+    void PackHelpers::ToEulerXZY(const ConstQuaternionSpan& q, const VectorSpan& angles)
+    {
+        assert(q.size() == angles.size());
+        ForEachPack(angles.size(), [&](size_t offset, size_t count)
+        {
+            angles.Store(offset, count, ToEulerXZY(q.Load(offset, count)));
+        });
+    }
+
+    void PackHelpers::FromEulerXZY(const ConstVectorSpan& angles, const QuaternionSpan& q)
+    {
+        assert(q.size() == angles.size());
+        ForEachPack(q.size(), [&](size_t offset, size_t count)
+        {
+            q.Store(offset, count, FromEulerXZY(angles.Load(offset, count, {0, 0, 0})));
+        });
+    }
+
+    void PackHelpers::ClampSwingTwist(const ConstQuaternionSpan& q, const ConstraintLimits& limits, const QuaternionSpan& clamped)
+    {
+        assert(q.size() == clamped.size());
+        ForEachPack(q.size(), [&](size_t offset, size_t count)
+        {
+            clamped.Store(offset, count, ClampSwingTwist(q.Load(offset, count), limits));
+        });
+    }
+}
@@ -15,48 +15,41 @@
 namespace LightIK
 {
 
-Bone::Bone()
+Bone::Bone(BoneStorage& storage, size_t index)
+    : m_storage(&storage)
+    , m_index(index)
 {
-    m_initialRotation           = glm::identity<Quaternion>();
-    m_rotation                  = glm::identity<Quaternion>();
-    m_globalOrientation         = glm::identity<Quaternion>();
-}
-
-Bone::Bone(real length, const Quaternion& orientation)
-    : m_rotation(orientation)
-    , m_initialRotation(orientation)
-    , m_length(length, false)
-{
-    m_globalOrientation         = glm::identity<Quaternion>();
+    assert(m_index < m_storage->Size());
 }
 
 void Bone::SetRotation(const Quaternion& orientation)
 {
     // relative rotation according to the parent orientation
-    m_rotation                  = orientation;
+    m_storage->SetRotation(m_index, orientation);
 }
 
 void Bone::SetGlobalOrientation(const Quaternion& orientation)
 {
     // skeleton global orientation
-    m_globalOrientation         = orientation;
+    m_storage->globalOrientations[m_index]  = orientation;
 }
 
 void Bone::SetConstraints(Constraints && newConstraints)
 {
-    m_constraints               = std::move(newConstraints);
+    m_storage->SetConstraints(m_index, newConstraints);
 }
 
 Quaternion Bone::ApplyConstraint(const Quaternion& rotation) const
 {
-    Vector angles               = glm::clamp(Helpers::ToEulerXZY(rotation), m_constraints.minAngles, m_constraints.maxAngles);
-    return Helpers::FromEulerXZY(angles);
+    return m_storage->ApplyConstraint(m_index, rotation);
 }
 
 void Bone::Reset()
 { 
-    m_rotation                  = m_initialRotation;
-    m_globalOrientation         = glm::identity<Quaternion>();
+    m_storage->rotations[m_index]           = m_storage->initialRotations[m_index];
+    m_storage->globalOrientations[m_index]  = glm::identity<Quaternion>();
+    // global orientation is dropped, so the bone has to be recalculated in any case
+    ++m_storage->versions[m_index];
 }
 
 }
@@ -0,0 +1,190 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "bone_storage.h"
+#include "helpers.h"
+#include "profile_zone.h"
+
+#include <algorithm>
+
+namespace LightIK
+{
+
+void BoneStorage::Reserve(size_t capacity)
+{
+    positions.reserve(capacity);
+    rotations.reserve(capacity);
+    versions.reserve(capacity);
+    globalOrientations.reserve(capacity);
+    owners.reserve(capacity);
+#ifdef LIGHT_IK_STATISTICS
+    clamps.reserve(capacity);
+#endif
+
+    BoneParameters& parameters = GetParameters();
+    parameters.initialRotations.reserve(capacity);
+    parameters.lengths.reserve(capacity);
+    parameters.constraints.reserve(capacity);
+    parameters.limits.reserve(capacity);
+    BindParameters();
+}
+
+void BoneStorage::Instantiate(const BoneStorage& rig, size_t capacity)
+{
+    m_parameters        = rig.m_parameters;
+    BindParameters();
+
+    positions.reserve(capacity);
+    rotations.reserve(capacity);
+    versions.reserve(capacity);
+    globalOrientations.reserve(capacity);
+    owners.reserve(capacity);
+    // the pose of the rig is copied as is, so the chains of the instance start from the calculated state
+    positions.assign(rig.positions.begin(), rig.positions.end());
+    rotations.assign(rig.rotations.begin(), rig.rotations.end());
+    versions.assign(rig.versions.begin(), rig.versions.end());
+    globalOrientations.assign(rig.globalOrientations.begin(), rig.globalOrientations.end());
+    // the solvers of the instance take the bones when they are created
+    owners.assign(rig.Size(), nullptr);
+#ifdef LIGHT_IK_STATISTICS
+    clamps.reserve(capacity);
+    clamps.assign(rig.Size(), 0);
+#endif
+}
+
+BoneParameters& BoneStorage::GetParameters()
+{
+    // nobody else can take the reference to the parameters owned only by this storage
+    if (m_parameters.use_count() > 1)
+    {
+        m_parameters    = std::make_shared<BoneParameters>(*m_parameters);
+    }
+    return *m_parameters;
+}
+
+void BoneStorage::BindParameters()
+{
+    initialRotations    = m_parameters->initialRotations;
+    lengths             = m_parameters->lengths;
+    constraints         = m_parameters->constraints;
+    limits              = m_parameters->limits;
+}
+
+size_t BoneStorage::Add(real length, const Quaternion& orientation)
+{
+    size_t slot = Size();
+    positions.emplace_back(0, 0, 0);
+    rotations.emplace_back(orientation);
+    versions.emplace_back(0);
+    globalOrientations.emplace_back(glm::identity<Quaternion>());
+    owners.emplace_back(nullptr);
+#ifdef LIGHT_IK_STATISTICS
+    clamps.emplace_back(0);
+#endif
+
+    BoneParameters& parameters = GetParameters();
+    parameters.initialRotations.emplace_back(orientation);
+    parameters.lengths.emplace_back(length, false);
+    parameters.constraints.emplace_back();
+    parameters.limits.emplace_back();
+    BindParameters();
+    return slot;
+}
+
+void BoneStorage::SetConstraints(size_t slot, const Constraints& constraint)
+{
+    constexpr real pi           = glm::pi<real>();
+    BoneParameters& parameters  = GetParameters();
+    BindParameters();
+    parameters.constraints[slot] = constraint;
+
+    ConstraintLimits& limit     = parameters.limits[slot];
+    limit                       = ConstraintLimits{};
+    if (constraint.type == ConstraintType::swingTwist)
+    {
+        const real swing        = glm::clamp(constraint.swingLimit, (real)0, pi);
+        const real twistMin     = glm::clamp(constraint.twistMin, -pi, pi);
+        const real twistMax     = glm::clamp(constraint.twistMax, twistMin, pi);
+        if (swing < pi || twistMin > -pi || twistMax < pi)
+        {
+            limit.kind              = ConstraintLimits::Kind::swingTwist;
+            limit.cosHalfSwing      = glm::cos(swing * (real)0.5);
+            limit.sinHalfSwing      = glm::sin(swing * (real)0.5);
+            limit.sinHalfTwistMin   = glm::sin(twistMin * (real)0.5);
+            limit.sinHalfTwistMax   = glm::sin(twistMax * (real)0.5);
+        }
+    }
+    else
+    {
+        // X and Y angles are extracted in the range of +-pi, Z angle in the range of +-pi/2
+        const Vector range {pi, pi, pi * (real)0.5};
+        for (int i = 0; i < 3; ++i)
+        {
+            if (constraint.minAngles[i] > -range[i] || constraint.maxAngles[i] < range[i])
+            {
+                limit.kind          = ConstraintLimits::Kind::euler;
+            }
+        }
+    }
+}
+
+Quaternion BoneStorage::ApplyConstraint(size_t slot, const Quaternion& rotation) const
+{
+    const ConstraintLimits& limit = limits[slot];
+    if (limit.kind == ConstraintLimits::Kind::free)
+    {
+        return rotation;
+    }
+
+    ProfileZone zone(ProfileScope::constraint, static_cast<uint32_t>(slot));
+    if (limit.kind == ConstraintLimits::Kind::swingTwist)
+    {
+        Quaternion result       = Helpers::ClampSwingTwist(rotation, limit);
+#ifdef LIGHT_IK_STATISTICS
+        clamps[slot]            += result != rotation;
+#endif
+        return result;
+    }
+    const Vector angles         = Helpers::ToEulerXZY(rotation);
+    const Vector clamped        = glm::clamp(angles, constraints[slot].minAngles, constraints[slot].maxAngles);
+#ifdef LIGHT_IK_STATISTICS
+    clamps[slot]                += clamped != angles;
+#endif
+    return Helpers::FromEulerXZY(clamped);
+}
+
+void BoneStorage::ResetPose()
+{
+    std::copy(initialRotations.begin(), initialRotations.end(), rotations.begin());
+    for (uint32_t& version : versions)
+    {
+        ++version;
+    }
+    std::fill(globalOrientations.begin(), globalOrientations.end(), glm::identity<Quaternion>());
+}
+
+void BoneStorage::Clear()
+{
+    positions.clear();
+    rotations.clear();
+    versions.clear();
+    globalOrientations.clear();
+    owners.clear();
+#ifdef LIGHT_IK_STATISTICS
+    clamps.clear();
+#endif
+
+    // the shared parameters stay with the other storages
+    if (m_parameters.use_count() > 1)
+    {
+        m_parameters = std::make_shared<BoneParameters>();
+    }
+    m_parameters->initialRotations.clear();
+    m_parameters->lengths.clear();
+    m_parameters->constraints.clear();
+    m_parameters->limits.clear();
+    BindParameters();
+}
+
+}
@@ -10,6 +10,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <vector>
 
 namespace LightIK
 {
@@ -53,8 +55,14 @@ namespace LightIK
         }
         // calculate the rotation axis between the from and to vectors
         Vector rotationAxis = Helpers::Normal(from, to);
-        // calculate angle around calculated axis
-        real rotationAngle  = glm::orientedAngle(from, to, rotationAxis);
+        // calculate angle around calculated axis, atan2 keeps the precision for the small angles where acos of
+        // the dot product loses half of the mantissa (noticeable in single precision)
+        Vector normal       = glm::cross(from, to);
+        real rotationAngle  = Math::Atan2(glm::length(normal), glm::dot(from, to));
+        if (glm::dot(rotationAxis, normal) < 0)
+        {
+            rotationAngle   = -rotationAngle;
+        }
         // form the quaternion to reflect the rotation
         return {rotationAxis, rotationAngle};
     }
@@ -62,7 +70,15 @@ namespace LightIK
     Quaternion Helpers::CalculateRotation(const Vector& from, const Vector& to)
     {
         RotationParameters params = CalculateParameters(from, to);
-        return glm::angleAxis(params.angle, params.axis);
+        return Math::AngleAxis(params.angle, params.axis);
+    }
+
+    real Helpers::TriangleAngle(real adjacent1, real adjacent2, real opposite)
+    {
+        real halfPerimeter  = (adjacent1 + adjacent2 + opposite) / 2;
+        real numerator      = std::max(halfPerimeter - adjacent1, (real)0) * std::max(halfPerimeter - adjacent2, (real)0);
+        real denominator    = halfPerimeter * std::max(halfPerimeter - opposite, (real)0);
+        return 2 * Math::Atan2(glm::sqrt(numerator), glm::sqrt(denominator));
     }
 
     Vector Helpers::ToLocal(const CoordinateSystem& localSystem, const Vector& vector)
@@ -113,24 +129,27 @@ namespace LightIK
 
     Vector Helpers::ToEulerXZY(const Quaternion& q)
     { 
-        Vector result = {0, 0, glm::asin(glm::clamp((real)(2) * (q.w * q.z - q.x * q.y), (real)-1, (real)1))};
+        Vector result = {0, 0, 0};
 
         // calculate X and Y angles
         Vector2 params = {
             (real)2 * (q.w * q.x + q.y * q.z),
             q.w * q.w - q.x * q.x + q.y * q.y - q.z * q.z};
-        if (!glm::all(glm::equal(params, Vector2(0,0), EPSILON)))
+        if (glm::length2(params) >= EPSILON)
         {
-            result.x = glm::atan2(params.x, params.y);
+            result.x = Math::Atan2(params.x, params.y);
         }
 
         params.x = (real)2 * (q.w * q.y + q.x * q.z);
         params.y = q.w * q.w + q.x * q.x - q.y * q.y - q.z * q.z;
-        if (!glm::all(glm::equal(params, Vector2(0,0), EPSILON)))
+        if (glm::length2(params) >= EPSILON)
         {
-            result.y = glm::atan2(params.x, params.y);
+            result.y = Math::Atan2(params.x, params.y);
         }
 
+        // Y parameters are cos(z) scaled by sin(y) and cos(y), atan2 keeps the precision close to +-90 degrees where asin fails
+        result.z = Math::Atan2((real)2 * (q.w * q.z - q.x * q.y), glm::length(params));
+
         return result;
     }
 
@@ -144,8 +163,11 @@ namespace LightIK
 
     Quaternion Helpers::FromEulerXZY(const Vector& angles)
     {
-        const Vector s = glm::sin(angles * (real)0.5);
-        const Vector c = glm::cos(angles * (real)0.5);
+        Vector s, c;
+        for (int i = 0; i < 3; ++i)
+        {
+            Math::SinCos(angles[i] * (real)0.5, s[i], c[i]);
+        }
         // calculate multiplication of 3 quaternions for each euler angle in sequence YXZ
         // Q = Qx * Qz * Qy
         return Quaternion{
@@ -156,4 +178,69 @@ namespace LightIK
         };
     }
 
+    // Q = swing * twist, the twist is the projection of Q on the rotations around Y axis: (w, 0, y, 0).
+    // The swing = Q * conjugate(twist) has no Y component, its W is the cosine of the half swing angle.
+    Quaternion Helpers::ClampSwingTwist(const Quaternion& q, const ConstraintLimits& limits)
+    {
+        Quaternion twist        = glm::identity<Quaternion>();
+        Quaternion swing        = q;
+        const real twistLength2 = q.w * q.w + q.y * q.y;
+        if (twistLength2 > EPSILON)
+        {
+            // swing to the opposite direction leaves the twist undefined, it is considered zero
+            const real inverse  = (real)1 / glm::sqrt(twistLength2);
+            const real tw       = q.w * inverse;
+            const real ty       = q.y * inverse;
+            swing               = Quaternion{q.w * tw + q.y * ty, q.x * tw + q.z * ty, 0, q.z * tw - q.x * ty};
+            // twist with non negative W has the angle in the range of +-pi
+            twist               = tw < 0 ? Quaternion{-tw, 0, -ty, 0} : Quaternion{tw, 0, ty, 0};
+        }
+
+        bool clamped            = false;
+        if (twist.y < limits.sinHalfTwistMin || twist.y > limits.sinHalfTwistMax)
+        {
+            twist.y             = glm::clamp(twist.y, limits.sinHalfTwistMin, limits.sinHalfTwistMax);
+            twist.w             = glm::sqrt(glm::max((real)1 - twist.y * twist.y, (real)0));
+            clamped             = true;
+        }
+        if (glm::abs(swing.w) < limits.cosHalfSwing)
+        {
+            // the swing axis lies in XZ plane, it is kept and the angle is reduced to the limit
+            const real axisLength2 = swing.x * swing.x + swing.z * swing.z;
+            const real scale    = axisLength2 > 0 ? limits.sinHalfSwing / glm::sqrt(axisLength2) : 0;
+            swing               = Quaternion{limits.cosHalfSwing, swing.x * scale, 0, swing.z * scale};
+            clamped             = true;
+        }
+        return clamped ? swing * twist : q;
+    }
+
+    bool Helpers::ValidateParents(std::span<const int> parents)
+    {
+        enum State : uint8_t { unknown, visiting, valid };
+        std::vector<State> states(parents.size(), unknown);
+        for (size_t i = 0; i < parents.size(); ++i)
+        {
+            int bone = (int)i;
+            while (bone != -1 && states[bone] == unknown)
+            {
+                states[bone] = visiting;
+                bone = parents[bone];
+                if (bone < -1 || bone >= (int)parents.size())
+                {
+                    return false;
+                }
+            }
+            // the walk came back to the bone of the current path
+            if (bone != -1 && states[bone] == visiting)
+            {
+                return false;
+            }
+            for (bone = (int)i; bone != -1 && states[bone] == visiting; bone = parents[bone])
+            {
+                states[bone] = valid;
+            }
+        }
+        return true;
+    }
+
 }
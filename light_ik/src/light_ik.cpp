@@ -4,13 +4,18 @@
 
 #include "skeleton.h"
 #include "helpers.h"
+#include "thread_pool.h"
 #include "light_ik/light_ik.h"
+#include "light_ik/recorder.h"
+#include "light_ik/rig_file.h"
+#include "light_ik/rig.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/vector_angle.hpp"
 #include "glm/gtx/rotate_vector.hpp"
 
 #include <iostream>
+#include <algorithm>
 
 namespace LightIK
 {
@@ -21,46 +26,128 @@ LightIK::LightIK(size_t bonesCount)
     m_relativeRotations.resize(bonesCount);
 }
 
+LightIK::LightIK(const Rig& rig)
+    : m_skeleton(std::make_unique<Skeleton>(Skeleton::InstanceTag{}, *rig.m_prototype->m_skeleton))
+{
+    const LightIK& prototype = *rig.m_prototype;
+    // the storage slots are the same as in the rig
+    m_poseBones = prototype.m_poseBones;
+    m_relativeRotations.resize(prototype.m_relativeRotations.size(), nullptr);
+    const std::vector<BonePtr>& bones = m_skeleton->GetBones();
+    for (size_t boneIndex = 0; boneIndex < bones.size(); ++boneIndex)
+    {
+        if (bones[boneIndex] && prototype.m_relativeRotations[boneIndex])
+        {
+            m_relativeRotations[boneIndex] = &bones[boneIndex]->GetRotation();
+        }
+    }
+
+    std::vector<Target*> targets(prototype.m_solvers.size(), nullptr);
+    m_rigTargets.resize(prototype.m_rigTargets.size(), nullptr);
+    for (size_t chainIndex = 0; chainIndex < targets.size(); ++chainIndex)
+    {
+        if (rig.m_targetBones[chainIndex] >= 0)
+        {
+            TargetBone& target          = CreateInternalTarget();
+            target.AssignBone(rig.m_targetBones[chainIndex]);
+            targets[chainIndex]         = &target;
+        }
+        else if (const TargetPosition* rigTarget = prototype.GetRigTarget(chainIndex))
+        {
+            TargetPosition& target      = CreateTarget();
+            target.SetPosition(rigTarget->GetPosition());
+            m_rigTargets[chainIndex]    = &target;
+            targets[chainIndex]         = &target;
+        }
+    }
+
+    m_skeleton->InstantiateChains(*prototype.m_skeleton, targets);
+    m_solvers.reserve(targets.size());
+    for (size_t chainIndex = 0; chainIndex < targets.size(); ++chainIndex)
+    {
+        m_solvers.emplace_back(m_skeleton->GetSolver(chainIndex));
+    }
+    m_skeleton->Finalize();
+}
+
 LightIK::~LightIK()
 {
 }
 
 void LightIK::ResetPose()
 {
+    if (m_recorder)
+    {
+        m_recorder->RecordResetPose();
+    }
     m_skeleton->ResetPose();
 }
 
 void LightIK::Reset()
 {
+    if (m_recorder)
+    {
+        m_recorder->RecordReset();
+    }
     m_solvers.clear();
+    // targets are placed into the skeleton arena, they are destroyed before the arena is released
     m_targets.clear();
     m_skeleton->ResetIK();
+    std::fill(m_relativeRotations.begin(), m_relativeRotations.end(), nullptr);
+    m_poseBones.clear();
+    m_rigTargets.clear();
 }
 
-size_t LightIK::CreateIKChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, Target& target)
+void LightIK::RegisterBones(const std::vector<BoneDesc>& rootChainDesc)
 {
-    size_t index = m_solvers.size();
-    m_solvers.emplace_back(m_skeleton->AddSolver(rootChainDesc, chainStartIndex, target));
     for (const BoneDesc& desc : rootChainDesc)
     {
-        Bone* bone = m_skeleton->GetBones()[desc.boneIndex].get();
+        Bone* bone = m_skeleton->GetBones()[desc.boneIndex];
         m_relativeRotations[desc.boneIndex] = bone ? &bone->GetRotation() : nullptr;
+        if (!bone)
+        {
+            continue;
+        }
+        // chains share the root part, each bone is listed once
+        auto it = std::lower_bound(m_poseBones.begin(), m_poseBones.end(), (size_t)desc.boneIndex,
+            [](const PoseBone& poseBone, size_t boneIndex) { return poseBone.boneIndex < boneIndex; });
+        if (it == m_poseBones.end() || it->boneIndex != (size_t)desc.boneIndex)
+        {
+            m_poseBones.insert(it, PoseBone{(size_t)desc.boneIndex, bone->GetIndex()});
+        }
+    }
+}
+
+size_t LightIK::CreateIKChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, Target& target, SolverType solverType)
+{
+    size_t index = m_solvers.size();
+    m_solvers.emplace_back(m_skeleton->AddSolver(rootChainDesc, chainStartIndex, target, solverType));
+    RegisterBones(rootChainDesc);
+    if (m_recorder)
+    {
+        RecordChain(rootChainDesc, chainStartIndex, target, solverType);
     }
     return index;
 }
 
-size_t LightIK::CreateIKLink(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, int targetBoneIndex)
+size_t LightIK::CreateIKLink(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, int targetBoneIndex, SolverType solverType)
 {
+    // the target bone has to be registered by the previous chains, otherwise the target has no position
+    if (targetBoneIndex < 0 || (size_t)targetBoneIndex >= m_relativeRotations.size() ||
+        !m_skeleton->GetBones()[targetBoneIndex])
+    {
+        return SIZE_MAX;
+    }
     size_t index = m_solvers.size();
-    std::unique_ptr<TargetBone> bone = std::make_unique<TargetBone>(*m_skeleton);
+    ArenaPtr<TargetBone> bone = m_skeleton->GetArena().Make<TargetBone>(*m_skeleton);
     bone->AssignBone(targetBoneIndex);
-    m_solvers.emplace_back(m_skeleton->AddSolver(rootChainDesc, chainStartIndex, *bone));
+    m_solvers.emplace_back(m_skeleton->AddSolver(rootChainDesc, chainStartIndex, *bone, solverType));
     m_targets.emplace_back(std::move(bone));
 
-    for (const BoneDesc& desc : rootChainDesc)
+    RegisterBones(rootChainDesc);
+    if (m_recorder)
     {
-        Bone* bone = m_skeleton->GetBones()[desc.boneIndex].get();
-        m_relativeRotations[desc.boneIndex] = bone ? &bone->GetRotation() : nullptr;
+        m_recorder->RecordLink(rootChainDesc, chainStartIndex, targetBoneIndex, solverType);
     }
     return index;
 }
@@ -71,23 +158,280 @@ void LightIK::CreatePassiveChain(const std::vector<BoneDesc>& rootChainDesc)
     if (passiveChain)
     {
         m_solvers.emplace_back(*passiveChain);
+        RegisterBones(rootChainDesc);
+    }
+    if (m_recorder)
+    {
+        m_recorder->RecordPassiveChain(rootChainDesc);
+    }
+}
+
+bool LightIK::SetHierarchy(std::span<const int> parents, std::span<const real> lengths, std::span<const Quaternion> rotations)
+{
+    if (parents.size() != lengths.size() || parents.size() != rotations.size() || parents.size() > m_relativeRotations.size() ||
+        !Helpers::ValidateParents(parents))
+    {
+        return false;
+    }
+    m_parents.assign(parents.begin(), parents.end());
+    m_hierarchy.resize(parents.size());
+    for (size_t bone = 0; bone < parents.size(); ++bone)
+    {
+        m_hierarchy[bone] = BoneDesc{rotations[bone], lengths[bone], (int)bone};
+    }
+    return true;
+}
 
-        for (const BoneDesc& desc : rootChainDesc)
+bool LightIK::CollectRootChain(int chainStartIndex, int tipBoneIndex)
+{
+    const int count = (int)m_hierarchy.size();
+    if (tipBoneIndex < 0 || tipBoneIndex >= count || chainStartIndex < 0 || chainStartIndex >= count)
+    {
+        return false;
+    }
+    const std::vector<BonePtr>& bones = m_skeleton->GetBones();
+
+    // the bones of the chain are collected from the tip to the start bone, above it the walk stops at the first
+    //  registered bone, so the bones shared with the previous chains are not visited again
+    m_rootChain.clear();
+    bool inChain = true;
+    for (int bone = tipBoneIndex; bone != -1; bone = m_parents[bone])
+    {
+        m_rootChain.emplace_back(m_hierarchy[bone]);
+        if (!inChain && bones[bone])
+        {
+            break;
+        }
+        inChain = inChain && bone != chainStartIndex;
+    }
+    // start bone is the tip or its ancestor
+    if (inChain)
+    {
+        return false;
+    }
+    std::reverse(m_rootChain.begin(), m_rootChain.end());
+    return true;
+}
+
+size_t LightIK::CreateIKChain(int chainStartIndex, int tipBoneIndex, Target& target, SolverType solverType)
+{
+    if (!CollectRootChain(chainStartIndex, tipBoneIndex))
+    {
+        return SIZE_MAX;
+    }
+    return CreateIKChain(m_rootChain, chainStartIndex, target, solverType);
+}
+
+size_t LightIK::CreateIKLink(int chainStartIndex, int tipBoneIndex, int targetBoneIndex, SolverType solverType)
+{
+    if (!CollectRootChain(chainStartIndex, tipBoneIndex))
+    {
+        return SIZE_MAX;
+    }
+    return CreateIKLink(m_rootChain, chainStartIndex, targetBoneIndex, solverType);
+}
+
+bool LightIK::CreatePassiveChain(int tipBoneIndex)
+{
+    // passive chain has no IK part, the walk stops at the first registered bone above the tip
+    if (!CollectRootChain(tipBoneIndex, tipBoneIndex))
+    {
+        return false;
+    }
+    // the chain is not created if all its bones are registered already
+    const size_t count = m_solvers.size();
+    CreatePassiveChain(m_rootChain);
+    return m_solvers.size() != count;
+}
+
+bool LightIK::CreateRig(const RigView& rig)
+{
+    std::span<const RigBone> bones = rig.GetBones();
+    if (!rig.IsValid() || bones.size() > m_relativeRotations.size())
+    {
+        return false;
+    }
+
+    // the rig is validated by the view, its bones become the hierarchy as they are
+    m_parents.resize(bones.size());
+    m_hierarchy.resize(bones.size());
+    for (size_t bone = 0; bone < bones.size(); ++bone)
+    {
+        m_parents[bone]     = bones[bone].parent;
+        m_hierarchy[bone]   = BoneDesc{bones[bone].rotation, bones[bone].length, (int)bone};
+    }
+
+    for (const RigChain& chain : rig.GetChains())
+    {
+        const SolverType solverType = (SolverType)chain.solverType;
+        bool created                = false;
+        switch (chain.type)
         {
-            Bone* bone = m_skeleton->GetBones()[desc.boneIndex].get();
-            m_relativeRotations[desc.boneIndex] = bone ? &bone->GetRotation() : nullptr;
+        case RigChainType::position:
+        {
+            TargetPosition& target  = CreateTarget();
+            const size_t index      = CreateIKChain(chain.start, chain.tip, target, solverType);
+            if (index != SIZE_MAX)
+            {
+                m_rigTargets.resize(index + 1, nullptr);
+                m_rigTargets[index] = &target;
+                created             = true;
+            }
+            break;
+        }
+        case RigChainType::bone:
+            created                 = CreateIKLink(chain.start, chain.tip, chain.targetBone, solverType) != SIZE_MAX;
+            break;
+        case RigChainType::passive:
+            created                 = CreatePassiveChain(chain.tip);
+            break;
+        }
+        // the chains are created in the order of the rig, the rig is dropped as a whole
+        if (!created)
+        {
+            Reset();
+            return false;
         }
     }
+
+    // constraints are assigned to the bones of the created chains
+    std::span<const Constraints> constraints = rig.GetConstraints();
+    for (size_t bone = 0; bone < constraints.size(); ++bone)
+    {
+        if (bones[bone].constrained)
+        {
+            SetConstraint(bone, Constraints(constraints[bone]));
+        }
+    }
+    return true;
+}
+
+TargetPosition* LightIK::GetRigTarget(size_t chainIndex) const
+{
+    return chainIndex < m_rigTargets.size() ? m_rigTargets[chainIndex] : nullptr;
 }
 
 void LightIK::SetConstraint(size_t boneIndex, Constraints && constraint)
 {
+    if (m_recorder)
+    {
+        m_recorder->RecordConstraint(boneIndex, constraint);
+    }
     m_skeleton->SetConstraint(boneIndex, std::move(constraint));
 }
 
+void LightIK::SetConvergence(size_t chainIndex, const Convergence& convergence)
+{
+    assert(chainIndex < m_solvers.size());
+    if (m_recorder)
+    {
+        m_recorder->RecordConvergence(chainIndex, convergence);
+    }
+    m_solvers[chainIndex].get().SetConvergence(convergence);
+}
+
+StopReason LightIK::GetStopReason(size_t chainIndex) const
+{
+    assert(chainIndex < m_solvers.size());
+    return m_skeleton->GetStopReason(m_solvers[chainIndex]);
+}
+
+void LightIK::EnableStatistics(bool enable)
+{
+    m_skeleton->EnableStatistics(enable);
+}
+
+void LightIK::ResetStatistics()
+{
+    m_skeleton->ResetStatistics();
+}
+
+const ChainStatistics& LightIK::GetChainStatistics(size_t chainIndex) const
+{
+    assert(chainIndex < m_solvers.size());
+    return m_skeleton->GetStatistics(m_solvers[chainIndex]);
+}
+
+const Statistics& LightIK::GetStatistics() const
+{
+    return m_skeleton->GetStatistics();
+}
+
+bool LightIK::CreateEffectorGroup(const std::vector<size_t>& chainIndices, real damping)
+{
+    std::vector<SolverRef> solvers;
+    for (size_t chainIndex : chainIndices)
+    {
+        assert(chainIndex < m_solvers.size());
+        solvers.emplace_back(m_solvers[chainIndex]);
+    }
+    if (m_recorder)
+    {
+        m_recorder->RecordEffectorGroup(chainIndices, damping);
+    }
+    return m_skeleton->AddEffectorGroup(solvers, damping);
+}
+
+bool LightIK::SetPole(size_t chainIndex, const std::optional<Vector>& pole)
+{
+    assert(chainIndex < m_solvers.size());
+    if (m_recorder)
+    {
+        m_recorder->RecordPole(chainIndex, pole);
+    }
+    return m_skeleton->SetPole(m_solvers[chainIndex], pole);
+}
+
+std::shared_ptr<ThreadPool> LightIK::CreateThreadPool(size_t threadsCount)
+{
+    return std::make_shared<ThreadPool>(threadsCount);
+}
+
+void LightIK::SetThreadPool(std::shared_ptr<ThreadPool> pool)
+{
+    m_threadPool = std::move(pool);
+    m_skeleton->SetThreadPool(m_threadPool.get());
+}
+
+void LightIK::Finalize()
+{
+    m_skeleton->Finalize();
+}
+
+void LightIK::SetRecorder(Recorder* recorder)
+{
+    m_recorder = recorder;
+    if (m_recorder)
+    {
+        m_recorder->RecordStart(m_relativeRotations.size());
+    }
+}
+
+void LightIK::RecordChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, const Target& target,
+    SolverType solverType)
+{
+    const Bone* targetBone = target.GetBone();
+    if (!targetBone)
+    {
+        m_recorder->RecordChain(rootChainDesc, chainStartIndex, m_solvers.size() - 1, solverType);
+        return;
+    }
+    // the chain follows the bone, it is replayed as the link to the same bone
+    const std::vector<BonePtr>& bones = m_skeleton->GetBones();
+    const size_t targetBoneIndex = std::find(bones.begin(), bones.end(), targetBone) - bones.begin();
+    m_recorder->RecordLink(rootChainDesc, chainStartIndex, (int)targetBoneIndex, solverType);
+}
+
 size_t LightIK::Update(size_t iterations)
 {
-    return m_skeleton->Update(iterations);
+    if (!m_recorder)
+    {
+        return m_skeleton->Update(iterations);
+    }
+    m_recorder->RecordUpdate(*this, iterations);
+    const size_t result = m_skeleton->Update(iterations);
+    m_recorder->RecordResult(*this, result);
+    return result;
 }
 
 const std::vector<const Quaternion*> &LightIK::GetDeltaRotations()
@@ -95,6 +439,79 @@ const std::vector<const Quaternion*> &LightIK::GetDeltaRotations()
     return m_relativeRotations;
 }
 
+template <typename T>
+size_t LightIK::WritePoseImpl(const PoseBuffers<T>& buffers)
+{
+    using OutQuaternion = glm::qua<T, glm::highp>;
+    using OutVector     = glm::vec<3, T, glm::highp>;
+
+    if (!buffers.positions.empty() || !buffers.orientations.empty())
+    {
+        // the last iteration changes only the rotations, the front kinematics skips the unchanged bones
+        m_skeleton->FinalizeChains();
+    }
+    const BoneStorage& storage = m_skeleton->GetStorage();
+    // each channel is a separate pass, so every loop reads one storage array and writes one buffer
+    if (!buffers.rotations.empty())
+    {
+        assert(m_poseBones.empty() || m_poseBones.back().boneIndex < buffers.rotations.size());
+        for (const PoseBone& bone : m_poseBones)
+        {
+            buffers.rotations[bone.boneIndex]       = OutQuaternion(storage.rotations[bone.slot]);
+        }
+    }
+    if (!buffers.positions.empty())
+    {
+        assert(m_poseBones.empty() || m_poseBones.back().boneIndex < buffers.positions.size());
+        for (const PoseBone& bone : m_poseBones)
+        {
+            buffers.positions[bone.boneIndex]       = OutVector(storage.positions[bone.slot]);
+        }
+    }
+    if (!buffers.orientations.empty())
+    {
+        assert(m_poseBones.empty() || m_poseBones.back().boneIndex < buffers.orientations.size());
+        for (const PoseBone& bone : m_poseBones)
+        {
+            buffers.orientations[bone.boneIndex]    = OutQuaternion(storage.globalOrientations[bone.slot]);
+        }
+    }
+    return m_poseBones.size();
+}
+
+size_t LightIK::WriteModelMatrices(std::span<BoneMatrix> matrices)
+{
+    assert(m_poseBones.empty() || m_poseBones.back().boneIndex < matrices.size());
+    // the same as for the pose, the unchanged chains are skipped by the incremental front kinematics
+    m_skeleton->FinalizeChains();
+
+    const BoneStorage& storage = m_skeleton->GetStorage();
+    for (const PoseBone& bone : m_poseBones)
+    {
+        const Matrix3 rotation  = glm::mat3_cast(storage.globalOrientations[bone.slot]);
+        const Vector& position  = storage.positions[bone.slot];
+        BoneMatrix& matrix      = matrices[bone.boneIndex];
+        for (int row = 0; row < 3; ++row)
+        {
+            matrix.rows[row][0] = (float)rotation[0][row];
+            matrix.rows[row][1] = (float)rotation[1][row];
+            matrix.rows[row][2] = (float)rotation[2][row];
+            matrix.rows[row][3] = (float)position[row];
+        }
+    }
+    return m_poseBones.size();
+}
+
+size_t LightIK::WritePose(const PoseBuffers<float>& buffers)
+{
+    return WritePoseImpl(buffers);
+}
+
+size_t LightIK::WritePose(const PoseBuffers<double>& buffers)
+{
+    return WritePoseImpl(buffers);
+}
+
 const Vector& LightIK::GetTargetPosition(size_t chainIndex) const
 {
     assert(m_solvers.size() > chainIndex);
@@ -103,7 +520,7 @@ const Vector& LightIK::GetTargetPosition(size_t chainIndex) const
 
 TargetBone& LightIK::CreateInternalTarget()
 {
-    auto target = std::make_unique<TargetBone>(*m_skeleton);
+    auto target = m_skeleton->GetArena().Make<TargetBone>(*m_skeleton);
     TargetBone& ref = *target;
     m_targets.emplace_back(std::move(target));
     return ref;
@@ -111,7 +528,7 @@ TargetBone& LightIK::CreateInternalTarget()
 
 TargetPosition& LightIK::CreateTarget()
 {
-    auto target = std::make_unique<TargetPosition>();
+    auto target = m_skeleton->GetArena().Make<TargetPosition>();
     TargetPosition& ref = *target;
     m_targets.emplace_back(std::move(target));
     return ref;
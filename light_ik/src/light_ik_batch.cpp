@@ -0,0 +1,226 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "light_ik/light_ik_batch.h"
+#include "skeleton.h"
+#include "solver_batch.h"
+
+namespace LightIK
+{
+
+// Chain of the batch, holds the chain targets and tips for each block of instances
+struct LightIKBatch::Chain
+{
+    SolverBatch             solver;
+    // Solver of the rig, tracks dependencies of the chain
+    const SolverBase&       rigSolver;
+    std::vector<PackVector> targets;
+    std::vector<PackVector> tips;
+};
+
+LightIKBatch::LightIKBatch(size_t bonesCount, size_t instancesCount)
+    : m_instancesCount(instancesCount)
+    , m_blocksCount((instancesCount + BatchLanes - 1) / BatchLanes)
+    , m_rig(std::make_unique<Skeleton>(bonesCount))
+{
+}
+
+LightIKBatch::~LightIKBatch()
+{
+}
+
+void LightIKBatch::ResetPose()
+{
+    m_rig->ResetPose();
+    InitializePose();
+}
+
+size_t LightIKBatch::CreateIKChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex)
+{
+    size_t index = m_chains.size();
+    SolverBase& rigSolver = m_rig->AddSolver(rootChainDesc, chainStartIndex, m_rigTarget);
+
+    std::vector<size_t> rootChain;
+    for (const Bone& bone : m_rig->GetRootChain(rigSolver))
+    {
+        rootChain.emplace_back(bone.GetIndex());
+    }
+
+    m_chains.emplace_back(std::make_unique<Chain>(Chain{
+        SolverBatch(m_rig->GetStorage(), std::move(rootChain), m_rig->GetBaseBone(rigSolver), rigSolver.GetChainSize()),
+        rigSolver,
+        std::vector<PackVector>(m_blocksCount, PackVector::Broadcast({0, 0, 0})),
+        std::vector<PackVector>(m_blocksCount, PackVector::Broadcast(rigSolver.GetTipPosition()))
+    }));
+    m_poseDirty = true;
+    return index;
+}
+
+void LightIKBatch::CreatePassiveChain(const std::vector<BoneDesc>& rootChainDesc)
+{
+    SolverBase* rigSolver = m_rig->AddChain(rootChainDesc);
+    if (!rigSolver)
+    {
+        return;
+    }
+    
+    std::vector<size_t> rootChain;
+    for (const Bone& bone : m_rig->GetRootChain(*rigSolver))
+    {
+        rootChain.emplace_back(bone.GetIndex());
+    }
+
+    m_chains.emplace_back(std::make_unique<Chain>(Chain{
+        SolverBatch(m_rig->GetStorage(), std::move(rootChain), m_rig->GetBaseBone(*rigSolver), 0),
+        *rigSolver,
+        std::vector<PackVector>(m_blocksCount, PackVector::Broadcast({0, 0, 0})),
+        std::vector<PackVector>(m_blocksCount, PackVector::Broadcast({0, 0, 0}))
+    }));
+    m_poseDirty = true;
+}
+
+void LightIKBatch::SetConstraint(size_t boneIndex, Constraints && constraint)
+{
+    m_rig->SetConstraint(boneIndex, std::move(constraint));
+}
+
+void LightIKBatch::SetTargetPosition(size_t chainIndex, size_t instance, const Vector& position)
+{
+    assert(chainIndex < m_chains.size());
+    assert(instance < m_instancesCount);
+    m_chains[chainIndex]->targets[instance / BatchLanes].Set(instance % BatchLanes, position);
+}
+
+size_t LightIKBatch::Update(size_t iterations)
+{
+    PreparePose();
+
+    size_t count = iterations;
+    for (size_t b = 0; b < m_blocksCount; ++b)
+    {
+        PoseBlock pose {
+            &m_positions[b * m_slotsCount], 
+            &m_rotations[b * m_slotsCount], 
+            &m_globalOrientations[b * m_slotsCount]
+        };
+        // lanes of the last block that are not assigned to any instance are never solved
+        PackMask valid;
+        for (size_t k = 0; k < BatchLanes; ++k)
+        {
+            valid.Set(k, b * BatchLanes + k < m_instancesCount);
+        }
+
+        for (auto& chain : m_chains)
+        {
+            const SolverBatch& solver   = chain->solver;
+            const PackVector& target    = chain->targets[b];
+            PackVector& tip             = chain->tips[b];
+            PackMask active             = valid;
+            // do the iterrations untill tips of all instances reach their targets
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                tip = solver.CalculateBonePositions(pose);
+                
+                PackMask reached = solver.TargetReached(tip, target) && active;
+                if (Any(reached))
+                {
+                    count = std::min(count, i);
+                }
+                active = active && !reached;
+                if (!Any(active))
+                {
+                    break;
+                }
+
+                solver.Execute(pose, tip, target, active);
+
+                // closed form solution is final, the instances stop after one pass as the separate skeletons do
+                if (solver.IsClosedForm())
+                {
+                    tip     = solver.CalculateBonePositions(pose);
+                    count   = std::min(count, i + 1);
+                    break;
+                }
+            }
+
+            if (chain->rigSolver.HasDependencies())
+            {
+                tip = solver.CalculateBonePositions(pose);
+            }
+        }
+    }
+    return count;
+}
+
+Quaternion LightIKBatch::GetDeltaRotation(size_t instance, size_t boneIndex) const
+{
+    assert(instance < m_instancesCount);
+    if (m_poseDirty)
+    {
+        return m_rig->GetBones().at(boneIndex)->GetRotation();
+    }
+    return m_rotations[(instance / BatchLanes) * m_slotsCount + GetSlot(boneIndex)].Get(instance % BatchLanes);
+}
+
+Vector LightIKBatch::GetTargetPosition(size_t chainIndex, size_t instance) const
+{
+    assert(chainIndex < m_chains.size());
+    assert(instance < m_instancesCount);
+    return m_chains[chainIndex]->targets[instance / BatchLanes].Get(instance % BatchLanes);
+}
+
+Vector LightIKBatch::GetTipPosition(size_t chainIndex, size_t instance) const
+{
+    assert(chainIndex < m_chains.size());
+    assert(instance < m_instancesCount);
+    return m_chains[chainIndex]->tips[instance / BatchLanes].Get(instance % BatchLanes);
+}
+
+Vector LightIKBatch::GetBonePosition(size_t instance, size_t boneIndex) const
+{
+    assert(instance < m_instancesCount);
+    if (m_poseDirty)
+    {
+        return m_rig->GetBones().at(boneIndex)->GetPosition();
+    }
+    return m_positions[(instance / BatchLanes) * m_slotsCount + GetSlot(boneIndex)].Get(instance % BatchLanes);
+}
+
+void LightIKBatch::InitializePose()
+{
+    const BoneStorage& rig = m_rig->GetStorage();
+    m_slotsCount = rig.Size();
+
+    m_positions.resize(m_blocksCount * m_slotsCount);
+    m_rotations.resize(m_blocksCount * m_slotsCount);
+    m_globalOrientations.resize(m_blocksCount * m_slotsCount);
+
+    for (size_t b = 0; b < m_blocksCount; ++b)
+    {
+        for (size_t s = 0; s < m_slotsCount; ++s)
+        {
+            m_positions[b * m_slotsCount + s]           = PackVector::Broadcast(rig.positions[s]);
+            m_rotations[b * m_slotsCount + s]           = PackQuaternion::Broadcast(rig.rotations[s]);
+            m_globalOrientations[b * m_slotsCount + s]  = PackQuaternion::Broadcast(rig.globalOrientations[s]);
+        }
+    }
+    m_poseDirty = false;
+}
+
+void LightIKBatch::PreparePose()
+{
+    if (m_poseDirty)
+    {
+        InitializePose();
+    }
+}
+
+size_t LightIKBatch::GetSlot(size_t boneIndex) const
+{
+    const Bone* bone = m_rig->GetBones().at(boneIndex);
+    assert(bone);
+    return bone->GetIndex();
+}
+
+}
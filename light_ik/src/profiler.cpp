@@ -0,0 +1,186 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "profile_zone.h"
+
+#include <thread>
+#include <iomanip>
+
+namespace LightIK
+{
+
+namespace Profiling
+{
+    std::atomic<Profiler*> activeProfiler {nullptr};
+}
+
+namespace
+{
+    // Identifiers of the trace writers, 0 is never used
+    std::atomic<uint64_t> s_writerId {0};
+
+    // Buffer of the current thread for the last writer the thread reported to
+    thread_local uint64_t   t_writer = 0;
+    thread_local void*      t_buffer = nullptr;
+}
+
+void SetProfiler(Profiler* profiler)
+{
+    Profiling::activeProfiler.store(profiler, std::memory_order_release);
+}
+
+const char* GetScopeName(ProfileScope scope)
+{
+    switch (scope)
+    {
+    case ProfileScope::update:
+        return "update";
+    case ProfileScope::chain:
+        return "chain";
+    case ProfileScope::iteration:
+        return "iteration";
+    case ProfileScope::kinematics:
+        return "kinematics";
+    case ProfileScope::constraint:
+        return "constraint";
+    }
+    return "unknown";
+}
+
+struct ChromeTraceWriter::Event
+{
+    // nanoseconds since the writer was created
+    uint64_t        time;
+    uint32_t        id;
+    ProfileScope    scope;
+    bool            begin;
+};
+
+struct ChromeTraceWriter::ThreadBuffer
+{
+    ThreadBuffer(size_t capacity, uint32_t index)
+        : events(std::make_unique<Event[]>(capacity))
+        , owner(std::this_thread::get_id())
+        , thread(index)
+    {
+    }
+
+    std::unique_ptr<Event[]>    events;
+    // number of published events, only the owner thread appends them
+    std::atomic<size_t>         count {0};
+    std::atomic<size_t>         dropped {0};
+    std::thread::id             owner;
+    // thread index in the trace
+    uint32_t                    thread;
+    ThreadBuffer*               next = nullptr;
+};
+
+ChromeTraceWriter::ChromeTraceWriter(size_t eventsPerThread)
+    : m_capacity(eventsPerThread)
+    , m_start(Clock::now())
+    , m_id(++s_writerId)
+{
+}
+
+ChromeTraceWriter::~ChromeTraceWriter()
+{
+    ThreadBuffer* buffer = m_buffers.load();
+    while (buffer)
+    {
+        ThreadBuffer* next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
+}
+
+void ChromeTraceWriter::BeginScope(ProfileScope scope, uint32_t id)
+{
+    Record(scope, id, true);
+}
+
+void ChromeTraceWriter::EndScope(ProfileScope scope)
+{
+    Record(scope, 0, false);
+}
+
+ChromeTraceWriter::ThreadBuffer& ChromeTraceWriter::GetThreadBuffer()
+{
+    if (t_writer == m_id)
+    {
+        return *static_cast<ThreadBuffer*>(t_buffer);
+    }
+
+    // the thread may have reported to the writer before it switched to another one
+    const std::thread::id self = std::this_thread::get_id();
+    ThreadBuffer* buffer = m_buffers.load(std::memory_order_acquire);
+    while (buffer && buffer->owner != self)
+    {
+        buffer = buffer->next;
+    }
+    if (!buffer)
+    {
+        buffer          = new ThreadBuffer(m_capacity, m_threadsCount.fetch_add(1));
+        buffer->next    = m_buffers.load(std::memory_order_relaxed);
+        while (!m_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+    t_writer            = m_id;
+    t_buffer            = buffer;
+    return *buffer;
+}
+
+void ChromeTraceWriter::Record(ProfileScope scope, uint32_t id, bool begin)
+{
+    const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+    ThreadBuffer& buffer = GetThreadBuffer();
+    const size_t count  = buffer.count.load(std::memory_order_relaxed);
+    if (count == m_capacity)
+    {
+        buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[count] = Event{time, id, scope, begin};
+    // the event is visible to the writing thread only after it is complete
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void ChromeTraceWriter::Write(std::ostream& stream) const
+{
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    for (const ThreadBuffer* buffer = m_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Event& event = buffer->events[i];
+            stream << (first ? "\n" : ",\n");
+            first = false;
+            // timestamps of the trace are microseconds
+            stream << "{\"name\":\"" << GetScopeName(event.scope) << "\",\"cat\":\"light_ik\",\"ph\":\""
+                << (event.begin ? 'B' : 'E') << "\",\"ts\":" << event.time / 1000 << '.'
+                << std::setw(3) << std::setfill('0') << event.time % 1000 << std::setfill(' ')
+                << ",\"pid\":0,\"tid\":" << buffer->thread;
+            if (event.begin)
+            {
+                stream << ",\"args\":{\"id\":" << event.id << '}';
+            }
+            stream << '}';
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+size_t ChromeTraceWriter::GetDroppedCount() const
+{
+    size_t dropped = 0;
+    for (const ThreadBuffer* buffer = m_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+}
@@ -0,0 +1,449 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "light_ik/recorder.h"
+#include "light_ik/light_ik.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace LightIK
+{
+
+namespace
+{
+    // Log starts with the magic, the format version and the size of the real numbers of the captured library
+    constexpr char      s_magic[4]  = {'L', 'I', 'K', 'R'};
+    constexpr uint16_t  s_version   = 1;
+
+    enum class RecordType : uint8_t
+    {
+        ikChain,        // descriptors, chain start, solver type; the target position is captured by the updates
+        ikLink,         // descriptors, chain start, target bone index, solver type
+        passiveChain,   // descriptors
+        constraint,     // bone index, constraint parameters
+        convergence,    // chain index, convergence parameters
+        pole,           // chain index, presence flag, pole position
+        effectorGroup,  // chain indices, damping
+        resetPose,
+        reset,
+        update,         // iterations budget, target positions of the position chains
+        result,         // actual iterations, hash of the chain tips
+    };
+
+    // FNV-1a over the bits of the tip positions, any difference of the solution changes the hash
+    uint64_t HashTips(const LightIK& library)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t chainIndex = 0; chainIndex < library.GetSolversCount(); ++chainIndex)
+        {
+            const Vector tip = library.GetTipPosition(chainIndex);
+            uint8_t bytes[sizeof(tip)];
+            std::memcpy(bytes, &tip, sizeof(tip));
+            for (uint8_t byte : bytes)
+            {
+                hash = (hash ^ byte) * 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+    // start bone of the IK chain is one of the bones of its root chain
+    bool IsChainStart(const std::vector<BoneDesc>& descriptors, int32_t chainStart)
+    {
+        return std::any_of(descriptors.begin(), descriptors.end(),
+            [chainStart](const BoneDesc& desc) { return desc.boneIndex == chainStart; });
+    }
+}
+
+Recorder::Recorder(size_t reserve)
+{
+    m_data.reserve(reserve);
+}
+
+bool Recorder::Save(std::ostream& stream) const
+{
+    stream.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+    return !stream.fail();
+}
+
+void Recorder::Clear()
+{
+    m_data.clear();
+    m_positionChains.clear();
+}
+
+template <typename T>
+void Recorder::Write(const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    const size_t offset = m_data.size();
+    m_data.resize(offset + sizeof(T));
+    std::memcpy(m_data.data() + offset, &value, sizeof(T));
+}
+
+void Recorder::WriteDescriptors(const std::vector<BoneDesc>& descriptors)
+{
+    Write((uint32_t)descriptors.size());
+    for (const BoneDesc& desc : descriptors)
+    {
+        Write(desc.orientation);
+        Write(desc.length);
+        Write((int32_t)desc.boneIndex);
+    }
+}
+
+void Recorder::RecordStart(size_t bonesCount)
+{
+    Clear();
+    Write(s_magic);
+    Write(s_version);
+    Write((uint8_t)sizeof(real));
+    Write((uint8_t)0);
+    Write((uint64_t)bonesCount);
+}
+
+void Recorder::RecordChain(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, size_t chainIndex,
+    SolverType solverType)
+{
+    Write(RecordType::ikChain);
+    WriteDescriptors(rootChainDesc);
+    Write((int32_t)chainStartIndex);
+    Write((uint8_t)solverType);
+    m_positionChains.emplace_back(chainIndex);
+}
+
+void Recorder::RecordLink(const std::vector<BoneDesc>& rootChainDesc, int chainStartIndex, int targetBoneIndex,
+    SolverType solverType)
+{
+    Write(RecordType::ikLink);
+    WriteDescriptors(rootChainDesc);
+    Write((int32_t)chainStartIndex);
+    Write((int32_t)targetBoneIndex);
+    Write((uint8_t)solverType);
+}
+
+void Recorder::RecordPassiveChain(const std::vector<BoneDesc>& rootChainDesc)
+{
+    Write(RecordType::passiveChain);
+    WriteDescriptors(rootChainDesc);
+}
+
+void Recorder::RecordConstraint(size_t boneIndex, const Constraints& constraint)
+{
+    Write(RecordType::constraint);
+    Write((uint64_t)boneIndex);
+    Write(constraint.flexibility);
+    Write(constraint.minAngles);
+    Write(constraint.maxAngles);
+    Write((uint8_t)constraint.type);
+    Write(constraint.swingLimit);
+    Write(constraint.twistMin);
+    Write(constraint.twistMax);
+}
+
+void Recorder::RecordConvergence(size_t chainIndex, const Convergence& convergence)
+{
+    Write(RecordType::convergence);
+    Write((uint64_t)chainIndex);
+    Write(convergence.tolerance);
+    Write(convergence.stallThreshold);
+    Write(convergence.sleepThreshold);
+}
+
+void Recorder::RecordPole(size_t chainIndex, const std::optional<Vector>& pole)
+{
+    Write(RecordType::pole);
+    Write((uint64_t)chainIndex);
+    Write((uint8_t)pole.has_value());
+    Write(pole.value_or(Vector(0)));
+}
+
+void Recorder::RecordEffectorGroup(const std::vector<size_t>& chainIndices, real damping)
+{
+    Write(RecordType::effectorGroup);
+    Write((uint32_t)chainIndices.size());
+    for (size_t chainIndex : chainIndices)
+    {
+        Write((uint64_t)chainIndex);
+    }
+    Write(damping);
+}
+
+void Recorder::RecordResetPose()
+{
+    Write(RecordType::resetPose);
+}
+
+void Recorder::RecordReset()
+{
+    Write(RecordType::reset);
+    m_positionChains.clear();
+}
+
+void Recorder::RecordUpdate(const LightIK& library, size_t iterations)
+{
+    Write(RecordType::update);
+    Write((uint32_t)iterations);
+    for (size_t chainIndex : m_positionChains)
+    {
+        Write(library.GetTargetPosition(chainIndex));
+    }
+}
+
+void Recorder::RecordResult(const LightIK& library, size_t iterations)
+{
+    Write(RecordType::result);
+    Write((uint32_t)iterations);
+    Write(HashTips(library));
+}
+
+Replay::Replay(std::istream& stream)
+    : Replay(std::vector<uint8_t>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()))
+{
+}
+
+Replay::Replay(std::vector<uint8_t> data)
+    : m_data(std::move(data))
+{
+    m_valid         = ReadHeader();
+    m_bodyOffset    = m_offset;
+}
+
+template <typename T>
+bool Replay::Read(T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (m_data.size() - m_offset < sizeof(T))
+    {
+        return false;
+    }
+    std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+    m_offset += sizeof(T);
+    return true;
+}
+
+bool Replay::ReadHeader()
+{
+    char        magic[4]    = {};
+    uint16_t    version     = 0;
+    uint8_t     realSize    = 0;
+    uint8_t     padding     = 0;
+    uint64_t    bonesCount  = 0;
+    if (!Read(magic) || !Read(version) || !Read(realSize) || !Read(padding) || !Read(bonesCount))
+    {
+        return false;
+    }
+    // the replay is bit exact only with the same precision
+    if (std::memcmp(magic, s_magic, sizeof(magic)) != 0 || version != s_version || realSize != sizeof(real))
+    {
+        return false;
+    }
+    m_bonesCount = bonesCount;
+    return true;
+}
+
+bool Replay::ReadDescriptors(std::vector<BoneDesc>& descriptors)
+{
+    uint32_t count = 0;
+    if (!Read(count) || count == 0 || count > (m_data.size() - m_offset) / (sizeof(Quaternion) + sizeof(real)))
+    {
+        return false;
+    }
+    descriptors.resize(count);
+    for (BoneDesc& desc : descriptors)
+    {
+        int32_t boneIndex = -1;
+        if (!Read(desc.orientation) || !Read(desc.length) || !Read(boneIndex) || boneIndex < 0 ||
+            (size_t)boneIndex >= m_bonesCount)
+        {
+            return false;
+        }
+        desc.boneIndex = boneIndex;
+    }
+    return true;
+}
+
+bool Replay::Step(LightIK& library)
+{
+    if (!m_valid)
+    {
+        return false;
+    }
+
+    std::vector<BoneDesc> descriptors;
+    RecordType type;
+    while (Read(type))
+    {
+        switch (type)
+        {
+        case RecordType::ikChain:
+        {
+            int32_t chainStart  = 0;
+            uint8_t solverType  = 0;
+            if (!ReadDescriptors(descriptors) || !Read(chainStart) || !Read(solverType) ||
+                !IsChainStart(descriptors, chainStart) || solverType > (uint8_t)SolverType::fabrik)
+            {
+                return false;
+            }
+            TargetPosition& target = library.CreateTarget();
+            if (library.CreateIKChain(descriptors, chainStart, target, (SolverType)solverType) == SIZE_MAX)
+            {
+                return false;
+            }
+            m_targets.emplace_back(&target);
+            break;
+        }
+        case RecordType::ikLink:
+        {
+            int32_t chainStart  = 0;
+            int32_t targetBone  = 0;
+            uint8_t solverType  = 0;
+            if (!ReadDescriptors(descriptors) || !Read(chainStart) || !Read(targetBone) || !Read(solverType) ||
+                !IsChainStart(descriptors, chainStart) || solverType > (uint8_t)SolverType::fabrik ||
+                targetBone < 0 || (size_t)targetBone >= m_bonesCount)
+            {
+                return false;
+            }
+            // the library rejects the target bone that is not registered by the previous chains
+            if (library.CreateIKLink(descriptors, chainStart, targetBone, (SolverType)solverType) == SIZE_MAX)
+            {
+                return false;
+            }
+            break;
+        }
+        case RecordType::passiveChain:
+        {
+            if (!ReadDescriptors(descriptors))
+            {
+                return false;
+            }
+            library.CreatePassiveChain(descriptors);
+            break;
+        }
+        case RecordType::constraint:
+        {
+            uint64_t    boneIndex   = 0;
+            uint8_t     kind        = 0;
+            Constraints constraint;
+            if (!Read(boneIndex) || !Read(constraint.flexibility) || !Read(constraint.minAngles) ||
+                !Read(constraint.maxAngles) || !Read(kind) || !Read(constraint.swingLimit) ||
+                !Read(constraint.twistMin) || !Read(constraint.twistMax) || boneIndex >= m_bonesCount ||
+                kind > (uint8_t)ConstraintType::swingTwist)
+            {
+                return false;
+            }
+            constraint.type = (ConstraintType)kind;
+            library.SetConstraint(boneIndex, std::move(constraint));
+            break;
+        }
+        case RecordType::convergence:
+        {
+            uint64_t    chainIndex  = 0;
+            Convergence convergence;
+            if (!Read(chainIndex) || !Read(convergence.tolerance) || !Read(convergence.stallThreshold) ||
+                !Read(convergence.sleepThreshold) || chainIndex >= library.GetSolversCount())
+            {
+                return false;
+            }
+            library.SetConvergence(chainIndex, convergence);
+            break;
+        }
+        case RecordType::pole:
+        {
+            uint64_t    chainIndex  = 0;
+            uint8_t     hasPole     = 0;
+            Vector      pole;
+            if (!Read(chainIndex) || !Read(hasPole) || !Read(pole) || chainIndex >= library.GetSolversCount())
+            {
+                return false;
+            }
+            library.SetPole(chainIndex, hasPole ? std::optional<Vector>(pole) : std::nullopt);
+            break;
+        }
+        case RecordType::effectorGroup:
+        {
+            uint32_t count = 0;
+            if (!Read(count) || count > (m_data.size() - m_offset) / sizeof(uint64_t))
+            {
+                return false;
+            }
+            std::vector<size_t> chainIndices(count);
+            for (size_t& chainIndex : chainIndices)
+            {
+                uint64_t index = 0;
+                if (!Read(index) || index >= library.GetSolversCount())
+                {
+                    return false;
+                }
+                chainIndex = index;
+            }
+            real damping = 0;
+            if (!Read(damping))
+            {
+                return false;
+            }
+            library.CreateEffectorGroup(chainIndices, damping);
+            break;
+        }
+        case RecordType::resetPose:
+            library.ResetPose();
+            break;
+        case RecordType::reset:
+            library.Reset();
+            // the targets are destroyed with the chains
+            m_targets.clear();
+            break;
+        case RecordType::update:
+        {
+            uint32_t iterations = 0;
+            if (!Read(iterations))
+            {
+                return false;
+            }
+            for (TargetPosition* target : m_targets)
+            {
+                Vector position;
+                if (!Read(position))
+                {
+                    return false;
+                }
+                target->SetPosition(position);
+            }
+            const size_t actual = library.Update(iterations);
+            ++m_frame;
+
+            RecordType  resultType          = RecordType::update;
+            uint32_t    expectedIterations  = 0;
+            uint64_t    expectedHash        = 0;
+            if (!Read(resultType) || resultType != RecordType::result || !Read(expectedIterations) || !Read(expectedHash))
+            {
+                return false;
+            }
+            if (actual != expectedIterations || HashTips(library) != expectedHash)
+            {
+                ++m_mismatches;
+            }
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+    // every record has been read, the log ends cleanly
+    m_finished = m_offset == m_data.size();
+    return false;
+}
+
+void Replay::Rewind()
+{
+    m_offset        = m_bodyOffset;
+    m_finished      = false;
+    m_frame         = 0;
+    m_mismatches    = 0;
+    m_targets.clear();
+}
+
+}
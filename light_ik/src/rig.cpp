@@ -0,0 +1,52 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "skeleton.h"
+#include "light_ik/rig.h"
+#include "light_ik/rig_file.h"
+#include "light_ik/light_ik.h"
+
+#include <algorithm>
+
+namespace LightIK
+{
+
+Rig::Rig() = default;
+
+Rig::~Rig() = default;
+
+std::shared_ptr<const Rig> Rig::Create(const RigView& view)
+{
+    if (!view.IsValid())
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<Rig> rig(new Rig());
+    rig->m_prototype = std::make_unique<LightIK>(view.GetBones().size());
+    LightIK& prototype = *rig->m_prototype;
+    if (!prototype.CreateRig(view))
+    {
+        return nullptr;
+    }
+    // the instances copy the finalized plan and the batches of the chains
+    prototype.Finalize();
+
+    const std::vector<BonePtr>& bones = prototype.m_skeleton->GetBones();
+    rig->m_targetBones.reserve(prototype.m_solvers.size());
+    for (const SolverBase& solver : prototype.m_solvers)
+    {
+        const Target* target    = solver.GetTarget();
+        const Bone* bone        = target ? target->GetBone() : nullptr;
+        rig->m_targetBones.emplace_back(bone ? (int)(std::find(bones.begin(), bones.end(), bone) - bones.begin()) : -1);
+    }
+    return rig;
+}
+
+size_t Rig::GetBonesCount() const
+{
+    return m_prototype->m_relativeRotations.size();
+}
+
+}
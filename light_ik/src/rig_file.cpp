@@ -0,0 +1,245 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "helpers.h"
+#include "light_ik/rig_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LightIK
+{
+
+namespace
+{
+    constexpr char      s_magic[4]  = {'L', 'I', 'K', 'G'};
+    constexpr uint16_t  s_version   = 1;
+    // sections start at the aligned offsets, so the mapped file can be read in place
+    constexpr size_t    s_alignment = 16;
+
+    struct RigHeader
+    {
+        char        magic[4];
+        uint16_t    version;
+        // sizes of the structures, the file is valid only for the build with the same precision and layout
+        uint8_t     realSize;
+        uint8_t     reserved;
+        uint32_t    boneSize;
+        uint32_t    constraintSize;
+        uint32_t    chainSize;
+        uint32_t    bonesCount;
+        uint32_t    constraintsCount;
+        uint32_t    chainsCount;
+        uint64_t    bonesOffset;
+        uint64_t    constraintsOffset;
+        uint64_t    chainsOffset;
+        uint64_t    size;
+    };
+
+    size_t Align(size_t offset)
+    {
+        return (offset + s_alignment - 1) / s_alignment * s_alignment;
+    }
+
+    template <typename T>
+    bool GetSection(std::span<const uint8_t> data, uint64_t offset, uint32_t count, std::span<const T>& section)
+    {
+        if (offset % s_alignment != 0 || offset > data.size() || (data.size() - offset) / sizeof(T) < count)
+        {
+            return false;
+        }
+        section = {reinterpret_cast<const T*>(data.data() + offset), count};
+        return true;
+    }
+
+    bool ValidateParents(std::span<const RigBone> bones)
+    {
+        std::vector<int> parents(bones.size());
+        std::transform(bones.begin(), bones.end(), parents.begin(), [](const RigBone& bone) { return bone.parent; });
+        return Helpers::ValidateParents(parents);
+    }
+
+    bool ValidateChains(std::span<const RigBone> bones, std::span<const RigChain> chains)
+    {
+        const int32_t count = (int32_t)bones.size();
+        // bones registered by the earlier chains: every chain registers its tip and all ancestors of the tip
+        std::vector<bool> covered(bones.size(), false);
+        for (const RigChain& chain : chains)
+        {
+            if (chain.tip < 0 || chain.tip >= count || chain.type > RigChainType::passive ||
+                chain.solverType > (uint8_t)SolverType::fabrik)
+            {
+                return false;
+            }
+            // target bone has to exist before the chain that follows it
+            if (chain.type == RigChainType::bone && (chain.targetBone < 0 || chain.targetBone >= count || !covered[chain.targetBone]))
+            {
+                return false;
+            }
+            if (chain.type == RigChainType::passive)
+            {
+                // passive chain without new bones is not created
+                if (covered[chain.tip])
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                // start bone is the tip or its ancestor
+                int32_t bone = chain.tip;
+                while (bone != -1 && bone != chain.start)
+                {
+                    bone = bones[bone].parent;
+                }
+                if (bone == -1)
+                {
+                    return false;
+                }
+            }
+            for (int32_t bone = chain.tip; bone != -1 && !covered[bone]; bone = bones[bone].parent)
+            {
+                covered[bone] = true;
+            }
+        }
+        return true;
+    }
+}
+
+RigView::RigView(std::span<const uint8_t> data)
+{
+    RigHeader header;
+    if (data.size() < sizeof(header) || reinterpret_cast<uintptr_t>(data.data()) % s_alignment != 0)
+    {
+        return;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0 || header.version != s_version ||
+        header.realSize != sizeof(real) || header.boneSize != sizeof(RigBone) ||
+        header.constraintSize != sizeof(Constraints) || header.chainSize != sizeof(RigChain) || header.size != data.size())
+    {
+        return;
+    }
+    if (header.constraintsCount != 0 && header.constraintsCount != header.bonesCount)
+    {
+        return;
+    }
+    if (!GetSection(data, header.bonesOffset, header.bonesCount, m_bones) ||
+        !GetSection(data, header.constraintsOffset, header.constraintsCount, m_constraints) ||
+        !GetSection(data, header.chainsOffset, header.chainsCount, m_chains))
+    {
+        return;
+    }
+    m_valid = ValidateParents(m_bones) && ValidateChains(m_bones, m_chains);
+}
+
+RigFile::RigFile(const std::string& path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+        {
+            m_mapping   = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            m_size      = m_mapping ? (size_t)size.QuadPart : 0;
+            // the view keeps the mapping alive
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            m_mapping   = mapping;
+            m_size      = (size_t)status.st_size;
+        }
+    }
+    // the mapping stays valid after the file is closed
+    close(file);
+#endif
+    if (m_mapping)
+    {
+        m_view = RigView({static_cast<const uint8_t*>(m_mapping), m_size});
+    }
+}
+
+RigFile::RigFile(std::vector<uint8_t> data)
+    : m_data(std::move(data))
+    , m_view(m_data)
+{
+}
+
+RigFile::~RigFile()
+{
+    if (!m_mapping)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_mapping);
+#else
+    munmap(m_mapping, m_size);
+#endif
+}
+
+bool WriteRig(std::ostream& stream, std::span<const RigBone> bones, std::span<const Constraints> constraints,
+    std::span<const RigChain> chains)
+{
+    if ((!constraints.empty() && constraints.size() != bones.size()) || !ValidateParents(bones) || !ValidateChains(bones, chains))
+    {
+        return false;
+    }
+
+    RigHeader header        = {};
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.version          = s_version;
+    header.realSize         = sizeof(real);
+    header.boneSize         = sizeof(RigBone);
+    header.constraintSize   = sizeof(Constraints);
+    header.chainSize        = sizeof(RigChain);
+    header.bonesCount       = (uint32_t)bones.size();
+    header.constraintsCount = (uint32_t)constraints.size();
+    header.chainsCount      = (uint32_t)chains.size();
+    header.bonesOffset      = Align(sizeof(header));
+    header.constraintsOffset = Align(header.bonesOffset + bones.size_bytes());
+    header.chainsOffset     = Align(header.constraintsOffset + constraints.size_bytes());
+    header.size             = header.chainsOffset + chains.size_bytes();
+
+    std::vector<uint8_t> data(header.size, 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::copy_n(reinterpret_cast<const uint8_t*>(bones.data()), bones.size_bytes(), data.data() + header.bonesOffset);
+    std::copy_n(reinterpret_cast<const uint8_t*>(constraints.data()), constraints.size_bytes(), data.data() + header.constraintsOffset);
+    std::copy_n(reinterpret_cast<const uint8_t*>(chains.data()), chains.size_bytes(), data.data() + header.chainsOffset);
+    stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return !stream.fail();
+}
+
+}
@@ -5,40 +5,140 @@
 #include "skeleton.h"
 #include "solver.h"
 #include "solver_passive.h"
+#include "solver_two_bone.h"
+#include "solver_fabrik.h"
 #include "helpers.h"
+#include "thread_pool.h"
+#include "profile_zone.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/vector_angle.hpp"
 #include "glm/gtx/rotate_vector.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
 
 namespace LightIK
 {
 
-static Bone g_boneDummy;
-
 Skeleton::Skeleton(size_t bonesCount)
+    // the first arena block fits the chains structure of the average rig, bigger rigs take more blocks
+    : m_arena(bonesCount * 64 + 1024)
 {
-    // Add one more bone slot for the root bone, it will be placed in the end of list
+    // Add one more bone slot for the root bone, it will be placed in the beginning of the storage
+    m_storage.Reserve(bonesCount + 1);
+    m_views.reserve(bonesCount + 1);
     m_bones.resize(bonesCount);
+
+    m_views.emplace_back(m_storage, m_storage.Add(0, glm::identity<Quaternion>()));
 }
 
-SolverBase& Skeleton::AddSolver(const std::vector<BoneDesc>& rootChain, size_t startBoneIndex, Target& target)
+Skeleton::Skeleton(InstanceTag, const Skeleton& rig)
+    : m_arena(rig.m_bones.size() * 64 + 1024)
+    , m_plan(rig.m_plan)
+{
+    assert(!rig.m_planDirty && rig.m_groups.empty());
+    m_storage.Instantiate(rig.m_storage, rig.m_views.capacity());
+    // views are addressed by the bones, the capacity of the rig keeps them in place when the instance grows
+    m_views.reserve(rig.m_views.capacity());
+    for (size_t slot = 0; slot < m_storage.Size(); ++slot)
+    {
+        m_views.emplace_back(m_storage, slot);
+    }
+    m_bones.resize(rig.m_bones.size(), nullptr);
+    for (size_t boneIndex = 0; boneIndex < m_bones.size(); ++boneIndex)
+    {
+        if (rig.m_bones[boneIndex])
+        {
+            m_bones[boneIndex] = &m_views[rig.m_bones[boneIndex]->GetIndex()];
+        }
+    }
+}
+
+void Skeleton::InstantiateChains(const Skeleton& rig, std::span<Target* const> targets)
+{
+    assert(m_chains.empty() && targets.size() == rig.m_chains.size());
+    // parent slot of every bone, the solver is attached to the parent of its first bone
+    std::vector<ExecutionPlan::Index> parents(m_storage.Size(), m_rootSlot);
+    for (size_t i = 0; i < m_plan.slots.size(); ++i)
+    {
+        parents[m_plan.slots[i]] = m_plan.parents[i];
+    }
+
+    m_chains.reserve(rig.m_chains.size());
+    for (size_t c = 0; c < rig.m_chains.size(); ++c)
+    {
+        const RootChain& source = *rig.m_chains[c];
+        RootChain& chain        = *m_chains.emplace_back(m_arena.Make<RootChain>(m_arena.GetResource(), source.baseBone));
+        chain.chain.reserve(source.chain.size());
+        for (const Bone& bone : source.chain)
+        {
+            chain.chain.emplace_back(m_views[bone.GetIndex()]);
+        }
+        chain.range             = source.range;
+        chain.kind              = source.kind;
+        chain.baseOrientation   = source.baseOrientation;
+        chain.basePosition      = source.basePosition;
+        chain.tip               = source.tip;
+        chain.calculated        = source.calculated;
+
+        // solvers are created in the same order as in the rig, so the shared bones get the same owners
+        switch (source.kind)
+        {
+        case ExecutionPlan::SolverKind::binaryJoint:
+            chain.solver        = InstantiateSolver<Solver>(*source.solver, parents, *targets[c]);
+            break;
+        case ExecutionPlan::SolverKind::twoBone:
+            chain.solver        = InstantiateSolver<SolverTwoBone>(*source.solver, parents, *targets[c]);
+            break;
+        case ExecutionPlan::SolverKind::fabrik:
+            chain.solver        = InstantiateSolver<SolverFabrik>(*source.solver, parents, *targets[c]);
+            break;
+        default:
+            chain.solver        = m_arena.Make<SolverPassive>();
+            break;
+        }
+        chain.solver->SetConvergence(source.solver->GetConvergence());
+        chain.solver->SetDependencies(source.solver->HasDependencies());
+        Vector tip              = source.solver->GetTipPosition();
+        chain.solver->SetTipPosition(tip);
+    }
+    m_scheduleDirty = true;
+}
+
+template <typename ConcreteSolver>
+SolverPtr Skeleton::InstantiateSolver(const SolverBase& rigSolver, std::span<const ExecutionPlan::Index> parents, Target& target)
+{
+    const BoneSubchain& rigChain = static_cast<const ConcreteSolver&>(rigSolver).GetChain();
+    BoneSubchain chain(m_arena.GetResource());
+    chain.reserve(rigChain.size());
+    for (const Bone& bone : rigChain)
+    {
+        chain.emplace_back(m_views[bone.GetIndex()]);
+    }
+    const Bone& parentBone      = m_views[parents[chain.front().get().GetIndex()]];
+    return m_arena.Make<ConcreteSolver>(std::move(chain), parentBone, target);
+}
+
+SolverBase& Skeleton::AddSolver(const std::vector<BoneDesc>& rootChain, size_t startBoneIndex, Target& target, SolverType solverType)
 {
     // Root bone is not 0, so consider that all root chains are made from tip to root.
     assert(rootChain.size());
     
-    int chainIndex = m_chains.size();
+    m_scheduleDirty     = true;
     // Each solver controls specific IK chain
-    RootChain& newChain = *m_chains.emplace_back(std::make_unique<RootChain>(RootChain{BoneSubchain{}, std::ref(g_boneDummy)}));
-    newChain.chain.reserve(rootChain.size());
+    RootChain& newChain = *m_chains.emplace_back(m_arena.Make<RootChain>(m_arena.GetResource(), m_rootSlot));
 
-    std::vector<BoneRef> solverChain;
-    solverChain.reserve(rootChain.size());
-
-    // Add bones in reverse order from tip to root
-    Bone* parentBone  = &g_boneDummy;
+    // Walk the chain from tip to root to find the part of the chain that is not registered yet
+    size_t first        = 0;
+    size_t solverFirst  = 0;
+    // Parent bone of the IK chain, by default it is the skeleton root
+    size_t parentIndex  = rootChain.size();
     
     // By default all bones after the start Bone Index forms the IK chain
     bool inChain        = true;
@@ -46,52 +146,76 @@ SolverBase& Skeleton::AddSolver(const std::vector<BoneDesc>& rootChain, size_t s
     for (size_t i = rootChain.size(); i != 0; --i)
     {
         size_t index = i - 1;
-        auto boneCreation = AddBone(rootChain[index]);
 
         // If the bone is the first bone not in the chain, then the parent bone is found
-        if (!inChain && parentBone == &g_boneDummy)
+        if (!inChain && parentIndex == rootChain.size())
         {
-            parentBone = &boneCreation.second.get();
+            parentIndex = index;
         }
 
         // Verify that bone is still in chain and not a part of any existing chain
         //  if it is, and current bone is not a part of IK chain, then the local root bone found
-        if (!inChain && !boneCreation.first)
+        if (!inChain && m_bones[rootChain[index].boneIndex])
         {
-            Bone& newBone = boneCreation.second;
-            // Mark the owner of the bone that it has dependencies
-            if (newBone.GetOwner())
-            {
-                newBone.GetOwner()->SetDependencies(true);
-            }
-            newChain.baseBone = std::ref(boneCreation.second);
+            first = i;
             break;
         }
-        // Add bone to the root chain
-        newChain.chain.emplace_back(boneCreation.second);
-        // If in chain, add bone to the solver chain
-        if (inChain)
-        {
-            solverChain.emplace_back(boneCreation.second);
-        }
         // If bone index is equal to start bone index of the chain, it means that all previous bones
         //  are part of the root chain but not a part of IK calculations
         if (rootChain[index].boneIndex == startBoneIndex)
         {
             // Chain is finished
-            inChain = false;
+            inChain     = false;
+            solverFirst = index;
         }
     }
-    // reverse chain into stright direction
-    std::reverse(newChain.chain.begin(), newChain.chain.end());
-    std::reverse(solverChain.begin(), solverChain.end());
+
+    if (first)
+    {
+        Bone& baseBone = *m_bones[rootChain[first - 1].boneIndex];
+        // Mark the owner of the bone that it has dependencies
+        if (baseBone.GetOwner())
+        {
+            baseBone.GetOwner()->SetDependencies(true);
+        }
+        newChain.baseBone = baseBone.GetIndex();
+    }
+
+    // Add bones in stright order from root to tip, to keep chain bones packed in the storage
+    AddRootChainBones(newChain, rootChain, first);
+
+    BoneSubchain solverChain(m_arena.GetResource());
+    solverChain.reserve(rootChain.size() - solverFirst);
+    for (size_t i = solverFirst; i < rootChain.size(); ++i)
+    {
+        solverChain.emplace_back(*m_bones[rootChain[i].boneIndex]);
+    }
 
     // Calculate bone positions for all chain
     auto tipPosition = CalculateBonePositions(newChain);
     // Add new solver
-    assert(parentBone);
+    const Bone& parentBone = parentIndex < rootChain.size() ? *m_bones[rootChain[parentIndex].boneIndex] : m_views[m_rootSlot];
 
-    newChain.solver = std::make_unique<Solver>(std::move(solverChain), *parentBone, target);
+    // two bone chains (limbs) are solved analytically in one pass
+    if (solverType == SolverType::automatic || (solverType == SolverType::twoBone && solverChain.size() != 2))
+    {
+        solverType = solverChain.size() == 2 ? SolverType::twoBone : SolverType::binaryJoint;
+    }
+    switch (solverType)
+    {
+    case SolverType::twoBone:
+        newChain.solver = m_arena.Make<SolverTwoBone>(std::move(solverChain), parentBone, target);
+        newChain.kind   = ExecutionPlan::SolverKind::twoBone;
+        break;
+    case SolverType::fabrik:
+        newChain.solver = m_arena.Make<SolverFabrik>(std::move(solverChain), parentBone, target);
+        newChain.kind   = ExecutionPlan::SolverKind::fabrik;
+        break;
+    default:
+        newChain.solver = m_arena.Make<Solver>(std::move(solverChain), parentBone, target);
+        newChain.kind   = ExecutionPlan::SolverKind::binaryJoint;
+        break;
+    }
     newChain.solver->SetTipPosition(tipPosition);
     
     return *newChain.solver;
@@ -101,41 +225,40 @@ SolverBase* Skeleton::AddChain(const std::vector<BoneDesc>& rootChain)
 {
     assert(rootChain.size());
     
-    int chainIndex = m_chains.size();
-    BoneRef baseBone = std::ref(g_boneDummy);
-    BoneSubchain chain;
-    chain.reserve(rootChain.size());
+    size_t first        = 0;
     for (size_t i = rootChain.size(); i != 0; --i)
     {
-        size_t index = i - 1;
-        auto boneCreation = AddBone(rootChain[index]);
-
         // verify that bone is still in chain and not a part of any existing chain
         // if it is, and current bone is not a part of IK chain, then the local root bone found
-        if (!boneCreation.first)
+        if (m_bones[rootChain[i - 1].boneIndex])
         {
-            Bone& newBone = boneCreation.second;
-            // mark the owner of the bone that it has dependencies
-            if (newBone.GetOwner())
-            {
-                newBone.GetOwner()->SetDependencies(true);
-            }
-            baseBone = std::ref(boneCreation.second);
+            first = i;
             break;
         }
-        chain.emplace_back(boneCreation.second);
     }
     // If chain already created or part of another chain, no need to create it
-    if (!chain.size())
+    if (first == rootChain.size())
     {
         return nullptr;
     }
 
-    // Reverse chain into stright direction
-    std::reverse(chain.begin(), chain.end());
+    size_t baseBone     = m_rootSlot;
+    if (first)
+    {
+        Bone& newBone = *m_bones[rootChain[first - 1].boneIndex];
+        // mark the owner of the bone that it has dependencies
+        if (newBone.GetOwner())
+        {
+            newBone.GetOwner()->SetDependencies(true);
+        }
+        baseBone = newBone.GetIndex();
+    }
 
+    m_scheduleDirty     = true;
     // Add new chain only if it has at least one element
-    RootChain& newChain = *m_chains.emplace_back(std::make_unique<RootChain>(RootChain{std::move(chain), baseBone, std::make_unique<SolverPassive>()}));
+    RootChain& newChain = *m_chains.emplace_back(m_arena.Make<RootChain>(m_arena.GetResource(), baseBone));
+    newChain.solver     = m_arena.Make<SolverPassive>();
+    AddRootChainBones(newChain, rootChain, first);
 
     // Calculate bone positions for all chain
     CalculateBonePositions(newChain);
@@ -145,15 +268,63 @@ SolverBase* Skeleton::AddChain(const std::vector<BoneDesc>& rootChain)
 void Skeleton::RemoveSolver(const SolverRef& solver)
 {
     size_t index = FindChainIndex(solver);
+    assert(index < m_chains.size());
 
+    // the rest of the group is solved by the chains themselves
+    if (EffectorGroup* group = m_chains[index]->group)
+    {
+        for (RootChain* chain : group->chains)
+        {
+            chain->group = nullptr;
+        }
+        std::erase_if(m_groups, [group](const ArenaPtr<EffectorGroup>& item) { return item.get() == group; });
+    }
     m_chains[index]     = nullptr;
+    m_scheduleDirty     = true;
+    m_planDirty         = true;
+}
+
+void Skeleton::Finalize()
+{
+    if (m_planDirty)
+    {
+        CompactPlan();
+    }
+    if (m_scheduleDirty)
+    {
+        BuildSchedule();
+        BuildBatches();
+    }
+}
+
+void Skeleton::CompactPlan()
+{
+    // the plan is rebuilt in the order of the remaining chains, so it stays topologically ordered
+    std::erase_if(m_chains, [](const RootChainPtr& chain) { return !chain; });
+
+    ExecutionPlan plan;
+    plan.ranges.reserve(m_chains.size());
+    plan.slots.reserve(m_plan.slots.size());
+    plan.parents.reserve(m_plan.slots.size());
+    plan.lengths.reserve(m_plan.slots.size());
+    plan.versions.reserve(m_plan.slots.size());
+    for (auto& chain : m_chains)
+    {
+        const ExecutionPlan::ChainRange range = m_plan.ranges[chain->range];
+        chain->range        = plan.Append(m_storage, GetSlots(*chain), chain->baseBone);
+        // versions are carried over, so the front kinematics stays incremental
+        std::copy_n(m_plan.versions.begin() + range.first, range.count, plan.versions.end() - range.count);
+    }
+    m_plan              = std::move(plan);
+    m_planDirty         = false;
+    m_scheduleDirty     = true;
 }
 
 bool Skeleton::SetConstraint(int boneIndex, Constraints && constraint)
 {
     assert(boneIndex < m_bones.size());
 
-    Bone* bone = m_bones[boneIndex].get();
+    Bone* bone = m_bones[boneIndex];
     if (bone)
     {
         bone->SetConstraints(std::move(constraint));
@@ -163,50 +334,589 @@ bool Skeleton::SetConstraint(int boneIndex, Constraints && constraint)
 
 size_t Skeleton::Update(size_t iterations)
 {
+    ProfileZone zone(ProfileScope::update);
     size_t count = iterations;
-    for (size_t c = 0; c < m_chains.size(); ++c)
+    // the plan and the batches are rebuilt only after the structure was changed, so the update allocates nothing
+    //  until the next change
+    Finalize();
+    if (m_threadPool && m_chains.size() > 1)
+    {
+        count = UpdateParallel(iterations);
+    }
+    else
     {
-        RootChain& rootChain    = *m_chains[c];
-        SolverBase& solver      = *rootChain.solver;
-        // do the iterrations untill tip and target will be in the same position
-        for(size_t i = 0; i < iterations; ++i)
+        for (const ExecutionPlan::Batch& batch : m_plan.batches)
         {
-            Vector tip = CalculateBonePositions(rootChain);
-            solver.SetTipPosition(tip);
+            count = std::min(count, ExecuteBatch(batch, iterations));
+        }
+    }
 
-            if (solver.TargetReached())
+    if (m_statisticsEnabled)
+    {
+        AggregateStatistics();
+    }
+    return count;
+}
+
+size_t Skeleton::ExecuteBatch(const ExecutionPlan::Batch& batch, size_t iterations)
+{
+    const std::span<const ExecutionPlan::Index> chains(m_plan.batchChains.data() + batch.first, batch.count);
+    switch (batch.kind)
+    {
+    case ExecutionPlan::SolverKind::passive:
+        return ExecuteBatch<SolverPassive>(chains, iterations);
+    case ExecutionPlan::SolverKind::binaryJoint:
+        return ExecuteBatch<Solver>(chains, iterations);
+    case ExecutionPlan::SolverKind::twoBone:
+        return ExecuteBatch<SolverTwoBone>(chains, iterations);
+    case ExecutionPlan::SolverKind::fabrik:
+        return ExecuteBatch<SolverFabrik>(chains, iterations);
+    default:
+        return ExecuteBatch<EffectorGroup>(chains, iterations);
+    }
+}
+
+template <typename ConcreteSolver>
+size_t Skeleton::ExecuteBatch(std::span<const ExecutionPlan::Index> chains, size_t iterations)
+{
+    size_t count = iterations;
+    for (ExecutionPlan::Index index : chains)
+    {
+        RootChain& rootChain = *m_chains[index];
+        if constexpr (std::is_same_v<ConcreteSolver, EffectorGroup>)
+        {
+            count = std::min(count, UpdateChain(rootChain, *rootChain.group, iterations));
+        }
+        else
+        {
+            count = std::min(count, UpdateChain(rootChain, static_cast<ConcreteSolver&>(*rootChain.solver), iterations));
+        }
+    }
+    return count;
+}
+
+size_t Skeleton::UpdateChain(RootChain& rootChain, size_t iterations)
+{
+    if (rootChain.group)
+    {
+        return UpdateChain(rootChain, *rootChain.group, iterations);
+    }
+    switch (rootChain.kind)
+    {
+    case ExecutionPlan::SolverKind::passive:
+        return UpdateChain(rootChain, static_cast<SolverPassive&>(*rootChain.solver), iterations);
+    case ExecutionPlan::SolverKind::twoBone:
+        return UpdateChain(rootChain, static_cast<SolverTwoBone&>(*rootChain.solver), iterations);
+    case ExecutionPlan::SolverKind::fabrik:
+        return UpdateChain(rootChain, static_cast<SolverFabrik&>(*rootChain.solver), iterations);
+    default:
+        return UpdateChain(rootChain, static_cast<Solver&>(*rootChain.solver), iterations);
+    }
+}
+
+size_t Skeleton::UpdateChain(RootChain& rootChain, EffectorGroup& group, size_t iterations)
+{
+    // chains of the group are solved together by the first chain, the others wait for it in the schedule
+    if (group.chains.front() != &rootChain)
+    {
+        return iterations;
+    }
+    ProfileZone zone(ProfileScope::chain, rootChain.range);
+    for (RootChain* chain : group.chains)
+    {
+        StartStatistics(*chain);
+    }
+    const size_t count  = UpdateGroup(group, iterations, m_statisticsEnabled ? &rootChain.statistics : nullptr);
+    if (m_statisticsEnabled)
+    {
+        for (RootChain* chain : group.chains)
+        {
+            RecordStatistics(*chain, count, chain->solver->GetTipPosition(), chain->solver->GetTargetPosition());
+        }
+    }
+    return count;
+}
+
+template <typename ConcreteSolver>
+size_t Skeleton::UpdateChain(RootChain& rootChain, ConcreteSolver& solver, size_t iterations)
+{
+    ProfileZone zone(ProfileScope::chain, rootChain.range);
+    ChainStatistics* statistics = StartStatistics(rootChain);
+    const size_t count          = SolveChain(rootChain, solver, iterations, statistics);
+    if (statistics)
+    {
+        RecordStatistics(rootChain, count, solver.GetTipPosition(), solver.GetTargetPosition());
+    }
+    return count;
+}
+
+template <typename ConcreteSolver>
+size_t Skeleton::SolveChain(RootChain& rootChain, ConcreteSolver& solver, size_t iterations, ChainStatistics* statistics)
+{
+    size_t count        = iterations;
+    const Convergence& convergence = solver.GetConvergence();
+    real previousError  = std::numeric_limits<real>::max();
+
+    if (convergence.sleepThreshold > 0 && IsSleeping(rootChain, convergence.sleepThreshold, solver.GetTargetPosition()))
+    {
+        rootChain.stopReason = StopReason::sleeping;
+        return 0;
+    }
+    rootChain.sleeping   = false;
+    rootChain.stopReason = StopReason::exhausted;
+    // do the iterrations untill tip and target will be in the same position
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        ProfileZone iteration(ProfileScope::iteration, static_cast<uint32_t>(i));
+        Vector tip = CalculateBonePositions(rootChain, statistics);
+        solver.SetTipPosition(tip);
+
+        if (solver.TargetReached())
+        {
+            // return false if no iterations were done
+            count = i;
+            StopChain(rootChain, StopReason::reached, solver.GetTargetPosition());
+            break;
+        }
+
+        // further iterations are useless if the previous one did not bring the tip closer to the target
+        if (convergence.stallThreshold > 0)
+        {
+            real error = glm::length(tip - solver.GetTargetPosition());
+            if (previousError - error < convergence.stallThreshold)
             {
-                // return false if no iterations were done
-                count = std::min(count, i);
+                count = i;
+                StopChain(rootChain, StopReason::stalled, solver.GetTargetPosition());
                 break;
             }
+            previousError = error;
+        }
 
-            solver.Execute();            
+        {
+            ScopedTimer timer(statistics ? &statistics->solverTime : nullptr);
+            solver.Execute();
         }
-        
-        if (solver.HasDependencies())
+
+        // the next iterations can not improve the pose of the closed form solver, the target is unreachable otherwise
+        if (solver.IsClosedForm())
         {
-            Vector tip = CalculateBonePositions(rootChain);
+            tip = CalculateBonePositions(rootChain, statistics);
             solver.SetTipPosition(tip);
+            count = i + 1;
+            StopChain(rootChain, solver.TargetReached() ? StopReason::reached : StopReason::stalled, solver.GetTargetPosition());
+            return count;
+        }
+    }
+    
+    if (solver.HasDependencies())
+    {
+        Vector tip = CalculateBonePositions(rootChain, statistics);
+        solver.SetTipPosition(tip);
+    }
+    return count;
+}
+
+size_t Skeleton::UpdateGroup(EffectorGroup& group, size_t iterations, ChainStatistics* statistics)
+{
+    size_t count        = iterations;
+    const Convergence& convergence = group.chains.front()->solver->GetConvergence();
+    real previousError  = std::numeric_limits<real>::max();
+    StopReason reason   = StopReason::exhausted;
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        ProfileZone iteration(ProfileScope::iteration, static_cast<uint32_t>(i));
+        // chains are calculated in the creation order, so the attached chains see the moved base bones
+        bool reached    = true;
+        real error      = 0;
+        for (RootChain* chain : group.chains)
+        {
+            Vector tip  = CalculateBonePositions(*chain, m_statisticsEnabled ? &chain->statistics : nullptr);
+            chain->solver->SetTipPosition(tip);
+            reached     = reached && chain->solver->TargetReached();
+            error       += glm::length(tip - chain->solver->GetTargetPosition());
+        }
+        if (reached)
+        {
+            count       = i;
+            reason      = StopReason::reached;
+            break;
+        }
+        // the stall is detected by the total distance of all effectors
+        if (convergence.stallThreshold > 0)
+        {
+            if (previousError - error < convergence.stallThreshold)
+            {
+                count   = i;
+                reason  = StopReason::stalled;
+                break;
+            }
+            previousError = error;
         }
+
+        {
+            ScopedTimer timer(statistics ? &statistics->solverTime : nullptr);
+            group.solver.Execute();
+        }
+    }
+
+    for (RootChain* chain : group.chains)
+    {
+        // chains attached to the group and chains targeting its bones read the final pose
+        if (reason == StopReason::exhausted)
+        {
+            Vector tip  = CalculateBonePositions(*chain, m_statisticsEnabled ? &chain->statistics : nullptr);
+            chain->solver->SetTipPosition(tip);
+        }
+        chain->stopReason   = reason;
+        chain->sleeping     = false;
     }
     return count;
 }
 
+void Skeleton::StopChain(RootChain& rootChain, StopReason reason, const Vector& target)
+{
+    // converged chain sleeps until its inputs change
+    rootChain.stopReason    = reason;
+    rootChain.sleeping      = true;
+    rootChain.sleepTarget   = target;
+}
+
+bool Skeleton::IsSleeping(const RootChain& rootChain, real threshold, const Vector& target) const
+{
+    if (!rootChain.sleeping)
+    {
+        return false;
+    }
+    // bones rotated by other chains or by the pose reset wake the chain
+    const ExecutionPlan::ChainRange& range = m_plan.ranges[rootChain.range];
+    for (size_t i = range.first; i < range.first + range.count; ++i)
+    {
+        if (m_plan.versions[i] != m_storage.versions[m_plan.slots[i]])
+        {
+            return false;
+        }
+    }
+
+    const real threshold2   = threshold * threshold;
+    if (glm::length2(target - rootChain.sleepTarget) > threshold2)
+    {
+        return false;
+    }
+    // the chain is attached to the base bone, so the movement of the base is estimated by the displacement of the tip
+    const size_t base       = rootChain.baseBone;
+    const Quaternion delta  = m_storage.globalOrientations[base] * glm::inverse(rootChain.baseOrientation);
+    const Vector tip        = m_storage.positions[base] + delta * (rootChain.tip - rootChain.basePosition);
+    return glm::length2(tip - rootChain.tip) <= threshold2;
+}
+
+size_t Skeleton::UpdateParallel(size_t iterations)
+{
+    m_iterations    = iterations;
+    m_steps         = iterations;
+    m_remaining     = 0;
+    for (size_t c = 0; c < m_chains.size(); ++c)
+    {
+        if (m_chains[c])
+        {
+            m_pending[c]  = m_schedule[c].dependencies;
+            ++m_remaining;
+        }
+    }
+
+    // tasks capture only the skeleton and the chain index, so they fit into the task without allocation
+    for (size_t c = 0; c < m_chains.size(); ++c)
+    {
+        if (m_chains[c] && !m_schedule[c].dependencies)
+        {
+            m_threadPool->Submit([this, c]() { SolveScheduled(c); });
+        }
+    }
+    // calling thread takes part in the execution
+    m_threadPool->Wait(m_remaining);
+    return m_steps;
+}
+
+void Skeleton::SolveScheduled(size_t chain)
+{
+    size_t steps    = UpdateChain(*m_chains[chain], m_iterations);
+    size_t current  = m_steps.load();
+    while (steps < current && !m_steps.compare_exchange_weak(current, steps))
+    {
+    }
+    // chain is solved, release the chains that wait for it
+    for (size_t successor : m_schedule[chain].successors)
+    {
+        if (m_pending[successor].fetch_sub(1) == 1)
+        {
+            m_threadPool->Submit([this, successor]() { SolveScheduled(successor); });
+        }
+    }
+    m_remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void Skeleton::BuildSchedule()
+{
+    m_schedule.assign(m_chains.size(), ChainNode{});
+    m_pending       = std::make_unique<std::atomic<size_t>[]>(m_chains.size());
+    // the first chain of the group solves all members, so the member bones are calculated by it
+    //  and the target of the member is read by it
+    std::vector<size_t> executors(m_chains.size());
+    std::iota(executors.begin(), executors.end(), 0);
+    for (const auto& group : m_groups)
+    {
+        const size_t first = FindChainIndex(*group->chains.front()->solver);
+        for (const RootChain* member : group->chains)
+        {
+            executors[FindChainIndex(*member->solver)] = first;
+        }
+    }
+    // chains that calculate the state of each storage slot in the order of execution, chains share the slots
+    //  if the IK part of the later chain starts at or above the bones of the earlier one
+    std::vector<std::vector<size_t>> writers(m_storage.Size());
+    for (size_t c = 0; c < m_chains.size(); ++c)
+    {
+        if (m_chains[c])
+        {
+            for (size_t slot : GetSlots(*m_chains[c]))
+            {
+                writers[slot].emplace_back(executors[c]);
+            }
+        }
+    }
+    for (auto& slotWriters : writers)
+    {
+        std::sort(slotWriters.begin(), slotWriters.end());
+        slotWriters.erase(std::unique(slotWriters.begin(), slotWriters.end()), slotWriters.end());
+    }
+
+    auto link = [this](size_t from, size_t to)
+    {
+        if (from == to)
+        {
+            return;
+        }
+        auto& successors = m_schedule[from].successors;
+        if (std::find(successors.begin(), successors.end(), to) == successors.end())
+        {
+            successors.emplace_back(to);
+            ++m_schedule[to].dependencies;
+        }
+    };
+    // the slot is read in the same order as in sequential execution: 
+    //  after it is updated by the earlier chain, and before it is updated by the later one
+    auto read = [&](size_t slot, size_t reader)
+    {
+        const auto& slotWriters = writers[slot];
+        auto next = std::lower_bound(slotWriters.begin(), slotWriters.end(), reader);
+        if (next != slotWriters.begin())
+        {
+            link(*std::prev(next), reader);
+        }
+        if (next != slotWriters.end() && *next == reader)
+        {
+            ++next;
+        }
+        if (next != slotWriters.end())
+        {
+            link(reader, *next);
+        }
+    };
+
+    // every chain that calculates the slot waits for the previous one
+    for (const auto& slotWriters : writers)
+    {
+        for (size_t i = 1; i < slotWriters.size(); ++i)
+        {
+            link(slotWriters[i - 1], slotWriters[i]);
+        }
+    }
+    for (size_t c = 0; c < m_chains.size(); ++c)
+    {
+        if (!m_chains[c])
+        {
+            continue;
+        }
+        // chain starts from the bone calculated by the parent chain
+        read(m_chains[c]->baseBone, executors[c]);
+
+        const Target* target    = m_chains[c]->solver->GetTarget();
+        const Bone* bone        = target ? target->GetBone() : nullptr;
+        if (bone)
+        {
+            read(bone->GetIndex(), executors[c]);
+        }
+    }
+    m_scheduleDirty = false;
+}
+
+void Skeleton::BuildBatches()
+{
+    // level of the chain is the longest path to it in the dependency graph, chains of one level are independent
+    std::vector<size_t> levels(m_chains.size(), 0);
+    std::vector<size_t> pending(m_chains.size());
+    std::vector<size_t> ready;
+    for (size_t c = 0; c < m_chains.size(); ++c)
+    {
+        pending[c] = m_schedule[c].dependencies;
+        if (m_chains[c] && !pending[c])
+        {
+            ready.emplace_back(c);
+        }
+    }
+    while (!ready.empty())
+    {
+        const size_t chain = ready.back();
+        ready.pop_back();
+        for (size_t successor : m_schedule[chain].successors)
+        {
+            levels[successor] = std::max(levels[successor], levels[chain] + 1);
+            if (--pending[successor] == 0)
+            {
+                ready.emplace_back(successor);
+            }
+        }
+    }
+
+    auto kind = [this](size_t chain)
+    {
+        return m_chains[chain]->group ? ExecutionPlan::SolverKind::group : m_chains[chain]->kind;
+    };
+    m_plan.batchChains.clear();
+    for (size_t c = 0; c < m_chains.size(); ++c)
+    {
+        if (m_chains[c])
+        {
+            m_plan.batchChains.emplace_back(static_cast<ExecutionPlan::Index>(c));
+        }
+    }
+    std::sort(m_plan.batchChains.begin(), m_plan.batchChains.end(), [&](ExecutionPlan::Index left, ExecutionPlan::Index right)
+    {
+        return std::tuple(levels[left], kind(left), left) < std::tuple(levels[right], kind(right), right);
+    });
+
+    m_plan.batches.clear();
+    for (size_t i = 0; i < m_plan.batchChains.size(); ++i)
+    {
+        const ExecutionPlan::SolverKind current = kind(m_plan.batchChains[i]);
+        if (m_plan.batches.empty() || m_plan.batches.back().kind != current)
+        {
+            m_plan.batches.push_back({current, static_cast<ExecutionPlan::Index>(i), 0});
+        }
+        ++m_plan.batches.back().count;
+    }
+}
+
+void Skeleton::EnableStatistics(bool enable)
+{
+#ifdef LIGHT_IK_STATISTICS
+    m_statisticsEnabled = enable;
+    ResetStatistics();
+#endif
+}
+
+void Skeleton::ResetStatistics()
+{
+    m_statistics        = {};
+    for (auto& chain : m_chains)
+    {
+        if (chain)
+        {
+            chain->statistics = {};
+        }
+    }
+#ifdef LIGHT_IK_STATISTICS
+    std::fill(m_storage.clamps.begin(), m_storage.clamps.end(), 0);
+#endif
+}
+
+const ChainStatistics& Skeleton::GetStatistics(const SolverBase& solver) const
+{
+    size_t index = FindChainIndex(solver);
+    assert(index < m_chains.size());
+    return m_chains[index]->statistics;
+}
+
+ChainStatistics* Skeleton::StartStatistics(RootChain& rootChain)
+{
+    if (!m_statisticsEnabled)
+    {
+        return nullptr;
+    }
+    ChainStatistics& statistics = rootChain.statistics;
+    statistics.kinematicsTime   = 0;
+    statistics.solverTime       = 0;
+    return &statistics;
+}
+
+void Skeleton::RecordStatistics(RootChain& rootChain, size_t iterations, const Vector& tip, const Vector& target)
+{
+    ChainStatistics& statistics = rootChain.statistics;
+    statistics.iterations       = iterations;
+    statistics.error            = glm::length(tip - target);
+    statistics.stopReason       = rootChain.stopReason;
+    statistics.clamps           = 0;
+#ifdef LIGHT_IK_STATISTICS
+    // bones of the chain are rotated only by its solver or by its group, so the counters are not shared between threads
+    for (size_t slot : GetSlots(rootChain))
+    {
+        statistics.clamps       += m_storage.clamps[slot];
+        m_storage.clamps[slot]  = 0;
+    }
+#endif
+    const uint64_t time         = statistics.kinematicsTime + statistics.solverTime;
+    ++statistics.updates;
+    statistics.totalTime        += time;
+    statistics.maxTime          = std::max(statistics.maxTime, time);
+}
+
+void Skeleton::AggregateStatistics()
+{
+    ++m_statistics.updates;
+    for (auto& chain : m_chains)
+    {
+        if (chain)
+        {
+            const ChainStatistics& statistics = chain->statistics;
+            m_statistics.iterations.Add(statistics.iterations);
+            m_statistics.time.Add(statistics.kinematicsTime + statistics.solverTime);
+            m_statistics.clamps.Add(statistics.clamps);
+            ++m_statistics.stopReasons[static_cast<size_t>(statistics.stopReason)];
+        }
+    }
+}
+
+bool Skeleton::DependsOn(const SolverBase& chain, const SolverBase& dependency)
+{
+    Finalize();
+    size_t index        = FindChainIndex(chain);
+    size_t parent       = FindChainIndex(dependency);
+    if (index >= m_chains.size() || parent >= m_chains.size())
+    {
+        return false;
+    }
+    const auto& successors = m_schedule[parent].successors;
+    return std::find(successors.begin(), successors.end(), index) != successors.end();
+}
+
 void Skeleton::FinalizeChains()
 {
     for (auto& chain : m_chains)
     {
+        if (!chain)
+        {
+            continue;
+        }
         Vector tip = CalculateBonePositions(*chain);
         chain->solver->SetTipPosition(tip);
     }
 }
 
-const std::vector<BoneRef>& Skeleton::GetRootChain(const SolverBase& solver) const    
+const BoneSubchain& Skeleton::GetRootChain(const SolverBase& solver) const    
 { 
     size_t index = FindChainIndex(solver);
 
-    static const std::vector<BoneRef> stub = {};
+    static const BoneSubchain stub = {};
     if (index >= m_chains.size())
     {
         return stub;
@@ -215,12 +925,133 @@ const std::vector<BoneRef>& Skeleton::GetRootChain(const SolverBase& solver) con
     return m_chains[index]->chain; 
 }
 
+size_t Skeleton::GetBaseBone(const SolverBase& solver) const
+{
+    size_t index = FindChainIndex(solver);
+    assert(index < m_chains.size());
+    return m_chains[index]->baseBone;
+}
+
+StopReason Skeleton::GetStopReason(const SolverBase& solver) const
+{
+    size_t index = FindChainIndex(solver);
+    assert(index < m_chains.size());
+    return m_chains[index]->stopReason;
+}
+
+bool Skeleton::SetPole(SolverBase& solver, const std::optional<Vector>& pole)
+{
+    size_t index = FindChainIndex(solver);
+    assert(index < m_chains.size());
+    m_chains[index]->sleeping = false;
+    return solver.SetPole(pole);
+}
+
+bool Skeleton::AddEffectorGroup(const std::vector<SolverRef>& solvers, real damping)
+{
+    constexpr size_t none = -1LLU;
+
+    // passive chains give their bones to the group, IK chains give their IK bones and the tip as the effector
+    std::vector<size_t> members;
+    size_t effectorsCount = 0;
+    for (const SolverRef& solver : solvers)
+    {
+        size_t index = FindChainIndex(solver);
+        if (index >= m_chains.size() || m_chains[index]->group)
+        {
+            return false;
+        }
+        members.emplace_back(index);
+        effectorsCount += solver.get().GetChainSize() ? 1 : 0;
+    }
+    std::sort(members.begin(), members.end());
+    if (members.size() < 2 || !effectorsCount || effectorsCount > SolverDls::MaxEffectors ||
+        std::adjacent_find(members.begin(), members.end()) != members.end())
+    {
+        return false;
+    }
+
+    // the chain that created each storage slot, the later chains may list the slot again in their IK part
+    std::vector<size_t> owners(m_storage.Size(), none);
+    for (size_t c = 0; c < m_chains.size(); ++c)
+    {
+        if (m_chains[c])
+        {
+            for (size_t slot : GetSlots(*m_chains[c]))
+            {
+                owners[slot] = owners[slot] == none ? c : owners[slot];
+            }
+        }
+    }
+
+    // the effectors moved by each slot: the bones of the chain and of the chains it is attached to, up to the base bones
+    std::vector<uint32_t> effectors(m_storage.Size(), 0);
+    size_t effector = 0;
+    for (size_t index : members)
+    {
+        const RootChain& member = *m_chains[index];
+        const uint32_t bit  = member.solver->GetChainSize() ? 1u << effector++ : 0;
+        // the skeleton root is not moved by the group, so the chains that start from it do not need the ancestors
+        bool attached       = index == members.front() || member.baseBone == m_rootSlot;
+        for (size_t slot : GetSlots(member))
+        {
+            effectors[slot] |= bit;
+        }
+        for (size_t base = member.baseBone; !attached; base = m_chains[owners[base]]->baseBone)
+        {
+            // the group is solved by its first chain, so the chains between it and the member must be in the group too
+            if (base == m_rootSlot || !std::binary_search(members.begin(), members.end(), owners[base]))
+            {
+                return false;
+            }
+            for (size_t slot : GetSlots(*m_chains[owners[base]]))
+            {
+                effectors[slot] |= bit;
+                if (slot == base)
+                {
+                    break;
+                }
+            }
+            attached        = owners[base] == members.front();
+        }
+    }
+
+    ArenaPtr<EffectorGroup> group = m_arena.Make<EffectorGroup>(m_arena.GetResource(), m_storage);
+    group->solver.SetDamping(damping);
+    // bones shared by the members are rotated once, their masks hold the effectors of all members
+    std::vector<bool> added(m_storage.Size(), false);
+    for (size_t index : members)
+    {
+        RootChain& chain    = *m_chains[index];
+        const auto slots    = GetSlots(chain);
+        const size_t first  = chain.solver->GetChainSize() ? slots.size() - chain.solver->GetChainSize() : 0;
+        for (size_t i = first; i < slots.size(); ++i)
+        {
+            if (!added[slots[i]])
+            {
+                group->solver.AddBone(slots[i], i ? slots[i - 1] : chain.baseBone, effectors[slots[i]]);
+                added[slots[i]] = true;
+            }
+        }
+        if (chain.solver->GetChainSize())
+        {
+            group->solver.AddEffector(*chain.solver);
+        }
+        group->chains.emplace_back(&chain);
+        chain.group         = group.get();
+    }
+    m_groups.emplace_back(std::move(group));
+    // group members are executed by the group batch
+    m_scheduleDirty         = true;
+    return true;
+}
+
 size_t Skeleton::FindChainIndex(const SolverBase& solver) const
 {
     size_t index = 0;
     for (auto& chain : m_chains)
     {
-        if (chain->solver.get() == (SolverBase*)&solver)
+        if (chain && chain->solver.get() == (SolverBase*)&solver)
         {
             return index;
         }
@@ -229,6 +1060,12 @@ size_t Skeleton::FindChainIndex(const SolverBase& solver) const
     return -1LLU;
 }
 
+std::span<const ExecutionPlan::Index> Skeleton::GetSlots(const RootChain& chain) const
+{
+    const ExecutionPlan::ChainRange& range = m_plan.ranges[chain.range];
+    return {m_plan.slots.data() + range.first, range.count};
+}
+
 std::pair<bool, BoneRef> Skeleton::AddBone(const BoneDesc& description)
 {
     // add new bone to the chain
@@ -239,55 +1076,117 @@ std::pair<bool, BoneRef> Skeleton::AddBone(const BoneDesc& description)
     // if bone already exists, return the existing bone, otherwise create a new bone and attach it to current chain
     if (!bone)
     {
-        bone = std::make_unique<Bone>(description.length, description.orientation);
+        assert(m_views.size() < m_views.capacity());
+        bone = &m_views.emplace_back(m_storage, m_storage.Add(description.length, description.orientation));
     }
         
     return {created, *bone};
 }
 
+void Skeleton::AddRootChainBones(RootChain& rootChain, const std::vector<BoneDesc>& descriptors, size_t first)
+{
+    rootChain.chain.reserve(descriptors.size() - first);
+    for (size_t i = first; i < descriptors.size(); ++i)
+    {
+        Bone& bone = AddBone(descriptors[i]).second;
+        rootChain.chain.emplace_back(bone);
+    }
+    // chains are created after their base bones, so the appended range keeps the plan topologically ordered
+    rootChain.range = m_plan.Append(m_storage, rootChain.chain | std::views::transform([](const Bone& bone) { return bone.GetIndex(); }), 
+        rootChain.baseBone);
+}
+
+Vector Skeleton::CalculateBonePositions(RootChain& rootChain, ChainStatistics* statistics)
+{
+    ScopedTimer timer(statistics ? &statistics->kinematicsTime : nullptr);
+    return CalculateBonePositions(rootChain);
+}
+
 Vector Skeleton::CalculateBonePositions(RootChain& rootChain)
 {   
-    auto& chain = rootChain.chain;
+    ProfileZone zone(ProfileScope::kinematics, rootChain.range);
+    const ExecutionPlan::ChainRange& range = m_plan.ranges[rootChain.range];
     // Chain must have at least one bone
-    assert(chain.size() > 0);
+    assert(range.count > 0);
+
+    const ExecutionPlan::Index* slots   = m_plan.slots.data() + range.first;
+    const ExecutionPlan::Index* parents = m_plan.parents.data() + range.first;
+    const real* lengths                 = m_plan.lengths.data() + range.first;
+    uint32_t* chainVersions             = m_plan.versions.data() + range.first;
+    const size_t count                  = range.count;
+
+    auto& positions                     = m_storage.positions;
+    auto& globalOrientations            = m_storage.globalOrientations;
+    const auto& rotations               = m_storage.rotations;
+    const auto& versions                = m_storage.versions;
     // Front kinematics: separated from the solver to make the functionality common and independent from any solvers 
     // Front kinematic always calculated from the chain root position - the bone that either root of overall skeleton,
     //  or bone of the parent IK chain
-    Quaternion rotation                 = rootChain.baseBone.get().GetGlobalOrientation();
-    Vector position                     = rootChain.baseBone.get().GetPosition()+ (rotation * Helpers::DefaultAxis() * rootChain.baseBone.get().GetLength());
+    const size_t base                   = range.base;
+    size_t first                        = 0;
+    if (rootChain.calculated && rootChain.baseOrientation == globalOrientations[base] && rootChain.basePosition == positions[base])
+    {
+        // bones before the first modified one keep their positions
+        while (first < count && chainVersions[first] == versions[slots[first]])
+        {
+            ++first;
+        }
+        if (first == count)
+        {
+            return rootChain.tip;
+        }
+    }
+    else
+    {
+        rootChain.baseOrientation       = globalOrientations[base];
+        rootChain.basePosition          = positions[base];
+        rootChain.calculated            = true;
+    }
+
+    // inputs of the chain were changed, converged state is not valid anymore
+    rootChain.sleeping                  = false;
 
-    for (size_t i = 0; i < chain.size(); ++i)
+    const size_t parent                 = parents[first];
+    Quaternion rotation                 = globalOrientations[parent];
+    Vector position                     = positions[parent] + (rotation * Helpers::DefaultAxis() * 
+                                            (first ? lengths[first - 1] : m_storage.lengths[parent].l));
+
+    for (size_t i = first; i < count; ++i)
     {
-        chain[i].get().SetPosition(position);
+        const size_t slot               = slots[i];
+        positions[slot]                 = position;
         // Calculate cumuilative change of orientation of the current bone
-        rotation                        = rotation * chain[i].get().GetRotation();
-        chain[i].get().SetGlobalOrientation(rotation);
+        rotation                        = rotation * rotations[slot];
+        globalOrientations[slot]        = rotation;
+        chainVersions[i]                = versions[slot];
         // Find the new position of the bone base joint
-        position                        = position + (rotation * Helpers::DefaultAxis() * chain[i].get().GetLength());
+        position                        = position + (rotation * Helpers::DefaultAxis() * lengths[i]);
     }
+    rootChain.tip                       = position;
     return position;
 }
 
 void Skeleton::ResetIK()
 {
+    // chains and solvers do not own any memory outside of the arena, so it is released at once after them
+    m_groups.clear();
     m_chains.clear();
+    m_plan.Clear();
+    m_planDirty         = false;
+    m_schedule.clear();
+    m_arena.Reset();
+    m_scheduleDirty     = true;
     // reset all created bones to build skeletal structure from scratch
-    // TO THINK: suboptimal algorithm
-    for (auto& bone : m_bones)
-    {
-        bone = nullptr;
-    }
+    std::fill(m_bones.begin(), m_bones.end(), nullptr);
+    m_views.clear();
+    m_storage.Clear();
+
+    m_views.emplace_back(m_storage, m_storage.Add(0, glm::identity<Quaternion>()));
 }
 
 void Skeleton::ResetPose()
 {
-    for (auto& bone : m_bones)
-    {
-        if (bone)
-        {
-            bone->Reset();
-        }
-    }
+    m_storage.ResetPose();
     FinalizeChains();
 }
 
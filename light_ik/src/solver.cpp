@@ -16,23 +16,28 @@ namespace LightIK
 {
 
 Solver::Solver(BoneSubchain&& chain, const Bone& parentBone, Target& target)
-    : m_chain(std::move(chain))
+    : m_storage(parentBone.GetStorage())
+    , m_parentBone(parentBone.GetIndex())
+    , m_chain(std::move(chain))
+    , m_slots(m_chain.get_allocator())
     , m_target(target)
-    , m_parentBone(parentBone)
 {
     assert(m_chain.size());
     m_cumulativeRotation    = glm::identity<Quaternion>();
     
-    // assign owner for each bone in the chain
+    // assign owner for each bone in the chain and collect their storage slots
+    m_slots.reserve(m_chain.size());
     for (auto& bone : m_chain)
     {
+        assert(&bone.get().GetStorage() == &m_storage);
         bone.get().SetOwner(this);
+        m_slots.emplace_back(bone.get().GetIndex());
     }
 }
 
 Vector Solver::GetRootPosition() const
 {
-    return m_chain[0].get().GetPosition();
+    return m_storage.positions[m_slots.front()];
 }
 
 const BoneSubchain& Solver::GetChain() const
@@ -62,22 +67,22 @@ void Solver::LookAt(const Vector& initialDirection, const Vector& target)
 void Solver::Execute()
 {   
     // inverse kinematics: iterative
-    if (m_chain.empty())
+    if (m_slots.empty())
     {
         return;
     }
-    Bone& rootBone          = m_chain.front();
+    const size_t rootBone   = m_slots.front();
+    const Vector rootPosition = m_storage.positions[rootBone];
     // Assume distance to target is reachable
-    Vector target           = m_target.GetPosition() - rootBone.GetPosition();
+    Vector target           = m_target.GetSolverPosition() - rootPosition;
     m_cumulativeRotation    = glm::identity<Quaternion>();
 
-    Bone&  chainEnd         = m_chain.back();
-    Vector chainTip         = m_tipPosition - rootBone.GetPosition();
+    Vector chainTip         = m_tipPosition - rootPosition;
 
-    for (size_t i = m_chain.size() - 1; i > 0; --i)
+    for (size_t i = m_slots.size() - 1; i > 0; --i)
     {
         // rotate the root part of the chain according to the accumulated rotations
-        Vector currentJoint = m_cumulativeRotation * (m_chain[i].get().GetPosition() -  rootBone.GetPosition());
+        Vector currentJoint = m_cumulativeRotation * (m_storage.positions[m_slots[i]] - rootPosition);
         // calculate simple joint consists of chain before and after the joint
         Vector tip = chainTip - currentJoint;
         if (glm::length2(tip) < EPSILON)
@@ -85,7 +90,7 @@ void Solver::Execute()
             // if arm length is equal to 0, the step cannot provide any position change, skip it;
             continue;
         }
-        chainTip = SolveBinaryJoint(m_chain[i], m_chain[i - 1], currentJoint, tip, target);
+        chainTip = SolveBinaryJoint(m_slots[i], m_slots[i - 1], currentJoint, tip, target);
     }
     
     // final step, the chain might not reach the final direction, due to joint stiffness
@@ -93,11 +98,11 @@ void Solver::Execute()
     LookAt(chainTip, target);
 
     // Calculate relative rotation of the current bone according to the orienation of its parent bone
-    auto parentOrientation  = m_parentBone.GetGlobalOrientation();
+    auto parentOrientation  = m_storage.globalOrientations[m_parentBone];
     
     // Applying constraints for the child bone
-    auto childRotation = rootBone.ApplyConstraint(glm::inverse(parentOrientation) * m_cumulativeRotation * rootBone.GetGlobalOrientation());
-    rootBone.SetRotation(childRotation); 
+    auto childRotation = m_storage.ApplyConstraint(rootBone, glm::inverse(parentOrientation) * m_cumulativeRotation * m_storage.globalOrientations[rootBone]);
+    m_storage.SetRotation(rootBone, childRotation);
 
     // recalculate tip rotation and target position according to constraints of the child bone
     // tipRotation             = parentOrientation * childRotation * glm::inverse(childOrientation);
@@ -108,10 +113,10 @@ void Solver::Execute()
 
 bool Solver::TargetReached() const
 {
-    return glm::length2(m_tipPosition - m_target.GetPosition()) < EPSILON;
+    return glm::length2(m_tipPosition - m_target.GetSolverPosition()) < m_convergence.tolerance * m_convergence.tolerance;
 }
 
-Vector Solver::SolveBinaryJoint(Bone& bone, const Bone& parent, const Vector& root, const Vector& tip, const Vector& target)
+Vector Solver::SolveBinaryJoint(size_t bone, size_t parent, const Vector& root, const Vector& tip, const Vector& target)
 {
     // Position local coordinate system to have root bone aligned with Y axis and with target forms XoY plane.
     // Make the working plane, the plane made by 2 vectors: initial arm and vector to target
@@ -124,30 +129,32 @@ Vector Solver::SolveBinaryJoint(Bone& bone, const Bone& parent, const Vector& ro
     // Calculate angles required to reach the target with current binary joint
     auto angles             = CalculateAngles(lengthRoot, lengthTip, {glm::dot(target, x), glm::dot(target, y)});
     // Calculate modifications for the chain root
-    Quaternion rootRotation = glm::angleAxis(glm::pi<real>() / (real)2.0 - angles.first, z); 
+    Quaternion rootRotation = Math::AngleAxis(glm::pi<real>() / (real)2.0 - angles.first, z); 
 
     // Rotate whole chain according to root rotation to calculate relative tip rotation angle.
     Vector currentTip       = rootRotation * glm::normalize(tip);
 
     // TODO: recalculate tip angle if constraints are applied to target the actial tip position
     real tipFullAngle       = angles.first - angles.second;
-    Vector newTip           = x * glm::cos(tipFullAngle) + y * glm::sin(tipFullAngle);
+    real tipSine, tipCosine;
+    Math::SinCos(tipFullAngle, tipSine, tipCosine);
+    Vector newTip           = x * tipCosine + y * tipSine;
 
     // Calculate full rotation of the root bone according to all available root constraints
-    m_cumulativeRotation    = m_chain.front().get().ApplyConstraint(glm::normalize(rootRotation * m_cumulativeRotation));
+    m_cumulativeRotation    = m_storage.ApplyConstraint(m_slots.front(), glm::normalize(rootRotation * m_cumulativeRotation));
 
     // Apply constraints to rotation
-    auto& constraint        = bone.GetConstraints();
+    auto& constraint        = m_storage.constraints[bone];
     auto tipRotationParams  = Helpers::CalculateParameters(currentTip, newTip);
-    Quaternion tipRotation  = glm::angleAxis(tipRotationParams.angle * constraint.flexibility, tipRotationParams.axis);
+    Quaternion tipRotation  = Math::AngleAxis(tipRotationParams.angle * constraint.flexibility, tipRotationParams.axis);
     
     // Calculate relative rotation of the current bone according to the orienation of its parent bone
-    auto parentOrientation  = m_cumulativeRotation * parent.GetGlobalOrientation();
-    auto childOrientation   = m_cumulativeRotation * bone.GetGlobalOrientation();
+    auto parentOrientation  = m_cumulativeRotation * m_storage.globalOrientations[parent];
+    auto childOrientation   = m_cumulativeRotation * m_storage.globalOrientations[bone];
     
     // Applying constraints for the child bone
-    auto childRotation = bone.ApplyConstraint(glm::inverse(parentOrientation) * tipRotation * childOrientation);
-    bone.SetRotation(childRotation); 
+    auto childRotation = m_storage.ApplyConstraint(bone, glm::inverse(parentOrientation) * tipRotation * childOrientation);
+    m_storage.SetRotation(bone, childRotation);
 
     // recalculate tip rotation and target position according to constraints of the child bone
     tipRotation             = parentOrientation * childRotation * glm::inverse(childOrientation);
@@ -160,24 +167,24 @@ std::pair<real, real> Solver::CalculateAngles(const Length& root, const Length&
 {
     // according to algorithm, x cannot be negative, but it is possible due to FP error,
     // assuming that algorithm is correct with faith in our harts enforce x to 0 and hope that it will not spoil the result
-    chord.x                 = std::max(chord.x, 0.0);
+    chord.x                 = std::max(chord.x, (real)0);
     
     // 1st part of the rule of triangle x < y + z
     real chordLength        = glm::clamp(glm::length(chord), root.l - tip.l, root.l + tip.l);
     real lbsq               = chordLength * chordLength;
     // calculate local angles on the given coordinate system
     // TODO: check low values of chord.y
-    real angleChord         = (chord.x > EPSILON) ? glm::atan(chord.y/chord.x) : glm::sign(chord.y) * glm::pi<real>() / 2.0;
+    real angleChord         = (chord.x > EPSILON) ? Math::Atan(chord.y/chord.x) : glm::sign(chord.y) * glm::pi<real>() / (real)2;
  
     // according to the article, calculate position of bones on the coordinate system, 
     // https://www.learnaboutrobots.com/inverseKinematics.htm
     // Angle between x axis and new direction of the root
     // TODO: check clamp, maybe not needed?
     real angleRoot          = lbsq > EPSILON 
-                            ? angleChord + glm::acos(glm::clamp((root.l2 - tip.l2 + lbsq) / (2 * root.l * chordLength), (real)-1., (real)1.)) 
-                            : 0;
+                            ? angleChord + Helpers::TriangleAngle(root.l, chordLength, tip.l)
+                            : (real)0;
     // According the article angle between root and tip can be calculated this way
-    real angleJoint         = glm::acos(glm::clamp((root.l2 + tip.l2 - lbsq) / (2 * root.l * tip.l), (real)-1., (real)1.));
+    real angleJoint         = Helpers::TriangleAngle(root.l, tip.l, chordLength);
     // Modify the angle, to make it the angle between previous bone axis and actual direction on the arm tip.
     angleJoint              = glm::pi<real>() - angleJoint;
 
@@ -0,0 +1,217 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "solver_batch.h"
+#include "helpers.h"
+
+namespace LightIK
+{
+
+SolverBatch::SolverBatch(const BoneStorage& rig, std::vector<size_t>&& rootChain, size_t baseBone, size_t chainSize)
+    : m_rig(rig)
+    , m_rootChain(std::move(rootChain))
+    , m_baseBone(baseBone)
+    , m_parentBone(baseBone)
+{
+    assert(m_rootChain.size() >= chainSize);
+    // IK chain is always the tail of the root chain
+    size_t chainStart = m_rootChain.size() - chainSize;
+    m_slots.assign(m_rootChain.begin() + chainStart, m_rootChain.end());
+    if (chainStart)
+    {
+        m_parentBone = m_rootChain[chainStart - 1];
+    }
+}
+
+PackVector SolverBatch::CalculateBonePositions(PoseBlock& pose) const
+{
+    const PackVector axis               = PackVector::Broadcast(Helpers::DefaultAxis());
+
+    PackQuaternion rotation             = pose.globalOrientations[m_baseBone];
+    PackVector position                 = pose.positions[m_baseBone] + (rotation * axis) * m_rig.lengths[m_baseBone].l;
+
+    for (size_t slot : m_rootChain)
+    {
+        pose.positions[slot]            = position;
+        rotation                        = rotation * pose.rotations[slot];
+        pose.globalOrientations[slot]   = rotation;
+        position                        = position + (rotation * axis) * m_rig.lengths[slot].l;
+    }
+    return position;
+}
+
+PackMask SolverBatch::TargetReached(const PackVector& tip, const PackVector& target) const
+{
+    if (IsPassive())
+    {
+        return PackMask::Broadcast(true);
+    }
+    return Length2(tip - target) < EPSILON;
+}
+
+void SolverBatch::Execute(PoseBlock& pose, const PackVector& tipPosition, const PackVector& targetPosition, const PackMask& active) const
+{
+    if (IsPassive())
+    {
+        return;
+    }
+    if (IsClosedForm())
+    {
+        ExecuteTwoBone(pose, targetPosition, active);
+        return;
+    }
+    const size_t rootBone               = m_slots.front();
+    const PackVector rootPosition       = pose.positions[rootBone];
+    const PackVector target             = targetPosition - rootPosition;
+    PackQuaternion cumulativeRotation   = PackQuaternion::Identity();
+
+    PackVector chainTip                 = tipPosition - rootPosition;
+
+    for (size_t i = m_slots.size() - 1; i > 0; --i)
+    {
+        PackVector currentJoint         = cumulativeRotation * (pose.positions[m_slots[i]] - rootPosition);
+        PackVector tip                  = chainTip - currentJoint;
+        // if arm length is equal to 0, the step cannot provide any position change, skip it for this instance
+        PackMask solve                  = active && !(Length2(tip) < EPSILON);
+        PackVector newTip               = SolveBinaryJoint(pose, m_slots[i], m_slots[i - 1], currentJoint, tip, target, cumulativeRotation, solve);
+        chainTip                        = Select(solve, newTip, chainTip);
+    }
+
+    // final rotation of the root bone to look at the target
+    PackMask look                       = Length2(target) > EPSILON;
+    cumulativeRotation                  = Select(look, 
+                                            PackHelpers::CalculateRotation(Normalize(chainTip), Normalize(target)) * cumulativeRotation, 
+                                            cumulativeRotation);
+
+    const PackQuaternion& parentOrientation = pose.globalOrientations[m_parentBone];
+    PackQuaternion childRotation        = ApplyConstraint(rootBone, Inverse(parentOrientation) * cumulativeRotation * pose.globalOrientations[rootBone]);
+    pose.rotations[rootBone]            = Select(active, childRotation, pose.rotations[rootBone]);
+}
+
+void SolverBatch::ExecuteTwoBone(PoseBlock& pose, const PackVector& targetPosition, const PackMask& active) const
+{
+    const PackVector axis               = PackVector::Broadcast(Helpers::DefaultAxis());
+    const size_t rootBone               = m_slots[0];
+    const size_t middleBone             = m_slots[1];
+    const real rootLength               = m_rig.lengths[rootBone].l;
+    const real tipLength                = m_rig.lengths[middleBone].l;
+
+    const PackVector rootPosition       = pose.positions[rootBone];
+    const PackVector toTarget           = targetPosition - rootPosition;
+    const Pack distance                 = Sqrt(Length2(toTarget));
+    // target in the root joint leaves the pose of the instance as is
+    const PackMask solve                = active && !(Length2(toTarget) < EPSILON);
+    const PackVector direction          = Normalize(toTarget);
+
+    // the middle joint keeps the current bending plane
+    const PackVector bend               = Cross(PackHelpers::Normal(direction, pose.positions[middleBone] - rootPosition), direction);
+
+    const Pack reach                    = Clamp(distance, std::abs(rootLength - tipLength), rootLength + tipLength);
+    const Pack rootAngle                = PackHelpers::TriangleAngle(Pack::Broadcast(rootLength), reach, Pack::Broadcast(tipLength));
+    Pack sine, cosine;
+    SinCos(rootAngle, sine, cosine);
+    const PackVector rootDirection      = direction * cosine + bend * sine;
+
+    // the second bone closes the triangle as if the root bone had already turned
+    const PackQuaternion& parentOrientation = pose.globalOrientations[m_parentBone];
+    const PackQuaternion& rootOrientation   = pose.globalOrientations[rootBone];
+    PackQuaternion newRootOrientation   = PackHelpers::CalculateRotation(rootOrientation * axis, rootDirection) * rootOrientation;
+    const PackQuaternion middleOrientation  = newRootOrientation * pose.rotations[middleBone];
+    const PackVector middleDirection    = direction * reach - rootDirection * rootLength;
+
+    PackVector swingAxis;
+    Pack swingAngle;
+    PackHelpers::CalculateParameters(middleOrientation * axis, Normalize(middleDirection), swingAxis, swingAngle);
+    const PackQuaternion swing          = Select(Length2(middleDirection) < EPSILON, 
+                                            PackQuaternion::Identity(), 
+                                            AngleAxis(swingAngle * m_rig.constraints[middleBone].flexibility, swingAxis));
+    const PackQuaternion middleRotation = ApplyConstraint(middleBone, Inverse(newRootOrientation) * swing * middleOrientation);
+
+    // the root bone aims the actual tip at the target
+    const PackVector tip                = rootDirection * rootLength + (newRootOrientation * middleRotation * axis) * tipLength;
+    newRootOrientation                  = Select(Length2(tip) > EPSILON,
+                                            PackHelpers::CalculateRotation(Normalize(tip), direction) * newRootOrientation,
+                                            newRootOrientation);
+
+    const PackQuaternion rootRotation   = ApplyConstraint(rootBone, Inverse(parentOrientation) * newRootOrientation);
+    pose.rotations[rootBone]            = Select(solve, rootRotation, pose.rotations[rootBone]);
+    pose.rotations[middleBone]          = Select(solve, middleRotation, pose.rotations[middleBone]);
+}
+
+PackVector SolverBatch::SolveBinaryJoint(PoseBlock& pose, size_t bone, size_t parent, const PackVector& root, const PackVector& tip, 
+    const PackVector& target, PackQuaternion& cumulativeRotation, const PackMask& active) const
+{
+    // Position local coordinate system to have root bone aligned with Y axis and with target forms XoY plane.
+    const PackVector y                  = Normalize(root);
+    const PackVector z                  = PackHelpers::Normal(y, Normalize(target));
+    const PackVector x                  = Normalize(Cross(z, y));
+
+    const Pack rootLength               = Sqrt(Length2(root));
+    const Pack tipLength                = Sqrt(Length2(tip));
+
+    Pack angleRoot, angleJoint;
+    CalculateAngles(rootLength, tipLength, Dot(target, x), Dot(target, y), angleRoot, angleJoint);
+
+    const PackQuaternion rootRotation   = AngleAxis(glm::pi<real>() / (real)2.0 - angleRoot, z);
+    const PackVector currentTip         = rootRotation * Normalize(tip);
+
+    const Pack tipFullAngle             = angleRoot - angleJoint;
+    PackVector newTip                   = x * Cos(tipFullAngle) + y * Sin(tipFullAngle);
+
+    const PackQuaternion cumulative     = ApplyConstraint(m_slots.front(), Normalize(rootRotation * cumulativeRotation));
+
+    PackVector axis;
+    Pack angle;
+    PackHelpers::CalculateParameters(currentTip, newTip, axis, angle);
+    PackQuaternion tipRotation          = AngleAxis(angle * m_rig.constraints[bone].flexibility, axis);
+
+    const PackQuaternion parentOrientation  = cumulative * pose.globalOrientations[parent];
+    const PackQuaternion childOrientation   = cumulative * pose.globalOrientations[bone];
+
+    const PackQuaternion childRotation  = ApplyConstraint(bone, Inverse(parentOrientation) * tipRotation * childOrientation);
+    pose.rotations[bone]                = Select(active, childRotation, pose.rotations[bone]);
+    cumulativeRotation                  = Select(active, cumulative, cumulativeRotation);
+
+    tipRotation                         = parentOrientation * childRotation * Inverse(childOrientation);
+    newTip                              = tipRotation * currentTip;
+
+    return newTip * tipLength + (rootRotation * y) * rootLength;
+}
+
+void SolverBatch::CalculateAngles(const Pack& rootLength, const Pack& tipLength, Pack chordX, const Pack& chordY,
+    Pack& angleRoot, Pack& angleJoint) const
+{
+    chordX                  = Max(chordX, Pack::Broadcast(0));
+
+    Pack chordLength        = Clamp(Sqrt(chordX * chordX + chordY * chordY), rootLength - tipLength, rootLength + tipLength);
+    Pack lbsq               = chordLength * chordLength;
+    Pack angleChord         = Select(chordX > EPSILON, Atan(chordY / chordX), Sign(chordY) * (glm::pi<real>() / (real)2.0));
+
+    angleRoot               = Select(lbsq > EPSILON,
+                                angleChord + PackHelpers::TriangleAngle(rootLength, chordLength, tipLength),
+                                Pack::Broadcast(0));
+    angleJoint              = glm::pi<real>() - PackHelpers::TriangleAngle(rootLength, tipLength, chordLength);
+}
+
+PackQuaternion SolverBatch::ApplyConstraint(size_t slot, const PackQuaternion& rotation) const
+{
+    const ConstraintLimits& limits  = m_rig.limits[slot];
+    switch (limits.kind)
+    {
+    case ConstraintLimits::Kind::free:
+        return rotation;
+    case ConstraintLimits::Kind::swingTwist:
+        return PackHelpers::ClampSwingTwist(rotation, limits);
+    default:
+        break;
+    }
+    const Constraints& constraints  = m_rig.constraints[slot];
+    PackVector angles               = PackHelpers::ToEulerXZY(rotation);
+    angles.x                        = Clamp(angles.x, constraints.minAngles.x, constraints.maxAngles.x);
+    angles.y                        = Clamp(angles.y, constraints.minAngles.y, constraints.maxAngles.y);
+    angles.z                        = Clamp(angles.z, constraints.minAngles.z, constraints.maxAngles.z);
+    return PackHelpers::FromEulerXZY(angles);
+}
+
+}
@@ -0,0 +1,160 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "solver_dls.h"
+#include "helpers.h"
+
+#include <array>
+#include <bit>
+
+namespace LightIK
+{
+
+SolverDls::SolverDls(BoneStorage& storage, std::pmr::memory_resource* arena)
+    : m_storage(storage)
+    , m_joints(arena)
+    , m_effectors(arena)
+{
+}
+
+size_t SolverDls::AddEffector(const SolverBase& effector)
+{
+    assert(m_effectors.size() < MaxEffectors);
+    m_effectors.emplace_back(&effector);
+    return m_effectors.size() - 1;
+}
+
+void SolverDls::AddBone(size_t slot, size_t parent, uint32_t effectors)
+{
+    m_joints.emplace_back(Joint{slot, parent, effectors});
+}
+
+void SolverDls::Execute()
+{
+    constexpr size_t MaxSize    = 3 * MaxEffectors;
+    // the system is linearized at the current pose, bigger steps overshoot
+    constexpr real MaxStep      = glm::pi<real>() / 4;
+
+    const size_t effectors      = m_effectors.size();
+    const size_t size           = 3 * effectors;
+
+    std::array<Vector, MaxEffectors> tips;
+    // the error of the effectors, it is replaced by the solution of the system
+    std::array<real, MaxSize> solution;
+    for (size_t e = 0; e < effectors; ++e)
+    {
+        tips[e]                 = m_effectors[e]->GetTipPosition();
+        Vector error            = m_effectors[e]->GetTargetPosition() - tips[e];
+        for (size_t i = 0; i < 3; ++i)
+        {
+            solution[3 * e + i] = error[i];
+        }
+    }
+
+    // J * W * Jt, only the lower triangle is filled. W weights the bones by the squared flexibility. Column of the bone rotation around the axis k for the effector e
+    //  is (k x r_e), where r_e is the lever from the joint to the tip, so the block of the effectors f and e
+    //  sums (r_f . r_e) I - r_e r_f^T over the bones that move both of them
+    std::array<real, MaxSize * MaxSize> system {};
+    for (const Joint& joint : m_joints)
+    {
+        const real flexibility  = m_storage.constraints[joint.slot].flexibility;
+        const real weight       = flexibility * flexibility;
+        if (weight == 0)
+        {
+            continue;
+        }
+        const Vector& position  = m_storage.positions[joint.slot];
+        for (uint32_t maskE = joint.effectors; maskE; maskE &= maskE - 1)
+        {
+            const size_t e      = std::countr_zero(maskE);
+            const Vector leverE = tips[e] - position;
+            for (uint32_t maskF = maskE; maskF; maskF &= maskF - 1)
+            {
+                const size_t f      = std::countr_zero(maskF);
+                const Vector leverF = tips[f] - position;
+                const real dot      = glm::dot(leverE, leverF);
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    for (size_t j = 0; j < 3; ++j)
+                    {
+                        system[(3 * f + i) * size + 3 * e + j] += weight * ((i == j ? dot : 0) - leverE[i] * leverF[j]);
+                    }
+                }
+            }
+        }
+    }
+
+    // damping keeps the system positive definite, so Cholesky decomposition is always possible
+    const real damping2         = m_damping * m_damping;
+    for (size_t r = 0; r < size; ++r)
+    {
+        system[r * size + r]    += damping2;
+    }
+    for (size_t c = 0; c < size; ++c)
+    {
+        real diagonal           = system[c * size + c];
+        for (size_t k = 0; k < c; ++k)
+        {
+            diagonal            -= system[c * size + k] * system[c * size + k];
+        }
+        diagonal                = glm::sqrt(glm::max(diagonal, EPSILON));
+        system[c * size + c]    = diagonal;
+        for (size_t r = c + 1; r < size; ++r)
+        {
+            real value          = system[r * size + c];
+            for (size_t k = 0; k < c; ++k)
+            {
+                value           -= system[r * size + k] * system[c * size + k];
+            }
+            system[r * size + c] = value / diagonal;
+        }
+    }
+    // L * z = error, then Lt * y = z
+    for (size_t r = 0; r < size; ++r)
+    {
+        for (size_t k = 0; k < r; ++k)
+        {
+            solution[r]         -= system[r * size + k] * solution[k];
+        }
+        solution[r]             /= system[r * size + r];
+    }
+    for (size_t r = size; r-- > 0;)
+    {
+        for (size_t k = r + 1; k < size; ++k)
+        {
+            solution[r]         -= system[k * size + r] * solution[k];
+        }
+        solution[r]             /= system[r * size + r];
+    }
+
+    // W * Jt * y: the joint rotates by the sum of (r_e x y_e) over the effectors it moves, scaled by the weight
+    //  the system was built with. All rotations are applied around the joints of the current pose, so the order
+    //  of the bones does not matter
+    for (const Joint& joint : m_joints)
+    {
+        const real flexibility  = m_storage.constraints[joint.slot].flexibility;
+        const real weight       = flexibility * flexibility;
+        const Vector& position  = m_storage.positions[joint.slot];
+        Vector velocity {0, 0, 0};
+        for (uint32_t mask = joint.effectors; mask; mask &= mask - 1)
+        {
+            const size_t e      = std::countr_zero(mask);
+            velocity            += glm::cross(tips[e] - position, Vector{solution[3 * e], solution[3 * e + 1], solution[3 * e + 2]});
+        }
+        velocity                *= weight;
+
+        const real angle2       = glm::length2(velocity);
+        if (angle2 < EPSILON)
+        {
+            continue;
+        }
+        const real angle        = glm::sqrt(angle2);
+        const Quaternion step   = Math::AngleAxis(glm::min(angle, MaxStep), velocity / angle);
+        const Quaternion& parentOrientation = m_storage.globalOrientations[joint.parent];
+        Quaternion rotation     = glm::inverse(parentOrientation) * step * m_storage.globalOrientations[joint.slot];
+        m_storage.SetRotation(joint.slot, m_storage.ApplyConstraint(joint.slot, rotation));
+    }
+}
+
+}
@@ -0,0 +1,92 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "solver_fabrik.h"
+#include "helpers.h"
+
+namespace LightIK
+{
+
+SolverFabrik::SolverFabrik(BoneSubchain&& chain, const Bone& parentBone, Target& target)
+    : m_storage(parentBone.GetStorage())
+    , m_parentBone(parentBone.GetIndex())
+    , m_chain(std::move(chain))
+    , m_slots(m_chain.get_allocator())
+    , m_joints(m_chain.size() + 1, Vector{0, 0, 0}, m_chain.get_allocator())
+    , m_target(target)
+{
+    assert(m_chain.size());
+    m_slots.reserve(m_chain.size());
+    for (auto& bone : m_chain)
+    {
+        assert(&bone.get().GetStorage() == &m_storage);
+        bone.get().SetOwner(this);
+        m_slots.emplace_back(bone.get().GetIndex());
+    }
+}
+
+Vector SolverFabrik::GetRootPosition() const
+{
+    return m_storage.positions[m_slots.front()];
+}
+
+bool SolverFabrik::TargetReached() const
+{
+    return glm::length2(m_tipPosition - m_target.GetSolverPosition()) < m_convergence.tolerance * m_convergence.tolerance;
+}
+
+Vector SolverFabrik::Reach(const Vector& anchor, const Vector& joint, real length)
+{
+    Vector direction = joint - anchor;
+    real length2     = glm::length2(direction);
+    if (length2 < EPSILON)
+    {
+        // joints coincide, the direction is restored by the rotation extraction
+        return joint;
+    }
+    return anchor + direction * (length / glm::sqrt(length2));
+}
+
+void SolverFabrik::Execute()
+{
+    const size_t count          = m_slots.size();
+    const Vector rootPosition   = m_storage.positions[m_slots.front()];
+    const auto& lengths         = m_storage.lengths;
+
+    // backward reaching: the tip is placed into the target, the joints follow it keeping the bone lengths
+    m_joints[count]             = m_target.GetSolverPosition();
+    for (size_t i = count; i > 0; --i)
+    {
+        m_joints[i - 1]         = Reach(m_joints[i], m_storage.positions[m_slots[i - 1]], lengths[m_slots[i - 1]].l);
+    }
+    // forward reaching: the root returns to its place, the joints follow it
+    m_joints[0]                 = rootPosition;
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_joints[i + 1]         = Reach(m_joints[i], m_joints[i + 1], lengths[m_slots[i]].l);
+    }
+
+    // each bone is directed from its actual joint to the reached position of the next one,
+    // so the deviation caused by the constraints of the bone is compensated by the rest of the chain
+    Quaternion parentOrientation = m_storage.globalOrientations[m_parentBone];
+    Vector position             = rootPosition;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t slot       = m_slots[i];
+        Quaternion orientation  = parentOrientation * m_storage.rotations[slot];
+        Vector direction        = m_joints[i + 1] - position;
+        if (glm::length2(direction) > EPSILON)
+        {
+            RotationParameters params = Helpers::CalculateParameters(orientation * Helpers::DefaultAxis(), glm::normalize(direction));
+            orientation         = Math::AngleAxis(params.angle * m_storage.constraints[slot].flexibility, params.axis) * orientation;
+        }
+        Quaternion rotation     = m_storage.ApplyConstraint(slot, glm::inverse(parentOrientation) * orientation);
+        m_storage.SetRotation(slot, rotation);
+
+        parentOrientation       = parentOrientation * rotation;
+        position                += parentOrientation * Helpers::DefaultAxis() * lengths[slot].l;
+    }
+}
+
+}
@@ -0,0 +1,99 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "solver_two_bone.h"
+#include "helpers.h"
+
+namespace LightIK
+{
+
+SolverTwoBone::SolverTwoBone(BoneSubchain&& chain, const Bone& parentBone, Target& target)
+    : m_storage(parentBone.GetStorage())
+    , m_parentBone(parentBone.GetIndex())
+    , m_chain(std::move(chain))
+    , m_target(target)
+{
+    assert(m_chain.size() == 2);
+    for (auto& bone : m_chain)
+    {
+        assert(&bone.get().GetStorage() == &m_storage);
+        bone.get().SetOwner(this);
+    }
+    m_rootBone      = m_chain.front().get().GetIndex();
+    m_middleBone    = m_chain.back().get().GetIndex();
+}
+
+Vector SolverTwoBone::GetRootPosition() const
+{
+    return m_storage.positions[m_rootBone];
+}
+
+bool SolverTwoBone::TargetReached() const
+{
+    return !m_poleChanged && glm::length2(m_tipPosition - m_target.GetSolverPosition()) < m_convergence.tolerance * m_convergence.tolerance;
+}
+
+Quaternion SolverTwoBone::Swing(const Quaternion& orientation, const Vector& direction) const
+{
+    if (glm::length2(direction) < EPSILON)
+    {
+        return glm::identity<Quaternion>();
+    }
+    RotationParameters params   = Helpers::CalculateParameters(orientation * Helpers::DefaultAxis(), glm::normalize(direction));
+    return Math::AngleAxis(params.angle * m_storage.constraints[m_middleBone].flexibility, params.axis);
+}
+
+void SolverTwoBone::Execute()
+{
+    m_poleChanged                   = false;
+    const Vector& target            = m_target.GetSolverPosition();
+    const Vector rootPosition       = m_storage.positions[m_rootBone];
+    const Vector toTarget           = target - rootPosition;
+    const real distance             = glm::length(toTarget);
+    if (distance * distance < EPSILON)
+    {
+        // target is in the root joint, every pose is equally good
+        return;
+    }
+
+    const real rootLength           = m_storage.lengths[m_rootBone].l;
+    const real tipLength            = m_storage.lengths[m_middleBone].l;
+    const Vector direction          = toTarget / distance;
+
+    // the middle joint bends towards the pole, or keeps the current bending plane.
+    // Normal picks an arbitrary plane if the hint is aligned with the target direction
+    const Vector hint               = (m_pole ? *m_pole : m_storage.positions[m_middleBone]) - rootPosition;
+    const Vector bend               = glm::cross(Helpers::Normal(direction, hint), direction);
+
+    // triangle made by the bones and the distance to the target, the distance is limited by the reach of the bones
+    const real reach                = glm::clamp(distance, glm::abs(rootLength - tipLength), rootLength + tipLength);
+    const real rootAngle            = Helpers::TriangleAngle(rootLength, reach, tipLength);
+    real rootSine, rootCosine;
+    Math::SinCos(rootAngle, rootSine, rootCosine);
+    const Vector rootDirection      = direction * rootCosine + bend * rootSine;
+
+    // the second bone bends to close the triangle, as if the root bone had already turned to the calculated direction
+    const Quaternion& parentOrientation = m_storage.globalOrientations[m_parentBone];
+    const Quaternion& rootOrientation   = m_storage.globalOrientations[m_rootBone];
+    Quaternion newRootOrientation   = Helpers::CalculateRotation(rootOrientation * Helpers::DefaultAxis(), rootDirection) * rootOrientation;
+    const Vector middlePosition     = rootPosition + rootDirection * rootLength;
+    const Quaternion middleOrientation  = newRootOrientation * m_storage.rotations[m_middleBone];
+    const Vector middleDirection    = rootPosition + direction * reach - middlePosition;
+    Quaternion middleRotation       = glm::inverse(newRootOrientation) * Swing(middleOrientation, middleDirection) * middleOrientation;
+    middleRotation                  = m_storage.ApplyConstraint(m_middleBone, middleRotation);
+
+    // constrained middle joint may miss the target line, the root bone aims the actual tip at the target
+    const Vector tip                = rootDirection * rootLength + newRootOrientation * middleRotation * Helpers::DefaultAxis() * tipLength;
+    if (glm::length2(tip) > EPSILON)
+    {
+        newRootOrientation          = Helpers::CalculateRotation(glm::normalize(tip), direction) * newRootOrientation;
+    }
+
+    // like in the iterative solver the flexibility is applied to the child bone only, the root follows its constraints
+    Quaternion rootRotation         = m_storage.ApplyConstraint(m_rootBone, glm::inverse(parentOrientation) * newRootOrientation);
+    m_storage.SetRotation(m_rootBone, rootRotation);
+    m_storage.SetRotation(m_middleBone, middleRotation);
+}
+
+}
@@ -22,7 +22,10 @@ const Vector& TargetBone::GetPosition() const
 
 void TargetBone::AssignBone(int boneIndex) 
 {
-    m_target = m_skeleton.GetBones().at(boneIndex).get();
+    m_target = m_skeleton.GetBones().at(boneIndex);
+    m_position = m_target ? &m_target->GetPosition() : nullptr;
+    // order of the chains depends on the target bone
+    m_skeleton.InvalidateSchedule();
 }
 
 }
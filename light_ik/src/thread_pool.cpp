@@ -0,0 +1,160 @@
+/******************************************************************
+  * Copyright: Pavel Golovinskiy 2025
+*******************************************************************/
+
+#include "thread_pool.h"
+
+namespace LightIK
+{
+
+namespace
+{
+    // Pool and the queue owned by the current worker thread
+    thread_local const ThreadPool*  t_pool  = nullptr;
+    thread_local size_t             t_queue = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadsCount)
+{
+    for (size_t i = 0; i < threadsCount + 1; ++i)
+    {
+        m_queues.emplace_back(std::make_unique<Queue>());
+    }
+    m_threads.reserve(threadsCount);
+    for (size_t i = 0; i < threadsCount; ++i)
+    {
+        m_threads.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stop = true;
+    }
+    m_wakeUp.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(Task&& task)
+{
+    Queue& queue = *m_queues[GetLocalQueue()];
+    {
+        // counter is changed under the sleep lock, so the worker can not miss the notification. It is increased
+        //  before the push, so a thief that takes the task at once can not decrease it below zero
+        std::lock_guard lock(m_sleepMutex);
+        ++m_queued;
+    }
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.PushBack(std::move(task));
+    }
+    m_wakeUp.notify_one();
+}
+
+void ThreadPool::Wait(const std::atomic<size_t>& pending)
+{
+    size_t queue = GetLocalQueue();
+    while (pending.load(std::memory_order_acquire))
+    {
+        if (!TryRun(queue))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t ThreadPool::GetLocalQueue() const
+{
+    return t_pool == this ? t_queue : m_queues.size() - 1;
+}
+
+bool ThreadPool::TryRun(size_t queue)
+{
+    Task task;
+    // own queue is processed in LIFO order to keep the recently produced data in cache
+    {
+        Queue& own = *m_queues[queue];
+        std::lock_guard lock(own.mutex);
+        own.PopBack(task);
+    }
+    // steal the oldest task from other queues
+    for (size_t i = 1; !task && i < m_queues.size(); ++i)
+    {
+        Queue& other = *m_queues[(queue + i) % m_queues.size()];
+        std::lock_guard lock(other.mutex);
+        other.PopFront(task);
+    }
+    if (!task)
+    {
+        return false;
+    }
+    --m_queued;
+    task();
+    return true;
+}
+
+void ThreadPool::Queue::PushBack(Task&& task)
+{
+    if (count == tasks.size())
+    {
+        // unroll the ring into the bigger buffer
+        std::vector<Task> grown(tasks.size() * 2);
+        for (size_t i = 0; i < count; ++i)
+        {
+            grown[i] = std::move(tasks[(head + i) % tasks.size()]);
+        }
+        tasks   = std::move(grown);
+        head    = 0;
+    }
+    tasks[(head + count) % tasks.size()] = std::move(task);
+    ++count;
+}
+
+bool ThreadPool::Queue::PopBack(Task& task)
+{
+    if (!count)
+    {
+        return false;
+    }
+    --count;
+    task = std::move(tasks[(head + count) % tasks.size()]);
+    return true;
+}
+
+bool ThreadPool::Queue::PopFront(Task& task)
+{
+    if (!count)
+    {
+        return false;
+    }
+    task = std::move(tasks[head]);
+    head = (head + 1) % tasks.size();
+    --count;
+    return true;
+}
+
+void ThreadPool::WorkerLoop(size_t queue)
+{
+    t_pool  = this;
+    t_queue = queue;
+    while (true)
+    {
+        if (TryRun(queue))
+        {
+            continue;
+        }
+        std::unique_lock lock(m_sleepMutex);
+        m_wakeUp.wait(lock, [this]() { return m_stop || m_queued.load() > 0; });
+        if (m_stop)
+        {
+            return;
+        }
+    }
+}
+
+}